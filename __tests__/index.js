@@ -0,0 +1,213 @@
+/**
+ * Order of the calls reaching the ADK across the synchronous and batched paths
+ */
+
+// Fake of the native module. Synchronous calls write into the native buffer right away, the other methods are
+// bridge messages handled in order by the module queue, which drains the buffer before each batch like
+// ODDynatrace.m and ODDynatraceModule.java. The fake ADK is the list of dispatched calls.
+function createNativeModule() {
+  const native = {
+    adk: [],
+    buffer: [],
+    messages: [],
+    nextHandle: 1,
+  };
+
+  const drain = () => {
+    native.adk.push(...native.buffer.splice(0));
+  };
+  const message = handler => new Promise((resolve) => {
+    native.messages.push(() => resolve(handler()));
+  });
+  const push = (...call) => {
+    native.buffer.push(call.join(' '));
+    return true;
+  };
+  const enter = (name) => {
+    const handle = native.nextHandle++;
+    push('enter', name);
+    return handle;
+  };
+  const names = [];
+  const register = list => list.map((name) => {
+    if (!names.includes(name)) {
+      names.push(name);
+    }
+    return names.indexOf(name) + 1;
+  });
+
+  Object.assign(native, {
+    enterActionSync: jest.fn(name => enter(name)),
+    enterActionWithIdSync: jest.fn(nameId => enter(names[nameId - 1])),
+    leaveActionSync: jest.fn(handle => push('leave', handle)),
+    reportEventSync: jest.fn((handle, name) => push('event', handle, name)),
+    reportEventWithIdSync: jest.fn((handle, nameId) => push('event', handle, names[nameId - 1])),
+    reportIntValueSync: jest.fn((handle, name, value) => push('intValue', handle, name, value)),
+    reportDoubleValueSync: jest.fn((handle, name, value) => push('doubleValue', handle, name, value)),
+    reportStringValueSync: jest.fn((handle, name, value) => push('stringValue', handle, name, value)),
+    reportErrorSync: jest.fn((handle, name, value) => push('error', handle, name, value)),
+    recordValueSync: jest.fn(() => true),
+    recordValueWithIdSync: jest.fn(() => true),
+    registerNamesSync: jest.fn(register),
+    getRequestTagSync: jest.fn(() => ({ header: 'x-dynatrace', value: 'tag' })),
+
+    registerNames: jest.fn(list => message(() => register(list))),
+    getRequestTag: jest.fn(() => message(() => ({ header: 'x-dynatrace', value: 'tag' }))),
+    getStatusCounts: jest.fn(() => message(() => ({}))),
+    submitBatch: jest.fn(records => message(() => {
+      drain();
+      return records.map((record) => {
+        const name = record.name || names[record.nameId - 1];
+        if (record.type === 'enter') {
+          const handle = native.nextHandle++;
+          native.adk.push(`enter ${name}`);
+          return handle;
+        }
+        const target = record.handle !== undefined ? record.handle : record.action;
+        native.adk.push([record.type, target, name, record.value].filter(field => field !== undefined).join(' '));
+        return 2;
+      });
+    })),
+
+    // Handles the bridge messages sent so far, and the ones sent by their callbacks
+    async runModuleQueue() {
+      while (native.messages.length > 0) {
+        native.messages.shift()();
+        await new Promise(resolve => setImmediate(resolve));
+      }
+      drain();
+    },
+  });
+  return native;
+}
+
+let mockNative;
+let ODDynatrace;
+
+jest.mock('react-native', () => ({ NativeModules: { ODDynatrace: mockNative } }), { virtual: true });
+
+function load(synchronous) {
+  jest.resetModules();
+  mockNative = createNativeModule();
+  global.nativeCallSyncHook = synchronous ? () => {} : undefined;
+  ODDynatrace = require('../index').default;
+}
+
+// Sends the queued batch and lets the module queue handle everything
+async function settle() {
+  ODDynatrace.configure({});
+  await mockNative.runModuleQueue();
+}
+
+describe('synchronous path', () => {
+  beforeEach(() => load(true));
+
+  it('writes handle based calls into the native buffer without a bridge message', async () => {
+    const home = await ODDynatrace.enterAction('Home');
+    expect(ODDynatrace.reportEvent(home, 'Refresh')).toBeUndefined();
+    ODDynatrace.leaveAction(home);
+
+    expect(mockNative.messages.length).toBe(0);
+    expect(mockNative.buffer).toEqual(['enter Home', 'event 1 Refresh', 'leave 1']);
+  });
+
+  it('keeps a leave behind the reports batched before it', async () => {
+    const home = await ODDynatrace.enterAction('Home');
+    const status = ODDynatrace.withStatus.reportEvent(home, 'Refresh');
+    ODDynatrace.reportValue(home, 'Items', 3);
+    ODDynatrace.leaveAction(home);
+    await settle();
+
+    expect(mockNative.leaveActionSync).not.toHaveBeenCalled();
+    expect(mockNative.adk).toEqual(['enter Home', 'event 1 Refresh', 'intValue 1 Items 3', 'leave 1']);
+    expect(await status).toBe(2);
+  });
+
+  it('waits for the batches sent but not handled yet', async () => {
+    const home = await ODDynatrace.enterAction('Home');
+    ODDynatrace.withStatus.reportEvent(home, 'Refresh');
+    ODDynatrace.configure({});
+    ODDynatrace.leaveAction(home);
+    await settle();
+
+    expect(mockNative.adk).toEqual(['enter Home', 'event 1 Refresh', 'leave 1']);
+  });
+
+  it('takes the synchronous path again once the batches were handled', async () => {
+    const home = await ODDynatrace.enterAction('Home');
+    const status = ODDynatrace.withStatus.reportEvent(home, 'Refresh');
+    await settle();
+    await status;
+    ODDynatrace.leaveAction(home);
+
+    expect(mockNative.leaveActionSync).toHaveBeenCalledTimes(1);
+    expect(mockNative.adk).toEqual(['enter Home', 'event 1 Refresh']);
+    expect(mockNative.buffer).toEqual(['leave 1']);
+  });
+
+  it('keeps the synchronous calls made before a batch in front of it', async () => {
+    const home = await ODDynatrace.enterAction('Home');
+    ODDynatrace.reportEvent(home, 'Refresh');
+    ODDynatrace.withStatus.leaveAction(home);
+    await settle();
+
+    expect(mockNative.adk).toEqual(['enter Home', 'event 1 Refresh', 'leave 1']);
+  });
+
+  it('registers recorded value names once', () => {
+    ODDynatrace.recordValue('Render', 12);
+    ODDynatrace.recordValue('Render', 14);
+
+    expect(mockNative.registerNamesSync).toHaveBeenCalledTimes(1);
+    expect(mockNative.recordValueWithIdSync).toHaveBeenCalledTimes(2);
+    expect(mockNative.recordValueSync).not.toHaveBeenCalled();
+  });
+
+  it('reads the request tag synchronously only while synchronous calls are enabled', () => {
+    expect(ODDynatrace.getRequestTag()).toEqual({ header: 'x-dynatrace', value: 'tag' });
+    ODDynatrace.configure({ synchronous: false });
+    ODDynatrace.getRequestTag();
+
+    expect(mockNative.getRequestTagSync).toHaveBeenCalledTimes(1);
+    expect(mockNative.getRequestTag).toHaveBeenCalledTimes(1);
+  });
+});
+
+describe('batched path', () => {
+  beforeEach(() => load(false));
+
+  it('sends the calls in order without blocking the caller', async () => {
+    const entered = ODDynatrace.enterAction('Home');
+    ODDynatrace.reportValue('Feed', 'Items', 3);
+    expect(mockNative.messages.length).toBe(0);
+    await settle();
+    const home = await entered;
+
+    ODDynatrace.reportEvent(home, 'Refresh');
+    ODDynatrace.leaveAction(home);
+    await settle();
+
+    expect(mockNative.submitBatch).toHaveBeenCalledTimes(2);
+    expect(mockNative.adk).toEqual(['enter Home', 'intValue Feed Items 3', 'event 1 Refresh', 'leave 1']);
+  });
+
+  it('resolves the calls with their status code', async () => {
+    const home = ODDynatrace.enterAction('Home');
+    await settle();
+    const status = ODDynatrace.withStatus.leaveAction(await home);
+    await settle();
+
+    expect(await status).toBe(2);
+  });
+
+  it('records values by name when registering the name fails', async () => {
+    mockNative.registerNames.mockImplementation(() => Promise.reject(new Error('Bridge error')));
+    ODDynatrace.recordValue('Render', 12);
+    await settle();
+    ODDynatrace.recordValue('Render', 14);
+    await settle();
+
+    expect(mockNative.registerNames).toHaveBeenCalledTimes(1);
+    expect(mockNative.adk).toEqual(['record Render 12', 'record Render 14']);
+  });
+});
@@ -0,0 +1,89 @@
+//
+//  ODDynatraceActionTree.java
+//  ODDynatraceActionTree
+//
+//  Created by OLIVIER DEMOLLIENS on 22/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import java.util.Arrays;
+
+// Parent and child links of the open actions, mirrors ODDynatraceActionTree.m. One int array holds
+// the nodes indexed like the handle table slots, children form a doubly linked list starting at
+// their parent. Not thread-safe, owned by the module thread.
+class ODDynatraceActionTree {
+
+    private static final int ACTION = 0;
+    private static final int PARENT = 1;
+    private static final int FIRST_CHILD = 2;
+    private static final int PREVIOUS_SIBLING = 3;
+    private static final int NEXT_SIBLING = 4;
+    private static final int NODE_LENGTH = 5;
+
+    private int[] nodes = new int[64 * NODE_LENGTH];
+
+    // Offset of the node of a handle, -1 when the slot holds another action
+    private int nodeOf(int action) {
+        int offset = (action & 0xFFFF) * NODE_LENGTH;
+        if (action == ODDynatraceHandleTable.INVALID_HANDLE || offset >= nodes.length || nodes[offset + ACTION] != action) {
+            return -1;
+        }
+        return offset;
+    }
+
+    void add(int action, int parent) {
+        int offset = (action & 0xFFFF) * NODE_LENGTH;
+        if (offset >= nodes.length) {
+            int length = nodes.length;
+            while (length <= offset) {
+                length *= 2;
+            }
+            nodes = Arrays.copyOf(nodes, length);
+        }
+
+        int parentNode = nodeOf(parent);
+        Arrays.fill(nodes, offset, offset + NODE_LENGTH, ODDynatraceHandleTable.INVALID_HANDLE);
+        nodes[offset + ACTION] = action;
+        if (parentNode >= 0) {
+            int siblingNode = nodeOf(nodes[parentNode + FIRST_CHILD]);
+            if (siblingNode >= 0) {
+                nodes[siblingNode + PREVIOUS_SIBLING] = action;
+            }
+            nodes[offset + PARENT] = parent;
+            nodes[offset + NEXT_SIBLING] = nodes[parentNode + FIRST_CHILD];
+            nodes[parentNode + FIRST_CHILD] = action;
+        }
+    }
+
+    // Unlinks the action from its parent. Its children, if any, keep pointing to it.
+    void remove(int action) {
+        int node = nodeOf(action);
+        if (node < 0) {
+            return;
+        }
+        int previousNode = nodeOf(nodes[node + PREVIOUS_SIBLING]);
+        int nextNode = nodeOf(nodes[node + NEXT_SIBLING]);
+        int parentNode = nodeOf(nodes[node + PARENT]);
+        if (previousNode >= 0) {
+            nodes[previousNode + NEXT_SIBLING] = nodes[node + NEXT_SIBLING];
+        } else if (parentNode >= 0) {
+            nodes[parentNode + FIRST_CHILD] = nodes[node + NEXT_SIBLING];
+        }
+        if (nextNode >= 0) {
+            nodes[nextNode + PREVIOUS_SIBLING] = nodes[node + PREVIOUS_SIBLING];
+        }
+        Arrays.fill(nodes, node, node + NODE_LENGTH, ODDynatraceHandleTable.INVALID_HANDLE);
+    }
+
+    // INVALID_HANDLE when the action has no child
+    int firstChildOf(int action) {
+        int node = nodeOf(action);
+        return node >= 0 ? nodes[node + FIRST_CHILD] : ODDynatraceHandleTable.INVALID_HANDLE;
+    }
+
+    void clear() {
+        Arrays.fill(nodes, ODDynatraceHandleTable.INVALID_HANDLE);
+    }
+}
@@ -0,0 +1,199 @@
+//
+//  ODDynatraceBreadcrumbs.java
+//  ODDynatraceBreadcrumbs
+//
+//  Created by OLIVIER DEMOLLIENS on 02/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import java.io.File;
+import java.io.IOException;
+import java.io.RandomAccessFile;
+import java.nio.ByteOrder;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.charset.Charset;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicLong;
+
+import com.facebook.react.bridge.LifecycleEventListener;
+
+// Last events recorded through the module, kept in a memory-mapped ring of fixed size slots so they
+// are still on disk after a crash, mirrors ODDynatraceBreadcrumbs.m. Adding one neither locks nor
+// allocates, from any thread. The breadcrumbs of the previous launch are read when opened, so one instance
+// is shared by the modules of all the React instances of the process.
+class ODDynatraceBreadcrumbs implements LifecycleEventListener {
+
+    static final class Breadcrumb {
+        final int type;
+        final String name;
+        final long timestamp;
+
+        Breadcrumb(int type, String name, long timestamp) {
+            this.type = type;
+            this.name = name;
+            this.timestamp = timestamp;
+        }
+    }
+
+    private static final int MAGIC = 0x4342444f; // "ODBC"
+    private static final int VERSION = 1;
+    // magic, version, capacity, and the active flag set while the application is in the foreground
+    private static final int HEADER_LENGTH = 16;
+    private static final int ACTIVE_OFFSET = 12;
+    // sequence (0 while written), timestamp, type, name length, name
+    private static final int SLOT_LENGTH = 64;
+    private static final int TIMESTAMP_OFFSET = 8;
+    private static final int TYPE_OFFSET = 16;
+    private static final int LENGTH_OFFSET = 17;
+    private static final int NAME_OFFSET = 18;
+    private static final int NAME_LENGTH = 45;
+    private static final Charset UTF8 = Charset.forName("UTF-8");
+
+    private final MappedByteBuffer bytes;
+    private final int capacity;
+    private final AtomicLong next = new AtomicLong();
+    private final AtomicBoolean claimedCrash = new AtomicBoolean();
+    private final boolean previousLaunchCrashed;
+    private final List<Breadcrumb> previousBreadcrumbs;
+
+    // Returns null when the file can't be mapped
+    static ODDynatraceBreadcrumbs open(File file, int capacity) {
+        try {
+            return new ODDynatraceBreadcrumbs(file, Math.max(capacity, 1));
+        } catch (IOException e) {
+            return null;
+        }
+    }
+
+    private ODDynatraceBreadcrumbs(File file, int capacity) throws IOException {
+        this.capacity = capacity;
+        int length = HEADER_LENGTH + capacity * SLOT_LENGTH;
+        RandomAccessFile randomAccessFile = new RandomAccessFile(file, "rw");
+        try {
+            randomAccessFile.setLength(length);
+            bytes = randomAccessFile.getChannel().map(FileChannel.MapMode.READ_WRITE, 0, length);
+        } finally {
+            randomAccessFile.close();
+        }
+        bytes.order(ByteOrder.LITTLE_ENDIAN);
+        if (bytes.getInt(0) == MAGIC && bytes.getInt(4) == VERSION && bytes.getInt(8) == capacity) {
+            previousLaunchCrashed = bytes.getInt(ACTIVE_OFFSET) != 0;
+            previousBreadcrumbs = readBreadcrumbs();
+        } else {
+            previousLaunchCrashed = false;
+            previousBreadcrumbs = new ArrayList<>();
+        }
+        for (int offset = HEADER_LENGTH; offset < length; offset += 8) {
+            bytes.putLong(offset, 0);
+        }
+        bytes.putInt(0, MAGIC);
+        bytes.putInt(4, VERSION);
+        bytes.putInt(8, capacity);
+        bytes.putInt(ACTIVE_OFFSET, 0);
+    }
+
+    // True when the previous launch ended while in the foreground, most likely a crash
+    boolean previousLaunchCrashed() {
+        return previousLaunchCrashed;
+    }
+
+    // True for the first caller only when the previous launch crashed, so its breadcrumbs are reported once
+    boolean claimPreviousLaunchCrash() {
+        return previousLaunchCrashed && claimedCrash.compareAndSet(false, true);
+    }
+
+    // Oldest first
+    List<Breadcrumb> previousBreadcrumbs() {
+        return previousBreadcrumbs;
+    }
+
+    // Slots are written in turn, the oldest one follows the last written
+    private List<Breadcrumb> readBreadcrumbs() {
+        long lastSequence = 0;
+        for (int i = 0; i < capacity; i++) {
+            lastSequence = Math.max(lastSequence, bytes.getLong(slotOffset(i)));
+        }
+        List<Breadcrumb> breadcrumbs = new ArrayList<>(capacity);
+        byte[] name = new byte[NAME_LENGTH];
+        for (int i = 0; i < capacity; i++) {
+            int offset = slotOffset((int) ((lastSequence + i) % capacity));
+            if (bytes.getLong(offset) == 0) {
+                continue;
+            }
+            int nameLength = Math.min(bytes.get(offset + LENGTH_OFFSET) & 0xff, NAME_LENGTH);
+            for (int j = 0; j < nameLength; j++) {
+                name[j] = bytes.get(offset + NAME_OFFSET + j);
+            }
+            breadcrumbs.add(new Breadcrumb(bytes.get(offset + TYPE_OFFSET),
+                    new String(name, 0, nameLength, UTF8),
+                    bytes.getLong(offset + TIMESTAMP_OFFSET)));
+        }
+        return breadcrumbs;
+    }
+
+    private static int slotOffset(int slot) {
+        return HEADER_LENGTH + slot * SLOT_LENGTH;
+    }
+
+    // Names are truncated to 45 UTF-8 bytes
+    void add(int type, String name) {
+        long index = next.getAndIncrement();
+        int offset = slotOffset((int) (index % capacity));
+        bytes.putLong(offset, 0);
+        bytes.putLong(offset + TIMESTAMP_OFFSET, System.currentTimeMillis());
+        bytes.put(offset + TYPE_OFFSET, (byte) type);
+        bytes.put(offset + LENGTH_OFFSET, (byte) (name != null ? putName(offset + NAME_OFFSET, name) : 0));
+        bytes.putLong(offset, index + 1);
+    }
+
+    // Encodes UTF-8 in place, stops before a character that does not fit
+    private int putName(int offset, String name) {
+        int length = 0;
+        for (int i = 0; i < name.length(); i++) {
+            int c = name.codePointAt(i);
+            int size = c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+            if (length + size > NAME_LENGTH) {
+                break;
+            }
+            if (size == 1) {
+                bytes.put(offset + length, (byte) c);
+            } else if (size == 2) {
+                bytes.put(offset + length, (byte) (0xc0 | (c >> 6)));
+                bytes.put(offset + length + 1, (byte) (0x80 | (c & 0x3f)));
+            } else if (size == 3) {
+                bytes.put(offset + length, (byte) (0xe0 | (c >> 12)));
+                bytes.put(offset + length + 1, (byte) (0x80 | ((c >> 6) & 0x3f)));
+                bytes.put(offset + length + 2, (byte) (0x80 | (c & 0x3f)));
+            } else {
+                bytes.put(offset + length, (byte) (0xf0 | (c >> 18)));
+                bytes.put(offset + length + 1, (byte) (0x80 | ((c >> 12) & 0x3f)));
+                bytes.put(offset + length + 2, (byte) (0x80 | ((c >> 6) & 0x3f)));
+                bytes.put(offset + length + 3, (byte) (0x80 | (c & 0x3f)));
+                i++;
+            }
+            length += size;
+        }
+        return length;
+    }
+
+    // Only launches ending in the foreground count as crashes, the system kills background processes routinely
+    @Override
+    public void onHostResume() {
+        bytes.putInt(ACTIVE_OFFSET, 1);
+    }
+
+    @Override
+    public void onHostPause() {
+        bytes.putInt(ACTIVE_OFFSET, 0);
+    }
+
+    @Override
+    public void onHostDestroy() {
+        bytes.putInt(ACTIVE_OFFSET, 0);
+    }
+}
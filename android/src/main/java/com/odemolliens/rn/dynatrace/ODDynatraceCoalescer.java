@@ -0,0 +1,169 @@
+//
+//  ODDynatraceCoalescer.java
+//  ODDynatraceCoalescer
+//
+//  Created by OLIVIER DEMOLLIENS on 08/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import android.os.Handler;
+
+// Merges the reportEvent calls repeating an event of the same action within a time window, mirrors
+// ODDynatraceCoalescer.m. The first one is reported, the repeats are only counted and passed to the
+// reporter when the window ends or before the action is left. Fixed-size direct mapped table keyed by
+// action and name, a colliding event ends the older entry. Only used from the module thread.
+class ODDynatraceCoalescer {
+
+    interface Reporter {
+        // name is null when the event was reported with a name id
+        void reportRepeats(int action, int nameId, String name, int repeats);
+    }
+
+    private final int[] actions;
+    private final int[] nameIds;
+    private final String[] names;
+    private final long[] startTimes;
+    private final int[] repeats;
+    private final int mask;
+    private final long window;
+    private final Handler handler;
+    private final Reporter reporter;
+    private int count;
+    private boolean expiryScheduled;
+
+    private final Runnable expiryRunnable = new Runnable() {
+        @Override
+        public void run() {
+            endExpiredEntries();
+        }
+    };
+
+    // window in milliseconds
+    ODDynatraceCoalescer(int capacity, long window, Handler handler, Reporter reporter) {
+        int size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        actions = new int[size];
+        nameIds = new int[size];
+        names = new String[size];
+        startTimes = new long[size];
+        repeats = new int[size];
+        mask = size - 1;
+        this.window = window * 1000000;
+        this.handler = handler;
+        this.reporter = reporter;
+    }
+
+    private static boolean coalescable(ODDynatraceEvent event) {
+        return event.type == ODDynatraceEvent.REPORT_EVENT
+                && (event.nameId != ODDynatraceNameTable.INVALID_NAME_ID || event.name != null);
+    }
+
+    // splitmix64 finalizer, close handles and ids land in distant slots
+    private int slot(ODDynatraceEvent event) {
+        long nameHash = event.nameId != ODDynatraceNameTable.INVALID_NAME_ID ? event.nameId : event.name.hashCode();
+        long key = ((long) event.handle << 32) ^ nameHash;
+        key = (key ^ (key >>> 30)) * 0xbf58476d1ce4e5b9L;
+        key = (key ^ (key >>> 27)) * 0x94d049bb133111ebL;
+        return (int) ((key ^ (key >>> 31)) & mask);
+    }
+
+    private boolean matches(int slot, ODDynatraceEvent event) {
+        if (actions[slot] != event.handle || nameIds[slot] != event.nameId) {
+            return false;
+        }
+        return nameIds[slot] != ODDynatraceNameTable.INVALID_NAME_ID || event.name.equals(names[slot]);
+    }
+
+    // True when the event repeats one reported in the window, and must not be reported again
+    boolean coalesce(ODDynatraceEvent event) {
+        if (!coalescable(event)) {
+            return false;
+        }
+        int slot = slot(event);
+        if (actions[slot] == ODDynatraceHandleTable.INVALID_HANDLE || !matches(slot, event)) {
+            return false;
+        }
+        if (System.nanoTime() - startTimes[slot] >= window) {
+            end(slot);
+            return false;
+        }
+        repeats[slot]++;
+        return true;
+    }
+
+    // Starts the window of a reported event
+    void add(ODDynatraceEvent event) {
+        if (!coalescable(event)) {
+            return;
+        }
+        int slot = slot(event);
+        end(slot);
+        actions[slot] = event.handle;
+        nameIds[slot] = event.nameId;
+        names[slot] = event.nameId == ODDynatraceNameTable.INVALID_NAME_ID ? event.name : null;
+        startTimes[slot] = System.nanoTime();
+        repeats[slot] = 0;
+        count++;
+        scheduleExpiry();
+    }
+
+    // Ends the entries of the action, before it is left
+    void flushAction(int action) {
+        if (count == 0) {
+            return;
+        }
+        for (int slot = 0; slot <= mask; slot++) {
+            if (actions[slot] == action) {
+                end(slot);
+            }
+        }
+    }
+
+    void flush() {
+        for (int slot = 0; slot <= mask && count > 0; slot++) {
+            end(slot);
+        }
+        handler.removeCallbacks(expiryRunnable);
+        expiryScheduled = false;
+    }
+
+    private void end(int slot) {
+        if (actions[slot] == ODDynatraceHandleTable.INVALID_HANDLE) {
+            return;
+        }
+        if (repeats[slot] > 0) {
+            reporter.reportRepeats(actions[slot], nameIds[slot], names[slot], repeats[slot]);
+        }
+        actions[slot] = ODDynatraceHandleTable.INVALID_HANDLE;
+        nameIds[slot] = ODDynatraceNameTable.INVALID_NAME_ID;
+        names[slot] = null;
+        repeats[slot] = 0;
+        count--;
+    }
+
+    // Ends the expired entries once per window while the table has entries
+    private void scheduleExpiry() {
+        if (expiryScheduled) {
+            return;
+        }
+        expiryScheduled = true;
+        handler.postDelayed(expiryRunnable, window / 1000000);
+    }
+
+    private void endExpiredEntries() {
+        expiryScheduled = false;
+        long now = System.nanoTime();
+        for (int slot = 0; slot <= mask; slot++) {
+            if (actions[slot] != ODDynatraceHandleTable.INVALID_HANDLE && now - startTimes[slot] >= window) {
+                end(slot);
+            }
+        }
+        if (count > 0) {
+            scheduleExpiry();
+        }
+    }
+}
@@ -0,0 +1,104 @@
+//
+//  ODDynatraceEvent.java
+//  ODDynatraceEvent
+//
+//  Created by OLIVIER DEMOLLIENS on 27/11/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+// Fixed-size record of one instrumentation call, mirrors ODDynatraceEvent in ODDynatraceEventBuffer.h.
+// Instances are preallocated in the event buffer slots and copied field by field.
+// The name is either an interned name id or a string. The parent is only used by enter events.
+final class ODDynatraceEvent {
+
+    static final int ENTER_ACTION = 0;
+    static final int LEAVE_ACTION = 1;
+    static final int REPORT_EVENT = 2;
+    static final int REPORT_INT_VALUE = 3;
+    static final int REPORT_DOUBLE_VALUE = 4;
+    static final int REPORT_STRING_VALUE = 5;
+    static final int REPORT_ERROR = 6;
+    static final int TYPE_COUNT = 7;
+
+    int type;
+    int handle;
+    int parent;
+    int nameId;
+    String name;
+    int intValue;
+    double doubleValue;
+    String stringValue;
+
+    ODDynatraceEvent set(int type, int handle, String name) {
+        this.type = type;
+        this.handle = handle;
+        this.parent = ODDynatraceHandleTable.INVALID_HANDLE;
+        this.nameId = ODDynatraceNameTable.INVALID_NAME_ID;
+        this.name = name;
+        this.intValue = 0;
+        this.doubleValue = 0;
+        this.stringValue = null;
+        return this;
+    }
+
+    ODDynatraceEvent set(int type, int handle, int nameId) {
+        set(type, handle, null);
+        this.nameId = nameId;
+        return this;
+    }
+
+    void copyFrom(ODDynatraceEvent event) {
+        type = event.type;
+        handle = event.handle;
+        parent = event.parent;
+        nameId = event.nameId;
+        name = event.name;
+        intValue = event.intValue;
+        doubleValue = event.doubleValue;
+        stringValue = event.stringValue;
+    }
+
+    static int typeFromString(String type) {
+        switch (type) {
+            case "enter":
+                return ENTER_ACTION;
+            case "leave":
+                return LEAVE_ACTION;
+            case "event":
+                return REPORT_EVENT;
+            case "intValue":
+                return REPORT_INT_VALUE;
+            case "doubleValue":
+                return REPORT_DOUBLE_VALUE;
+            case "stringValue":
+                return REPORT_STRING_VALUE;
+            case "error":
+                return REPORT_ERROR;
+            default:
+                return -1;
+        }
+    }
+
+    static String typeToString(int type) {
+        switch (type) {
+            case ENTER_ACTION:
+                return "enter";
+            case LEAVE_ACTION:
+                return "leave";
+            case REPORT_EVENT:
+                return "event";
+            case REPORT_INT_VALUE:
+                return "intValue";
+            case REPORT_DOUBLE_VALUE:
+                return "doubleValue";
+            case REPORT_STRING_VALUE:
+                return "stringValue";
+            case REPORT_ERROR:
+                return "error";
+            default:
+                return "unknown";
+        }
+    }
+}
@@ -0,0 +1,144 @@
+//
+//  ODDynatraceEventBuffer.java
+//  ODDynatraceEventBuffer
+//
+//  Created by OLIVIER DEMOLLIENS on 27/11/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.atomic.AtomicLongArray;
+
+// Bounded lock-free queue of events, mirrors ODDynatraceEventBuffer.m.
+// Any thread can push, events are popped by a single consumer. Every slot carries a
+// sequence number telling producers and consumers whose turn it is (Dmitry Vyukov's queue).
+public class ODDynatraceEventBuffer {
+
+    public enum OverflowPolicy {
+        DROP_NEWEST,
+        DROP_OLDEST
+    }
+
+    interface DropHandler {
+        // Called on the pushing thread
+        void onDrop(ODDynatraceEvent event);
+    }
+
+    private final ODDynatraceEvent[] slots;
+    private final AtomicLongArray sequences;
+    private final int mask;
+    private final OverflowPolicy overflowPolicy;
+    private final AtomicLong enqueuePosition = new AtomicLong();
+    private final AtomicLong dequeuePosition = new AtomicLong();
+    private final AtomicLong droppedCount = new AtomicLong();
+    private final ThreadLocal<ODDynatraceEvent> droppedEvent = new ThreadLocal<ODDynatraceEvent>() {
+        @Override
+        protected ODDynatraceEvent initialValue() {
+            return new ODDynatraceEvent();
+        }
+    };
+    private volatile DropHandler dropHandler;
+
+    // The capacity is rounded up to a power of two
+    ODDynatraceEventBuffer(int capacity, OverflowPolicy overflowPolicy) {
+        int size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        this.slots = new ODDynatraceEvent[size];
+        this.sequences = new AtomicLongArray(size);
+        this.mask = size - 1;
+        this.overflowPolicy = overflowPolicy;
+        for (int i = 0; i < size; i++) {
+            slots[i] = new ODDynatraceEvent();
+            sequences.set(i, i);
+        }
+    }
+
+    void setDropHandler(DropHandler dropHandler) {
+        this.dropHandler = dropHandler;
+    }
+
+    int capacity() {
+        return slots.length;
+    }
+
+    int count() {
+        return (int) Math.max(enqueuePosition.get() - dequeuePosition.get(), 0);
+    }
+
+    long droppedCount() {
+        return droppedCount.get();
+    }
+
+    // Returns false when the event was dropped
+    boolean push(ODDynatraceEvent event) {
+        while (!tryPush(event)) {
+            if (overflowPolicy == OverflowPolicy.DROP_NEWEST) {
+                drop(event);
+                return false;
+            }
+            ODDynatraceEvent oldest = droppedEvent.get();
+            if (pop(oldest)) {
+                drop(oldest);
+            }
+        }
+        return true;
+    }
+
+    // Dropping the oldest event makes producers dequeue too, hence the CAS on the dequeue position
+    boolean pop(ODDynatraceEvent event) {
+        long position = dequeuePosition.get();
+        int index;
+        for (;;) {
+            index = (int) (position & mask);
+            long difference = sequences.get(index) - (position + 1);
+            if (difference == 0) {
+                if (dequeuePosition.compareAndSet(position, position + 1)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = dequeuePosition.get();
+            }
+        }
+        ODDynatraceEvent slot = slots[index];
+        event.copyFrom(slot);
+        slot.name = null;
+        slot.stringValue = null;
+        sequences.set(index, position + mask + 1);
+        return true;
+    }
+
+    private boolean tryPush(ODDynatraceEvent event) {
+        long position = enqueuePosition.get();
+        int index;
+        for (;;) {
+            index = (int) (position & mask);
+            long difference = sequences.get(index) - position;
+            if (difference == 0) {
+                if (enqueuePosition.compareAndSet(position, position + 1)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueuePosition.get();
+            }
+        }
+        slots[index].copyFrom(event);
+        sequences.set(index, position + 1);
+        return true;
+    }
+
+    private void drop(ODDynatraceEvent event) {
+        droppedCount.incrementAndGet();
+        DropHandler handler = dropHandler;
+        if (handler != null) {
+            handler.onDrop(event);
+        }
+    }
+}
@@ -0,0 +1,159 @@
+//
+//  ODDynatraceFlushScheduler.java
+//  ODDynatraceFlushScheduler
+//
+//  Created by OLIVIER DEMOLLIENS on 13/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import android.os.Handler;
+import android.os.SystemClock;
+
+import com.dynatrace.apm.uem.mobile.android.DynatraceUEM;
+import com.facebook.react.bridge.LifecycleEventListener;
+import com.facebook.react.bridge.ReactApplicationContext;
+import com.facebook.react.bridge.ReadableMap;
+
+// Calls flushEvents instead of waiting for the ADK to send its packages, mirrors ODDynatraceFlushScheduler.m.
+// All policies are disabled by default. Only used from the module thread.
+class ODDynatraceFlushScheduler implements LifecycleEventListener {
+
+    private static final long MAX_BACKOFF = 600000;
+
+    private final Handler handler;
+    private final ReactApplicationContext reactContext;
+
+    private final int flushEventCount;
+    private final long flushMaxAge;
+    private final long cellularFlushMaxAge;
+    private final long flushMinInterval;
+    private final boolean flushOnBackground;
+
+    private String networkType = "unknown";
+    private int pendingCount;
+    private long oldestPendingTime;
+    private long backoff;
+    private long nextFlushTime;
+
+    private final Runnable flushRunnable = new Runnable() {
+        @Override
+        public void run() {
+            flushIfDue();
+        }
+    };
+
+    private final Runnable backgroundRunnable = new Runnable() {
+        @Override
+        public void run() {
+            if (pendingCount > 0) {
+                flush();
+            }
+        }
+    };
+
+    ODDynatraceFlushScheduler(ReadableMap options, Handler handler, ReactApplicationContext reactContext) {
+        this.handler = handler;
+        this.reactContext = reactContext;
+        flushEventCount = options != null && options.hasKey("flushEventCount") ? options.getInt("flushEventCount") : 0;
+        flushMaxAge = seconds(options, "flushMaxAge", 0);
+        cellularFlushMaxAge = seconds(options, "cellularFlushMaxAge", flushMaxAge);
+        flushMinInterval = seconds(options, "flushMinInterval", 10000);
+        flushOnBackground = options != null && options.hasKey("flushOnBackground") && options.getBoolean("flushOnBackground");
+        if (flushOnBackground) {
+            reactContext.addLifecycleEventListener(this);
+        }
+    }
+
+    private static long seconds(ReadableMap options, String key, long defaultMillis) {
+        return options != null && options.hasKey(key) ? (long) (options.getDouble(key) * 1000) : defaultMillis;
+    }
+
+    void invalidate() {
+        if (flushOnBackground) {
+            reactContext.removeLifecycleEventListener(this);
+        }
+        handler.removeCallbacks(flushRunnable);
+        handler.removeCallbacks(backgroundRunnable);
+    }
+
+    // "wifi", "cellular", "none" or "unknown". No automatic flush happens without network.
+    void setNetworkType(String networkType) {
+        this.networkType = networkType;
+        schedule();
+    }
+
+    void eventsReported(int count) {
+        if (count == 0) {
+            return;
+        }
+        if (pendingCount == 0) {
+            oldestPendingTime = SystemClock.uptimeMillis();
+        }
+        pendingCount += count;
+        schedule();
+    }
+
+    // Flushes now whatever the policies. The Android ADK does not report whether flushing worked,
+    // only whether it captures at all.
+    int flush() {
+        int statusCode = DynatraceUEM.uemCaptureStatus();
+        long now = SystemClock.uptimeMillis();
+        if (statusCode == DynatraceUEM.CPWR_UemOn) {
+            DynatraceUEM.flushEvents();
+            pendingCount = 0;
+            backoff = 0;
+            nextFlushTime = now + flushMinInterval;
+        } else {
+            backoff = Math.min(Math.max(backoff * 2, flushMinInterval), MAX_BACKOFF);
+            nextFlushTime = now + backoff;
+        }
+        schedule();
+        return statusCode;
+    }
+
+    private void flushIfDue() {
+        if (pendingCount > 0 && SystemClock.uptimeMillis() >= dueTime()) {
+            flush();
+        } else {
+            schedule();
+        }
+    }
+
+    private long dueTime() {
+        if (pendingCount == 0 || "none".equals(networkType)) {
+            return Long.MAX_VALUE;
+        }
+        long dueTime = Long.MAX_VALUE;
+        if (flushEventCount > 0 && pendingCount >= flushEventCount) {
+            dueTime = 0;
+        }
+        long maxAge = "cellular".equals(networkType) ? cellularFlushMaxAge : flushMaxAge;
+        if (maxAge > 0) {
+            dueTime = Math.min(dueTime, oldestPendingTime + maxAge);
+        }
+        return Math.max(dueTime, nextFlushTime);
+    }
+
+    private void schedule() {
+        handler.removeCallbacks(flushRunnable);
+        long dueTime = dueTime();
+        if (dueTime != Long.MAX_VALUE) {
+            handler.postAtTime(flushRunnable, dueTime);
+        }
+    }
+
+    @Override
+    public void onHostResume() {
+    }
+
+    @Override
+    public void onHostPause() {
+        handler.post(backgroundRunnable);
+    }
+
+    @Override
+    public void onHostDestroy() {
+    }
+}
@@ -0,0 +1,126 @@
+//
+//  ODDynatraceHandleTable.java
+//  ODDynatraceHandleTable
+//
+//  Created by OLIVIER DEMOLLIENS on 22/11/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import java.util.Arrays;
+
+// Slot map giving O(1) handle lookups, mirrors ODDynatraceHandleTable.m.
+// A handle is the slot index in its low 16 bits and the slot generation in the next 15 bits.
+// Removing an object bumps the slot generation, so stale handles are detected. Safe to use from any thread.
+class ODDynatraceHandleTable<T> {
+
+    static final int INVALID_HANDLE = 0;
+
+    private static final int MAX_COUNT = 0xFFFF;
+    private static final int MAX_GENERATION = 0x7FFF;
+    private static final Object RESERVED = new Object();
+
+    private Object[] objects;
+    private short[] generations;
+    private int[] freeIndexes;
+    private int freeCount;
+    private int count;
+
+    ODDynatraceHandleTable(int capacity) {
+        int initialCapacity = Math.max(Math.min(capacity, MAX_COUNT), 1);
+        objects = new Object[initialCapacity];
+        generations = new short[initialCapacity];
+        freeIndexes = new int[initialCapacity];
+    }
+
+    synchronized int add(T object) {
+        return insert(object);
+    }
+
+    // Hands out a handle before its object exists, get returns null until it is set
+    synchronized int reserve() {
+        return insert(RESERVED);
+    }
+
+    synchronized void set(int handle, T object) {
+        if (isLive(handle)) {
+            objects[handle & 0xFFFF] = object;
+        }
+    }
+
+    @SuppressWarnings("unchecked")
+    synchronized T get(int handle) {
+        Object object = isLive(handle) ? objects[handle & 0xFFFF] : null;
+        return object != RESERVED ? (T) object : null;
+    }
+
+    // True for reserved handles too
+    synchronized boolean contains(int handle) {
+        return isLive(handle);
+    }
+
+    // True when the handle was handed out by the table and its object removed since
+    synchronized boolean isStale(int handle) {
+        return (handle & 0xFFFF) < count && ((handle >> 16) & MAX_GENERATION) != 0 && !isLive(handle);
+    }
+
+    @SuppressWarnings("unchecked")
+    synchronized T remove(int handle) {
+        if (!isLive(handle)) {
+            return null;
+        }
+        Object object = objects[handle & 0xFFFF];
+        free(handle & 0xFFFF);
+        return object != RESERVED ? (T) object : null;
+    }
+
+    synchronized void clear() {
+        for (int index = 0; index < count; index++) {
+            if (objects[index] != null) {
+                free(index);
+            }
+        }
+    }
+
+    private int insert(Object object) {
+        int index;
+        if (freeCount > 0) {
+            index = freeIndexes[--freeCount];
+        } else {
+            if (count >= MAX_COUNT) {
+                return INVALID_HANDLE;
+            }
+            if (count == objects.length) {
+                grow();
+            }
+            index = count++;
+            generations[index] = 1;
+        }
+        objects[index] = object;
+        return makeHandle(index, generations[index]);
+    }
+
+    // Free slots hold null, reserved ones RESERVED until their object is set
+    private boolean isLive(int handle) {
+        int index = handle & 0xFFFF;
+        return index < count && generations[index] == ((handle >> 16) & MAX_GENERATION) && objects[index] != null;
+    }
+
+    private void free(int index) {
+        objects[index] = null;
+        generations[index] = (short) (generations[index] == MAX_GENERATION ? 1 : generations[index] + 1);
+        freeIndexes[freeCount++] = index;
+    }
+
+    private static int makeHandle(int index, short generation) {
+        return (generation << 16) | index;
+    }
+
+    private void grow() {
+        int capacity = Math.min(objects.length * 2, MAX_COUNT);
+        objects = Arrays.copyOf(objects, capacity);
+        generations = Arrays.copyOf(generations, capacity);
+        freeIndexes = Arrays.copyOf(freeIndexes, capacity);
+    }
+}
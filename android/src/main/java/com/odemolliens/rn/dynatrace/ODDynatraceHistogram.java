@@ -0,0 +1,121 @@
+//
+//  ODDynatraceHistogram.java
+//  ODDynatraceHistogram
+//
+//  Created by OLIVIER DEMOLLIENS on 29/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import java.util.concurrent.atomic.AtomicIntegerArray;
+import java.util.concurrent.atomic.AtomicLong;
+
+// Log-linear histogram of positive values in fixed memory, mirrors ODDynatraceHistogram.m :
+// 8 linear buckets per power of 2 from 2^-10 to 2^30. Recording is lock-free from any thread.
+class ODDynatraceHistogram {
+
+    static final class Summary {
+        long count;
+        double min;
+        double max;
+        double p50;
+        double p90;
+        double p95;
+        double p99;
+    }
+
+    private static final int SUB_BUCKETS = 8;
+    private static final int MIN_EXPONENT = -10;
+    private static final int MAX_EXPONENT = 30;
+    private static final int BUCKET_COUNT = (MAX_EXPONENT - MIN_EXPONENT) * SUB_BUCKETS;
+    private static final double[] PERCENTILES = { 0.5, 0.9, 0.95, 0.99 };
+
+    private final AtomicIntegerArray buckets = new AtomicIntegerArray(BUCKET_COUNT);
+    private final AtomicLong count = new AtomicLong();
+    // Bits of doubles, updated with compare and set
+    private final AtomicLong min = new AtomicLong(Double.doubleToRawLongBits(Double.POSITIVE_INFINITY));
+    private final AtomicLong max = new AtomicLong(Double.doubleToRawLongBits(Double.NEGATIVE_INFINITY));
+    private final double[] percentileValues = new double[PERCENTILES.length];
+    private final int[] snapshot = new int[BUCKET_COUNT];
+
+    // The exponent picks the power of 2, the mantissa the linear bucket inside it
+    private static int bucket(double value) {
+        if (!(value > 0)) {
+            return 0;
+        }
+        int exponent = Math.getExponent(value);
+        double mantissa = value / Math.scalb(1.0, exponent);
+        int bucket = (exponent - MIN_EXPONENT) * SUB_BUCKETS + (int) ((mantissa - 1) * SUB_BUCKETS);
+        return Math.max(0, Math.min(bucket, BUCKET_COUNT - 1));
+    }
+
+    private static double lowerBound(int bucket) {
+        int exponent = bucket / SUB_BUCKETS + MIN_EXPONENT;
+        int subBucket = bucket % SUB_BUCKETS;
+        return Math.scalb(1 + (double) subBucket / SUB_BUCKETS, exponent);
+    }
+
+    void record(double value) {
+        buckets.incrementAndGet(bucket(value));
+        long current;
+        while (value < Double.longBitsToDouble(current = min.get())
+                && !min.compareAndSet(current, Double.doubleToRawLongBits(value))) {
+        }
+        while (value > Double.longBitsToDouble(current = max.get())
+                && !max.compareAndSet(current, Double.doubleToRawLongBits(value))) {
+        }
+        count.incrementAndGet();
+    }
+
+    // Summarizes and resets the histogram, returns false when nothing was recorded since the last summary.
+    // Only called from one thread at a time.
+    boolean summarize(Summary summary) {
+        if (count.getAndSet(0) == 0) {
+            return false;
+        }
+
+        // The count is taken from the buckets, a value being recorded may not have bumped both yet
+        long total = 0;
+        int firstBucket = -1;
+        int lastBucket = -1;
+        for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+            snapshot[bucket] = buckets.getAndSet(bucket, 0);
+            if (snapshot[bucket] > 0) {
+                total += snapshot[bucket];
+                firstBucket = firstBucket < 0 ? bucket : firstBucket;
+                lastBucket = bucket;
+            }
+        }
+        if (total == 0) {
+            return false;
+        }
+        double minValue = Double.longBitsToDouble(min.getAndSet(Double.doubleToRawLongBits(Double.POSITIVE_INFINITY)));
+        double maxValue = Double.longBitsToDouble(max.getAndSet(Double.doubleToRawLongBits(Double.NEGATIVE_INFINITY)));
+        if (Double.isInfinite(minValue)) {
+            minValue = lowerBound(firstBucket);
+        }
+        if (Double.isInfinite(maxValue)) {
+            maxValue = lowerBound(lastBucket + 1);
+        }
+
+        // Upper bound of the bucket holding the percentile, within the recorded range
+        int percentile = 0;
+        long cumulated = 0;
+        for (int bucket = firstBucket; bucket <= lastBucket; bucket++) {
+            cumulated += snapshot[bucket];
+            while (percentile < PERCENTILES.length && cumulated >= (long) Math.ceil(PERCENTILES[percentile] * total)) {
+                percentileValues[percentile++] = Math.max(minValue, Math.min(lowerBound(bucket + 1), maxValue));
+            }
+        }
+
+        summary.count = total;
+        summary.min = minValue;
+        summary.max = maxValue;
+        summary.p50 = percentileValues[0];
+        summary.p90 = percentileValues[1];
+        summary.p95 = percentileValues[2];
+        summary.p99 = percentileValues[3];
+        return true;
+    }
+}
@@ -0,0 +1,82 @@
+//
+//  ODDynatraceMetrics.java
+//  ODDynatraceMetrics
+//
+//  Created by OLIVIER DEMOLLIENS on 29/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import android.os.Handler;
+
+import java.util.concurrent.atomic.AtomicReferenceArray;
+
+import com.facebook.react.bridge.ReadableMap;
+
+// One histogram per registered name, mirrors ODDynatraceMetrics.m. Recording is lock-free from any thread,
+// the summaries are reported every metricsReportInterval seconds (60 by default) on the module thread.
+class ODDynatraceMetrics {
+
+    interface Reporter {
+        void report(int nameId, ODDynatraceHistogram.Summary summary);
+    }
+
+    private final AtomicReferenceArray<ODDynatraceHistogram> histograms;
+    private final ODDynatraceHistogram.Summary summary = new ODDynatraceHistogram.Summary();
+    private final Reporter reporter;
+    private Handler handler;
+    private long interval;
+
+    private final Runnable reportRunnable = new Runnable() {
+        @Override
+        public void run() {
+            report();
+            handler.postDelayed(this, interval);
+        }
+    };
+
+    ODDynatraceMetrics(int capacity, Reporter reporter) {
+        this.histograms = new AtomicReferenceArray<>(capacity);
+        this.reporter = reporter;
+    }
+
+    void record(double value, int nameId) {
+        if (nameId == ODDynatraceNameTable.INVALID_NAME_ID || nameId > histograms.length()) {
+            return;
+        }
+        ODDynatraceHistogram histogram = histograms.get(nameId - 1);
+        if (histogram == null) {
+            histograms.compareAndSet(nameId - 1, null, new ODDynatraceHistogram());
+            histogram = histograms.get(nameId - 1);
+        }
+        histogram.record(value);
+    }
+
+    void start(ReadableMap options, Handler handler) {
+        invalidate();
+        this.handler = handler;
+        interval = options != null && options.hasKey("metricsReportInterval")
+                ? (long) (options.getDouble("metricsReportInterval") * 1000)
+                : 60000;
+        if (interval > 0) {
+            handler.postDelayed(reportRunnable, interval);
+        }
+    }
+
+    void invalidate() {
+        if (handler != null) {
+            handler.removeCallbacks(reportRunnable);
+        }
+    }
+
+    // Reports now, on the module thread
+    void report() {
+        for (int i = 0; i < histograms.length(); i++) {
+            ODDynatraceHistogram histogram = histograms.get(i);
+            if (histogram != null && histogram.summarize(summary)) {
+                reporter.report(i + 1, summary);
+            }
+        }
+    }
+}
@@ -8,22 +8,211 @@
 
 package com.odemolliens.rn.dynatrace;
 
+import android.os.Handler;
+import android.os.HandlerThread;
+import android.os.Looper;
+import android.os.MessageQueue;
+import android.os.Process;
 import android.util.Log;
 
+import java.io.File;
+import java.nio.ByteBuffer;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicInteger;
+
 import com.dynatrace.apm.uem.mobile.android.DynatraceUEM;
 import com.dynatrace.apm.uem.mobile.android.UemAction;
+import com.dynatrace.apm.uem.mobile.android.WebRequestTiming;
+import com.facebook.react.bridge.Arguments;
+import com.facebook.react.bridge.Promise;
 import com.facebook.react.bridge.ReactApplicationContext;
+import com.facebook.react.bridge.ReadableArray;
+import com.facebook.react.bridge.ReadableMap;
+import com.facebook.react.bridge.ReadableMapKeySetIterator;
+import com.facebook.react.bridge.ReadableType;
 import com.facebook.react.bridge.ReactContextBaseJavaModule;
 import com.facebook.react.bridge.ReactMethod;
 import com.facebook.react.bridge.Callback;
+import com.facebook.react.bridge.WritableArray;
+import com.facebook.react.bridge.WritableMap;
 
 public class ODDynatraceModule extends ReactContextBaseJavaModule {
 
+    private static int eventBufferCapacity = 1024;
+    private static ODDynatraceEventBuffer.OverflowPolicy eventBufferOverflowPolicy =
+            ODDynatraceEventBuffer.OverflowPolicy.DROP_NEWEST;
+    private static int spillLogCapacity = 256 * 1024;
+    private static int breadcrumbCapacity = 64;
+    private static ODDynatraceBreadcrumbs sharedBreadcrumbs;
+    private static boolean openedBreadcrumbs;
+
+    // Packed batches : PACKED_FIELDS numbers per record, the event type, the action handle, the name id and the value.
+    // Recorded values use PACKED_RECORD_VALUE as type.
+    private static final int PACKED_FIELDS = 4;
+    private static final int PACKED_RECORD_VALUE = ODDynatraceEvent.TYPE_COUNT;
+
     private final ReactApplicationContext reactContext;
+    private final ODDynatraceHandleTable<UemAction> actions = new ODDynatraceHandleTable<>(64);
+    private final ODDynatraceActionTree actionTree = new ODDynatraceActionTree();
+    private final ODDynatraceHandleTable<WebRequestTiming> webRequests = new ODDynatraceHandleTable<>(16);
+    private final ODDynatraceEventBuffer events;
+    private final ODDynatraceNameTable names = new ODDynatraceNameTable(4096);
+    private final ODDynatraceMetrics metrics;
+    private final ODDynatraceScreens screens;
+    private final ODDynatraceTelemetry telemetry;
+    private final Handler handler;
+    private final AtomicBoolean drainScheduled = new AtomicBoolean();
+    // Bumped by each startup and shutdown call, a deferred startup only runs if none was made since
+    private final AtomicInteger startupGeneration = new AtomicInteger();
+    // Replaced on each startup, read by the callers of any thread
+    private volatile ODDynatraceSampler sampler;
+    // Only used on the module thread
+    private ODDynatraceFlushScheduler flushScheduler;
+    private ODDynatraceWatchdog watchdog;
+    private ODDynatraceCoalescer coalescer;
+    private final ODDynatraceEvent repeatEvent = new ODDynatraceEvent();
+    private String networkType = "unknown";
+    private final ODDynatraceSpillLog spillLog;
+    private final ODDynatraceBreadcrumbs breadcrumbs;
+    private boolean requestTagStale;
+    // Value tagging requests to the current action, refreshed on the module thread, read by the JS thread
+    private volatile String requestTag;
+    private boolean started;
+    private final ODDynatraceStatus.Counts statusCounts = new ODDynatraceStatus.Counts();
+    private int startupStatus;
+    private double startupWait;
+    private double startupDuration;
+    private final ODDynatraceEvent drainedEvent = new ODDynatraceEvent();
+    private final ODDynatraceEvent recordEvent = new ODDynatraceEvent();
+    // Actions opened by name during one batch, reused across batches
+    private final Map<String, Integer> batchActions = new HashMap<>();
+    // Records of the packed batches in native memory, null when the native library is not packaged
+    private final ODDynatracePackedQueue packedQueue = ODDynatracePackedQueue.create(4096);
+    // Numbers of the packed batch being queued, only used on the native modules thread
+    private double[] packedNumbers = new double[0];
+    private final ThreadLocal<ODDynatraceEvent> pushedEvent = new ThreadLocal<ODDynatraceEvent>() {
+        @Override
+        protected ODDynatraceEvent initialValue() {
+            return new ODDynatraceEvent();
+        }
+    };
+
+    private final Runnable drainRunnable = new Runnable() {
+        @Override
+        public void run() {
+            drainScheduled.set(false);
+            drainEvents();
+        }
+    };
+
+    // Size of the event buffer shared by all callers, defaults to 1024 events dropping the newest ones.
+    // Must be set before the module is created.
+    public static void setEventBufferCapacity(int capacity, ODDynatraceEventBuffer.OverflowPolicy overflowPolicy) {
+        eventBufferCapacity = capacity;
+        eventBufferOverflowPolicy = overflowPolicy;
+    }
+
+    // Size of the file keeping the events recorded while the ADK is not started, defaults to 256 KB.
+    // 0 disables it. Must be set before the module is created.
+    public static void setSpillLogCapacity(int capacity) {
+        spillLogCapacity = capacity;
+    }
+
+    // Number of breadcrumbs kept for crash reports, defaults to 64. 0 disables them.
+    // Must be set before the module is created.
+    public static void setBreadcrumbCapacity(int capacity) {
+        breadcrumbCapacity = capacity;
+    }
 
     public ODDynatraceModule(ReactApplicationContext reactContext) {
         super(reactContext);
         this.reactContext = reactContext;
+
+        // Single consumer of the event buffer, the only thread calling the ADK for actions
+        HandlerThread thread = new HandlerThread("ODDynatrace", Process.THREAD_PRIORITY_BACKGROUND);
+        thread.start();
+        this.handler = new Handler(thread.getLooper());
+
+        this.events = new ODDynatraceEventBuffer(eventBufferCapacity, eventBufferOverflowPolicy);
+        this.events.setDropHandler(new ODDynatraceEventBuffer.DropHandler() {
+            @Override
+            public void onDrop(ODDynatraceEvent event) {
+                // A dropped enter never reaches the ADK, give its reserved handle back
+                if (event.type == ODDynatraceEvent.ENTER_ACTION) {
+                    actions.remove(event.handle);
+                }
+            }
+        });
+
+        this.metrics = new ODDynatraceMetrics(4096, new ODDynatraceMetrics.Reporter() {
+            @Override
+            public void report(int nameId, ODDynatraceHistogram.Summary summary) {
+                reportSummary(nameId, summary);
+            }
+        });
+
+        this.telemetry = new ODDynatraceTelemetry(new Runnable() {
+            @Override
+            public void run() {
+                Log.i("ReactNative", "Dynatrace stats " + stats());
+            }
+        });
+
+        this.screens = new ODDynatraceScreens(handler, new ODDynatraceScreens.Reporter() {
+            @Override
+            public int enterScreen(String name) {
+                return enterAction(name);
+            }
+
+            @Override
+            public void reportValue(int action, String valueName, double value) {
+                ODDynatraceModule.this.reportValue(action, valueName, value);
+            }
+
+            @Override
+            public void exitScreen(int action) {
+                leaveAction(action);
+            }
+        });
+
+        this.spillLog = spillLogCapacity > 0
+                ? ODDynatraceSpillLog.open(new File(reactContext.getCacheDir(), "ODDynatrace.spill"), spillLogCapacity)
+                : null;
+        this.breadcrumbs = openBreadcrumbs(reactContext.getCacheDir());
+        if (breadcrumbs != null) {
+            reactContext.addLifecycleEventListener(breadcrumbs);
+        }
+    }
+
+    // Opened once per process : a reload creates a new module, which must neither read the active flag left by
+    // the previous one as a crash nor map the file again
+    private static synchronized ODDynatraceBreadcrumbs openBreadcrumbs(File cacheDir) {
+        if (!openedBreadcrumbs) {
+            openedBreadcrumbs = true;
+            sharedBreadcrumbs = breadcrumbCapacity > 0
+                    ? ODDynatraceBreadcrumbs.open(new File(cacheDir, "ODDynatrace.breadcrumbs"), breadcrumbCapacity)
+                    : null;
+        }
+        return sharedBreadcrumbs;
+    }
+
+    @Override
+    public void onCatalystInstanceDestroy() {
+        if (breadcrumbs != null) {
+            reactContext.removeLifecycleEventListener(breadcrumbs);
+        }
+        if (packedQueue != null) {
+            // After the batches already posted
+            handler.post(new Runnable() {
+                @Override
+                public void run() {
+                    packedQueue.release();
+                }
+            });
+        }
     }
 
     @Override
@@ -33,32 +222,1058 @@ public class ODDynatraceModule extends ReactContextBaseJavaModule {
 
 
     @ReactMethod
-    public void startup(String appId, String serverURL) {
-        int statusCode = DynatraceUEM.startup(
-                reactContext,
-                appId,
-                serverURL,
-                false,
-                null
-        );
-        switch (statusCode) {
-            case DynatraceUEM.CPWR_UemOn:
-                Log.i("ReactNative", "Dynatrace startup status code = Successful (CPWR_UemOn)");
-                break;
-            case DynatraceUEM.CPWR_Error_InvalidParameter:
-                Log.e("ReactNative", "Dynatrace startup status code = appId or serverURL is null or empty (CPWR_Error_InvalidParameter)");
+    public void startup(final String appId, final String serverURL, final ReadableMap options, final Promise promise) {
+        final int generation = startupGeneration.incrementAndGet();
+        sampler = new ODDynatraceSampler(options);
+        handler.post(new Runnable() {
+            @Override
+            public void run() {
+                if (flushScheduler != null) {
+                    flushScheduler.invalidate();
+                }
+                flushScheduler = new ODDynatraceFlushScheduler(options, handler, reactContext);
+                flushScheduler.setNetworkType(networkType);
+                if (watchdog != null) {
+                    watchdog.invalidate();
+                }
+                watchdog = createWatchdog(options);
+                watchdog.start();
+                metrics.start(options, handler);
+                telemetry.start(options, handler);
+                if (coalescer != null) {
+                    coalescer.flush();
+                }
+                coalescer = createCoalescer(options);
+            }
+        });
+
+        final long requestTime = System.nanoTime();
+        final Runnable startup = new Runnable() {
+            @Override
+            public void run() {
+                // Cancelled by a shutdown or a later startup
+                if (startupGeneration.get() != generation) {
+                    promise.resolve(DynatraceUEM.CPWR_Error_NotInitialized);
+                    return;
+                }
+                long startTime = System.nanoTime();
+                int statusCode = DynatraceUEM.startup(
+                        reactContext,
+                        appId,
+                        serverURL,
+                        false,
+                        null
+                );
+                startupWait = (startTime - requestTime) / 1e6;
+                startupDuration = (System.nanoTime() - startTime) / 1e6;
+                startupStatus = statusCode;
+                logStartupStatus(statusCode);
+                statusCounts.count(statusCode);
+                if (statusCode == DynatraceUEM.CPWR_UemOn) {
+                    started = true;
+                    replaySpillLog();
+                    reportCrashBreadcrumbs();
+                    requestTagStale = true;
+                    refreshRequestTag();
+                }
+                promise.resolve(statusCode);
+            }
+        };
+
+        // Deferred startups leave the launch frames alone, the calls made until then are spilled and replayed
+        long delay = options.hasKey("startupDelay") ? (long) options.getDouble("startupDelay") : 0;
+        boolean onIdle = options.hasKey("startupOnIdle") && options.getBoolean("startupOnIdle");
+        if (!onIdle) {
+            handler.postDelayed(startup, delay);
+            return;
+        }
+        new Handler(Looper.getMainLooper()).postDelayed(new Runnable() {
+            @Override
+            public void run() {
+                Looper.myQueue().addIdleHandler(new MessageQueue.IdleHandler() {
+                    @Override
+                    public boolean queueIdle() {
+                        handler.post(startup);
+                        return false;
+                    }
+                });
+            }
+        }, delay);
+    }
+
+    // Repeated events within coalesceWindow milliseconds (startup option, disabled by default) are counted,
+    // the count is reported right away so it stays before the leave of the action
+    private ODDynatraceCoalescer createCoalescer(ReadableMap options) {
+        long window = options.hasKey("coalesceWindow") ? (long) options.getDouble("coalesceWindow") : 0;
+        if (window <= 0) {
+            return null;
+        }
+        return new ODDynatraceCoalescer(64, window, handler, new ODDynatraceCoalescer.Reporter() {
+            @Override
+            public void reportRepeats(int action, int nameId, String name, int repeats) {
+                String valueName = (name != null ? name : names.get(nameId)) + " repeats";
+                ODDynatraceEvent event = repeatEvent.set(ODDynatraceEvent.REPORT_INT_VALUE, action, valueName);
+                event.intValue = repeats;
+                dispatchEvent(event);
+            }
+        });
+    }
+
+    // Reports the JS thread latencies as values of a periodic action, through the same buffer as the other calls
+    private ODDynatraceWatchdog createWatchdog(ReadableMap options) {
+        final String actionName = options.hasKey("watchdogActionName") ? options.getString("watchdogActionName") : "JS thread";
+        return new ODDynatraceWatchdog(options, handler, reactContext, new ODDynatraceWatchdog.Reporter() {
+            @Override
+            public void report(ODDynatraceWatchdog.Report report) {
+                int action = enterAction(actionName);
+                reportValue(action, "p50", report.p50);
+                reportValue(action, "p95", report.p95);
+                reportValue(action, "p99", report.p99);
+                reportValue(action, "max", report.max);
+                reportValue(action, "Long tasks", report.longTaskCount);
+                leaveAction(action);
+            }
+        });
+    }
+
+    // The ADK sends the crash report itself, the breadcrumbs of the crashed launch follow as one action
+    private void reportCrashBreadcrumbs() {
+        if (breadcrumbs == null || !breadcrumbs.claimPreviousLaunchCrash()) {
+            return;
+        }
+        List<ODDynatraceBreadcrumbs.Breadcrumb> previousBreadcrumbs = breadcrumbs.previousBreadcrumbs();
+        if (previousBreadcrumbs.isEmpty()) {
+            return;
+        }
+        int action = enterAction("Crash breadcrumbs");
+        for (int i = 0; i < previousBreadcrumbs.size(); i++) {
+            ODDynatraceBreadcrumbs.Breadcrumb breadcrumb = previousBreadcrumbs.get(i);
+            reportValue(action, String.valueOf(i + 1),
+                    ODDynatraceEvent.typeToString(breadcrumb.type) + " " + breadcrumb.name);
+        }
+        leaveAction(action);
+    }
+
+    private void reportSummary(int nameId, ODDynatraceHistogram.Summary summary) {
+        int action = enterAction(nameId);
+        reportValue(action, "count", (int) Math.min(summary.count, Integer.MAX_VALUE));
+        reportValue(action, "min", summary.min);
+        reportValue(action, "max", summary.max);
+        reportValue(action, "p50", summary.p50);
+        reportValue(action, "p90", summary.p90);
+        reportValue(action, "p99", summary.p99);
+        leaveAction(action);
+    }
+
+    private void logStartupStatus(int statusCode) {
+        String message = "Dynatrace startup status code = " + ODDynatraceStatus.description(statusCode)
+                + " (" + ODDynatraceStatus.name(statusCode) + ")";
+        if (statusCode == DynatraceUEM.CPWR_UemOn) {
+            Log.i("ReactNative", message);
+        } else {
+            Log.e("ReactNative", message);
         }
     }
 
     @ReactMethod
     public void shutdown() {
-        DynatraceUEM.shutdown();
+        startupGeneration.incrementAndGet();
+        handler.post(new Runnable() {
+            @Override
+            public void run() {
+                metrics.report();
+                metrics.invalidate();
+                telemetry.invalidate();
+                screens.invalidate();
+                drainEvents();
+                if (coalescer != null) {
+                    coalescer.flush();
+                    coalescer = null;
+                }
+                actions.clear();
+                actionTree.clear();
+                webRequests.clear();
+                if (flushScheduler != null) {
+                    flushScheduler.invalidate();
+                    flushScheduler = null;
+                }
+                if (watchdog != null) {
+                    watchdog.invalidate();
+                    watchdog = null;
+                }
+                DynatraceUEM.shutdown();
+                started = false;
+                requestTag = null;
+            }
+        });
     }
 
+    // Sends the events collected by the ADK now, resolves with its capture status code
     @ReactMethod
-    public void enterAction(String actionName) {
-        UemAction action = DynatraceUEM.enterAction(actionName);
-        //temporary leaving action directly
-        action.leaveAction();
+    public void flush(final Promise promise) {
+        handler.post(new Runnable() {
+            @Override
+            public void run() {
+                drainEvents();
+                int statusCode = flushScheduler != null ? flushScheduler.flush() : flushEvents();
+                statusCounts.count(statusCode);
+                promise.resolve(statusCode);
+            }
+        });
+    }
+
+    // Without a flush scheduler, before the first startup or after shutdown, the ADK is flushed directly as on iOS
+    private static int flushEvents() {
+        int statusCode = DynatraceUEM.uemCaptureStatus();
+        if (statusCode == DynatraceUEM.CPWR_UemOn) {
+            DynatraceUEM.flushEvents();
+        }
+        return statusCode;
+    }
+
+    // Sends the ADK crash reports, complete or minimal. The Android ADK does not return a status code,
+    // resolves with its capture status instead.
+    @ReactMethod
+    public void enableCrashReporting(final boolean sendCrashReport, final Promise promise) {
+        handler.post(new Runnable() {
+            @Override
+            public void run() {
+                DynatraceUEM.enableCrashReporting(sendCrashReport);
+                int statusCode = DynatraceUEM.uemCaptureStatus();
+                statusCounts.count(statusCode);
+                promise.resolve(statusCode);
+            }
+        });
+    }
+
+    // Resolves with the breadcrumbs of the previous launch, and whether it most likely crashed
+    @ReactMethod
+    public void getPreviousBreadcrumbs(Promise promise) {
+        WritableArray array = Arguments.createArray();
+        if (breadcrumbs != null) {
+            for (ODDynatraceBreadcrumbs.Breadcrumb breadcrumb : breadcrumbs.previousBreadcrumbs()) {
+                WritableMap map = Arguments.createMap();
+                map.putString("type", ODDynatraceEvent.typeToString(breadcrumb.type));
+                map.putString("name", breadcrumb.name);
+                map.putDouble("timestamp", breadcrumb.timestamp);
+                array.pushMap(map);
+            }
+        }
+        WritableMap result = Arguments.createMap();
+        result.putBoolean("crashed", breadcrumbs != null && breadcrumbs.previousLaunchCrashed());
+        result.putArray("breadcrumbs", array);
+        promise.resolve(result);
+    }
+
+    // Network type hint for the flush scheduler : "wifi", "cellular", "none" or "unknown"
+    @ReactMethod
+    public void setNetworkType(final String networkType) {
+        handler.post(new Runnable() {
+            @Override
+            public void run() {
+                ODDynatraceModule.this.networkType = networkType;
+                if (flushScheduler != null) {
+                    flushScheduler.setNetworkType(networkType);
+                }
+            }
+        });
+    }
+
+    // Resolves with one result per record: the action handle for "enter" records,
+    // the ADK status code for the others.
+    @ReactMethod
+    public void submitBatch(final ReadableArray records, final Promise promise) {
+        handler.post(new Runnable() {
+            @Override
+            public void run() {
+                // Events queued by native callers before this batch go first
+                drainEvents();
+
+                WritableArray results = Arguments.createArray();
+                long bytes = 0;
+                for (int i = 0; i < records.size(); i++) {
+                    ReadableMap record = records.getMap(i);
+                    results.pushInt(dispatchRecord(record));
+                    bytes += recordSize(record);
+                }
+                telemetry.recordBatch(records.size(), bytes);
+                for (int handle : batchActions.values()) {
+                    dispatchEvent(recordEvent.set(ODDynatraceEvent.LEAVE_ACTION, handle, null));
+                }
+                batchActions.clear();
+                if (flushScheduler != null) {
+                    flushScheduler.eventsReported(records.size());
+                }
+                refreshRequestTag();
+                promise.resolve(results);
+            }
+        });
+    }
+
+    // Batch of fire-and-forget records using handles and name ids, sent by JS as one flat array of numbers.
+    // Decoding it reads a few numbers per record instead of a map, and the records are dispatched in order
+    // with the batches. The records are queued in native memory on the calling thread and drained by the module
+    // thread, which calls the ADK, a Java library. Resolves once they were dispatched.
+    @ReactMethod
+    public void submitPacked(final ReadableArray packed, final Promise promise) {
+        final int size = packed.size() / PACKED_FIELDS;
+        if (queuePacked(packed, size)) {
+            handler.post(new Runnable() {
+                @Override
+                public void run() {
+                    drainEvents();
+
+                    // Only the records of this batch, the ones of a later batch wait for its own runnable
+                    int count = packedQueue.drain(size);
+                    ByteBuffer records = packedQueue.records();
+                    for (int offset = 0; offset < count * ODDynatracePackedQueue.RECORD_LENGTH;
+                            offset += ODDynatracePackedQueue.RECORD_LENGTH) {
+                        dispatchPacked(records.getInt(offset + ODDynatracePackedQueue.TYPE_OFFSET),
+                                records.getInt(offset + ODDynatracePackedQueue.HANDLE_OFFSET),
+                                records.getInt(offset + ODDynatracePackedQueue.NAME_ID_OFFSET),
+                                records.getDouble(offset + ODDynatracePackedQueue.VALUE_OFFSET));
+                    }
+                    packedBatchDispatched(size, promise);
+                }
+            });
+            return;
+        }
+
+        handler.post(new Runnable() {
+            @Override
+            public void run() {
+                drainEvents();
+
+                for (int i = 0; i < size * PACKED_FIELDS; i += PACKED_FIELDS) {
+                    dispatchPacked(packed.getInt(i), packed.getInt(i + 1), packed.getInt(i + 2), packed.getDouble(i + 3));
+                }
+                packedBatchDispatched(size, promise);
+            }
+        });
+    }
+
+    // Copies the batch into the native queue on the calling thread, false when there is no native queue
+    // or the batch does not fit, then the module thread reads it from the array
+    private boolean queuePacked(ReadableArray packed, int size) {
+        if (packedQueue == null || size > packedQueue.records().capacity() / ODDynatracePackedQueue.RECORD_LENGTH) {
+            return false;
+        }
+        int count = size * PACKED_FIELDS;
+        if (packedNumbers.length < count) {
+            packedNumbers = new double[count];
+        }
+        for (int i = 0; i < count; i++) {
+            packedNumbers[i] = packed.getDouble(i);
+        }
+        return packedQueue.push(packedNumbers, count);
+    }
+
+    private void packedBatchDispatched(int size, Promise promise) {
+        telemetry.recordBatch(size, size * PACKED_FIELDS * 8);
+        if (flushScheduler != null) {
+            flushScheduler.eventsReported(size);
+        }
+        refreshRequestTag();
+        promise.resolve(null);
+    }
+
+    private void dispatchPacked(int type, int handle, int nameId, double value) {
+        if (type == PACKED_RECORD_VALUE) {
+            metrics.record(value, nameId);
+            return;
+        }
+        if (type <= ODDynatraceEvent.ENTER_ACTION || type >= ODDynatraceEvent.TYPE_COUNT
+                || type == ODDynatraceEvent.REPORT_STRING_VALUE) {
+            statusCounts.count(DynatraceUEM.CPWR_Error_InvalidParameter);
+            return;
+        }
+        ODDynatraceEvent event = recordEvent.set(type, handle, nameId);
+        if (type == ODDynatraceEvent.REPORT_DOUBLE_VALUE) {
+            event.doubleValue = value;
+        } else {
+            event.intValue = (int) value;
+        }
+        if (!dropEvent(event)) {
+            dispatchEvent(event);
+        }
+    }
+
+    // Resolves with the id of each name, to use instead of the name in the other methods
+    @ReactMethod
+    public void registerNames(ReadableArray names, Promise promise) {
+        promise.resolve(registerNamesArray(names));
+    }
+
+    // Resolves with the header to add to the request and the handle of its timing
+    @ReactMethod
+    public void startWebRequest(String url, final Promise promise) {
+        handler.post(new Runnable() {
+            @Override
+            public void run() {
+                String value = DynatraceUEM.getRequestTag();
+                int handle = ODDynatraceHandleTable.INVALID_HANDLE;
+                if (value != null) {
+                    WebRequestTiming timing = DynatraceUEM.getWebRequestTiming(value);
+                    if (timing != null && timing.startWebRequestTiming() == DynatraceUEM.CPWR_UemOn) {
+                        handle = webRequests.add(timing);
+                    }
+                }
+                WritableMap result = Arguments.createMap();
+                result.putInt("handle", handle);
+                result.putString("header", DynatraceUEM.getRequestTagHeader());
+                result.putString("value", value);
+                promise.resolve(result);
+            }
+        });
+    }
+
+    // The Android SDK does not take the status code of manually timed requests
+    @ReactMethod
+    public void stopWebRequest(final int handle, int statusCode) {
+        handler.post(new Runnable() {
+            @Override
+            public void run() {
+                WebRequestTiming timing = webRequests.remove(handle);
+                if (timing != null) {
+                    timing.stopWebRequestTiming();
+                }
+            }
+        });
+    }
+
+    // Resolves with the header and value tagging requests to the current action, value is null before startup
+    @ReactMethod
+    public void getRequestTag(final Promise promise) {
+        handler.post(new Runnable() {
+            @Override
+            public void run() {
+                drainEvents();
+                promise.resolve(requestTagMap());
+            }
+        });
+    }
+
+    // Last tag of the module thread, without waiting for the events still queued
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public WritableMap getRequestTagSync() {
+        return requestTagMap();
+    }
+
+    // Snapshot of the module telemetry with the stats below, see README "Module stats"
+    @ReactMethod
+    public void getStats(final Promise promise) {
+        handler.post(new Runnable() {
+            @Override
+            public void run() {
+                promise.resolve(stats());
+            }
+        });
+    }
+
+    @ReactMethod
+    public void getEventBufferStats(Promise promise) {
+        promise.resolve(eventBufferStats());
+    }
+
+    @ReactMethod
+    public void getSpillLogStats(Promise promise) {
+        promise.resolve(spillLogStats());
+    }
+
+    // Resolves with the number of results per status name since the module was created
+    @ReactMethod
+    public void getStatusCounts(final Promise promise) {
+        handler.post(new Runnable() {
+            @Override
+            public void run() {
+                promise.resolve(statusCounts.toMap());
+            }
+        });
+    }
+
+    // Times in milliseconds spent waiting for the startup trigger, and in the ADK startup
+    @ReactMethod
+    public void getStartupStats(final Promise promise) {
+        handler.post(new Runnable() {
+            @Override
+            public void run() {
+                promise.resolve(startupStats());
+            }
+        });
+    }
+
+    @ReactMethod
+    public void getSamplingStats(Promise promise) {
+        promise.resolve(samplingStats());
+    }
+
+    // On the module thread
+    private WritableMap stats() {
+        WritableMap stats = telemetry.snapshot();
+        stats.putMap("eventBuffer", eventBufferStats());
+        stats.putMap("spillLog", spillLogStats());
+        stats.putMap("sampling", samplingStats());
+        stats.putMap("startup", startupStats());
+        stats.putMap("statusCounts", statusCounts.toMap());
+        return stats;
+    }
+
+    private WritableMap eventBufferStats() {
+        WritableMap stats = Arguments.createMap();
+        stats.putInt("capacity", events.capacity());
+        stats.putInt("count", events.count());
+        stats.putDouble("dropped", events.droppedCount());
+        return stats;
+    }
+
+    private WritableMap spillLogStats() {
+        WritableMap stats = Arguments.createMap();
+        stats.putInt("capacity", spillLog != null ? spillLog.capacity() : 0);
+        stats.putInt("size", spillLog != null ? spillLog.size() : 0);
+        stats.putDouble("dropped", spillLog != null ? spillLog.droppedCount() : 0);
+        return stats;
+    }
+
+    private WritableMap startupStats() {
+        WritableMap stats = Arguments.createMap();
+        stats.putInt("statusCode", startupStatus);
+        stats.putDouble("wait", startupWait);
+        stats.putDouble("duration", startupDuration);
+        return stats;
+    }
+
+    private WritableMap samplingStats() {
+        ODDynatraceSampler sampler = this.sampler;
+        WritableMap stats = Arguments.createMap();
+        stats.putDouble("sampled", sampler != null ? sampler.sampledCount() : 0);
+        stats.putDouble("rateLimited", sampler != null ? sampler.rateLimitedCount() : 0);
+        return stats;
+    }
+
+    // Called directly on the JS thread without a bridge message when synchronous calls are available.
+    // They only reserve a handle and queue an event, the ADK is called from the module thread.
+
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public int enterActionSync(String actionName, int parentAction) {
+        return enterAction(actionName, parentAction);
+    }
+
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public boolean leaveActionSync(int action) {
+        leaveAction(action);
+        return true;
+    }
+
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public boolean reportEventSync(int action, String eventName) {
+        reportEvent(action, eventName);
+        return true;
+    }
+
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public boolean reportIntValueSync(int action, String valueName, int value) {
+        reportValue(action, valueName, value);
+        return true;
+    }
+
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public boolean reportDoubleValueSync(int action, String valueName, double value) {
+        reportValue(action, valueName, value);
+        return true;
+    }
+
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public boolean reportStringValueSync(int action, String valueName, String value) {
+        reportValue(action, valueName, value);
+        return true;
+    }
+
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public boolean reportErrorSync(int action, String errorName, int errorValue) {
+        reportError(action, errorName, errorValue);
+        return true;
+    }
+
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public WritableArray registerNamesSync(ReadableArray names) {
+        return registerNamesArray(names);
+    }
+
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public boolean recordValueSync(String name, double value) {
+        recordValue(name, value);
+        return true;
+    }
+
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public boolean recordValueWithIdSync(int nameId, double value) {
+        recordValue(nameId, value);
+        return true;
+    }
+
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public int enterActionWithIdSync(int actionNameId, int parentAction) {
+        return enterAction(actionNameId, parentAction);
+    }
+
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public boolean reportEventWithIdSync(int action, int eventNameId) {
+        reportEvent(action, eventNameId);
+        return true;
+    }
+
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public boolean reportIntValueWithIdSync(int action, int valueNameId, int value) {
+        reportValue(action, valueNameId, value);
+        return true;
+    }
+
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public boolean reportDoubleValueWithIdSync(int action, int valueNameId, double value) {
+        reportValue(action, valueNameId, value);
+        return true;
+    }
+
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    public boolean reportErrorWithIdSync(int action, int errorNameId, int errorValue) {
+        reportError(action, errorNameId, errorValue);
+        return true;
+    }
+
+    private WritableArray registerNamesArray(ReadableArray names) {
+        WritableArray nameIds = Arguments.createArray();
+        for (int i = 0; i < names.size(); i++) {
+            nameIds.pushInt(this.names.register(names.getString(i)));
+        }
+        return nameIds;
+    }
+
+    // Native instrumentation API, for other native modules and background workers.
+    // These methods can be called from any thread, the ADK is called from the module thread. Entering an action
+    // reserves its handle under the handle table lock, and checks its parent under the same lock. The other calls
+    // only queue an event in the lock-free buffer.
+
+    public int enterAction(String actionName) {
+        return enterAction(actionName, ODDynatraceHandleTable.INVALID_HANDLE);
+    }
+
+    // Returns a negative status code when the parent action does not exist or already ended.
+    // Leaving an action leaves its children first.
+    public int enterAction(String actionName, int parentAction) {
+        if (parentAction != ODDynatraceHandleTable.INVALID_HANDLE && !actions.contains(parentAction)) {
+            return missingActionStatus(parentAction);
+        }
+        if (dropName(actionName)) {
+            return ODDynatraceHandleTable.INVALID_HANDLE;
+        }
+        int handle = actions.reserve();
+        if (handle != ODDynatraceHandleTable.INVALID_HANDLE) {
+            ODDynatraceEvent event = pushedEvent.get().set(ODDynatraceEvent.ENTER_ACTION, handle, actionName);
+            event.parent = parentAction;
+            pushEvent(event);
+        }
+        return handle;
+    }
+
+    public void leaveAction(int action) {
+        pushEvent(pushedEvent.get().set(ODDynatraceEvent.LEAVE_ACTION, action, null));
+    }
+
+    public void reportEvent(int action, String eventName) {
+        pushEvent(pushedEvent.get().set(ODDynatraceEvent.REPORT_EVENT, action, eventName));
+    }
+
+    public void reportValue(int action, String valueName, int intValue) {
+        ODDynatraceEvent event = pushedEvent.get().set(ODDynatraceEvent.REPORT_INT_VALUE, action, valueName);
+        event.intValue = intValue;
+        pushEvent(event);
+    }
+
+    public void reportValue(int action, String valueName, double doubleValue) {
+        ODDynatraceEvent event = pushedEvent.get().set(ODDynatraceEvent.REPORT_DOUBLE_VALUE, action, valueName);
+        event.doubleValue = doubleValue;
+        pushEvent(event);
+    }
+
+    public void reportValue(int action, String valueName, String stringValue) {
+        ODDynatraceEvent event = pushedEvent.get().set(ODDynatraceEvent.REPORT_STRING_VALUE, action, valueName);
+        event.stringValue = stringValue;
+        pushEvent(event);
+    }
+
+    public void reportError(int action, String errorName, int errorValue) {
+        ODDynatraceEvent event = pushedEvent.get().set(ODDynatraceEvent.REPORT_ERROR, action, errorName);
+        event.intValue = errorValue;
+        pushEvent(event);
+    }
+
+    // Aggregates high frequency values natively, only their count, min, max, p50, p90 and p99 are reported
+    // periodically as values of an action named after them. The name variant registers the name on each call,
+    // taking the name table lock : frequent callers register it once and use the id variant.
+    public void recordValue(String name, double value) {
+        metrics.record(value, names.register(name));
+    }
+
+    public void recordValue(int nameId, double value) {
+        metrics.record(value, nameId);
+    }
+
+    // Variants taking names registered once, so the calls do not go through strings
+
+    public int registerName(String name) {
+        return names.register(name);
+    }
+
+    public int enterAction(int actionNameId) {
+        return enterAction(actionNameId, ODDynatraceHandleTable.INVALID_HANDLE);
+    }
+
+    public int enterAction(int actionNameId, int parentAction) {
+        if (parentAction != ODDynatraceHandleTable.INVALID_HANDLE && !actions.contains(parentAction)) {
+            return missingActionStatus(parentAction);
+        }
+        if (dropName(names.get(actionNameId))) {
+            return ODDynatraceHandleTable.INVALID_HANDLE;
+        }
+        int handle = actions.reserve();
+        if (handle != ODDynatraceHandleTable.INVALID_HANDLE) {
+            ODDynatraceEvent event = pushedEvent.get().set(ODDynatraceEvent.ENTER_ACTION, handle, actionNameId);
+            event.parent = parentAction;
+            pushEvent(event);
+        }
+        return handle;
+    }
+
+    public void reportEvent(int action, int eventNameId) {
+        pushEvent(pushedEvent.get().set(ODDynatraceEvent.REPORT_EVENT, action, eventNameId));
+    }
+
+    public void reportValue(int action, int valueNameId, int intValue) {
+        ODDynatraceEvent event = pushedEvent.get().set(ODDynatraceEvent.REPORT_INT_VALUE, action, valueNameId);
+        event.intValue = intValue;
+        pushEvent(event);
+    }
+
+    public void reportValue(int action, int valueNameId, double doubleValue) {
+        ODDynatraceEvent event = pushedEvent.get().set(ODDynatraceEvent.REPORT_DOUBLE_VALUE, action, valueNameId);
+        event.doubleValue = doubleValue;
+        pushEvent(event);
+    }
+
+    public void reportError(int action, int errorNameId, int errorValue) {
+        ODDynatraceEvent event = pushedEvent.get().set(ODDynatraceEvent.REPORT_ERROR, action, errorNameId);
+        event.intValue = errorValue;
+        pushEvent(event);
+    }
+
+    private void pushEvent(ODDynatraceEvent event) {
+        if (event.type != ODDynatraceEvent.ENTER_ACTION && dropEvent(event)) {
+            return;
+        }
+        events.push(event);
+        if (drainScheduled.compareAndSet(false, true)) {
+            handler.post(drainRunnable);
+        }
+    }
+
+    private boolean dropName(String name) {
+        ODDynatraceSampler sampler = this.sampler;
+        return sampler != null && sampler.drop(name);
+    }
+
+    // Events of actions sampled out at enter are dropped with them, without being counted again
+    private boolean dropEvent(ODDynatraceEvent event) {
+        if (event.handle == ODDynatraceHandleTable.INVALID_HANDLE) {
+            return true;
+        }
+        if (event.type == ODDynatraceEvent.LEAVE_ACTION) {
+            return false;
+        }
+        return dropName(event.name != null ? event.name : names.get(event.nameId));
+    }
+
+    // Only called on the module thread
+    private void drainEvents() {
+        int count = 0;
+        while (events.pop(drainedEvent)) {
+            dispatchEvent(drainedEvent);
+            count++;
+        }
+        telemetry.recordQueueDepth(count);
+        if (flushScheduler != null) {
+            flushScheduler.eventsReported(count);
+        }
+        refreshRequestTag();
+    }
+
+    // The tag depends on the innermost open action, it is asked again once per batch or drain having entered
+    // or left actions
+    private void refreshRequestTag() {
+        if (!requestTagStale || !started) {
+            return;
+        }
+        requestTagStale = false;
+        requestTag = DynatraceUEM.getRequestTag();
+    }
+
+    private WritableMap requestTagMap() {
+        WritableMap tag = Arguments.createMap();
+        tag.putString("header", DynatraceUEM.getRequestTagHeader());
+        tag.putString("value", requestTag);
+        return tag;
+    }
+
+    // Screen marks only update the times of the screen, its action and values go through the buffer
+    private int dispatchScreenRecord(ReadableMap record) {
+        String name = record.hasKey("nameId") ? names.get(record.getInt("nameId")) : record.getString("name");
+        String mark = record.getString("mark");
+        if (name == null) {
+            return DynatraceUEM.CPWR_Error_InvalidParameter;
+        }
+        if ("enter".equals(mark)) {
+            screens.enter(name, record.getDouble("time"));
+        } else if ("render".equals(mark)) {
+            screens.render(name, record.getDouble("time"));
+        } else if ("exit".equals(mark)) {
+            screens.exit(name);
+        } else {
+            return DynatraceUEM.CPWR_Error_InvalidParameter;
+        }
+        return DynatraceUEM.CPWR_UemOn;
+    }
+
+    // Estimated size of a record on the bridge : UTF-16 strings and 8 bytes numbers, keys excluded
+    private static long recordSize(ReadableMap record) {
+        long size = 0;
+        ReadableMapKeySetIterator keys = record.keySetIterator();
+        while (keys.hasNextKey()) {
+            String key = keys.nextKey();
+            size += record.getType(key) == ReadableType.String ? record.getString(key).length() * 2 : 8;
+        }
+        return size;
+    }
+
+    private int dispatchRecord(ReadableMap record) {
+        // Recorded values never reach the ADK one by one
+        if ("record".equals(record.getString("type"))) {
+            if (record.hasKey("nameId")) {
+                recordValue(record.getInt("nameId"), record.getDouble("value"));
+            } else {
+                recordValue(record.getString("name"), record.getDouble("value"));
+            }
+            return DynatraceUEM.CPWR_UemOn;
+        }
+        if ("screen".equals(record.getString("type"))) {
+            return dispatchScreenRecord(record);
+        }
+
+        int type = ODDynatraceEvent.typeFromString(record.getString("type"));
+        if (type < 0) {
+            return DynatraceUEM.CPWR_Error_InvalidParameter;
+        }
+
+        int handle;
+        if (type == ODDynatraceEvent.ENTER_ACTION) {
+            String actionName = record.hasKey("nameId") ? names.get(record.getInt("nameId")) : record.getString("name");
+            handle = dropName(actionName) ? ODDynatraceHandleTable.INVALID_HANDLE : actions.reserve();
+        } else {
+            handle = handleForRecord(record);
+        }
+        // Leave records have no name
+        ODDynatraceEvent event = record.hasKey("nameId")
+                ? recordEvent.set(type, handle, record.getInt("nameId"))
+                : recordEvent.set(type, handle, record.hasKey("name") ? record.getString("name") : null);
+        if (type != ODDynatraceEvent.ENTER_ACTION && handle != ODDynatraceHandleTable.INVALID_HANDLE && dropEvent(event)) {
+            return DynatraceUEM.CPWR_UemOff;
+        }
+        if (record.hasKey("parent")) {
+            event.parent = record.getInt("parent");
+        }
+        if (type == ODDynatraceEvent.REPORT_DOUBLE_VALUE) {
+            event.doubleValue = record.getDouble("value");
+        } else if (type == ODDynatraceEvent.REPORT_STRING_VALUE) {
+            event.stringValue = record.getString("value");
+        } else if (record.hasKey("value")) {
+            event.intValue = record.getInt("value");
+        }
+        return dispatchEvent(event);
+    }
+
+    private int handleForRecord(ReadableMap record) {
+        if (record.hasKey("handle")) {
+            return record.getInt("handle");
+        }
+
+        // Records of the same batch reporting to the same action name share one action
+        if (!record.hasKey("action")) {
+            return ODDynatraceHandleTable.INVALID_HANDLE;
+        }
+        String actionName = record.getString("action");
+        Integer handle = batchActions.get(actionName);
+        if (handle == null) {
+            int reserved = dropName(actionName) ? ODDynatraceHandleTable.INVALID_HANDLE : actions.reserve();
+            handle = dispatchEvent(recordEvent.set(ODDynatraceEvent.ENTER_ACTION, reserved, actionName));
+            batchActions.put(actionName, handle);
+        }
+        return handle;
+    }
+
+    // Only place calling the ADK for actions. Returns the handle for enter events, the ADK status code otherwise.
+    // Entered actions are counted as CPWR_UemOn, sampled out ones are not counted.
+    private int dispatchEvent(ODDynatraceEvent event) {
+        // Repeats are only counted, see ODDynatraceCoalescer
+        if (coalescer != null && coalescer.coalesce(event)) {
+            statusCounts.count(DynatraceUEM.CPWR_UemOn);
+            return DynatraceUEM.CPWR_UemOn;
+        }
+        // Written before calling the ADK, so a crash in the call keeps it
+        if (breadcrumbs != null && event.handle != ODDynatraceHandleTable.INVALID_HANDLE) {
+            breadcrumbs.add(event.type, event.name != null ? event.name : names.get(event.nameId));
+        }
+        long start = System.nanoTime();
+        int result = performEvent(event);
+        telemetry.recordEvent(event.type, System.nanoTime() - start);
+        if (coalescer != null && result == DynatraceUEM.CPWR_UemOn) {
+            coalescer.add(event);
+        }
+        if (event.type == ODDynatraceEvent.ENTER_ACTION || event.type == ODDynatraceEvent.LEAVE_ACTION) {
+            requestTagStale = true;
+        }
+        if (event.type == ODDynatraceEvent.ENTER_ACTION && result > 0) {
+            statusCounts.count(DynatraceUEM.CPWR_UemOn);
+        } else {
+            statusCounts.count(result);
+        }
+        return result;
+    }
+
+    private int performEvent(ODDynatraceEvent event) {
+        String name = event.name != null ? event.name : names.get(event.nameId);
+        if (!started) {
+            return spillEvent(event, name);
+        }
+        if (event.type == ODDynatraceEvent.ENTER_ACTION) {
+            return dispatchEnterAction(event, name);
+        }
+        if (event.type == ODDynatraceEvent.LEAVE_ACTION) {
+            return dispatchLeaveAction(event.handle);
+        }
+
+        UemAction action = actions.get(event.handle);
+        if (action == null) {
+            return missingActionStatus(event.handle);
+        }
+        if (name == null) {
+            return DynatraceUEM.CPWR_Error_InvalidParameter;
+        }
+        switch (event.type) {
+            case ODDynatraceEvent.REPORT_EVENT:
+                return action.reportEvent(name);
+            case ODDynatraceEvent.REPORT_INT_VALUE:
+                return action.reportValue(name, event.intValue);
+            case ODDynatraceEvent.REPORT_DOUBLE_VALUE:
+                return action.reportValue(name, event.doubleValue);
+            case ODDynatraceEvent.REPORT_STRING_VALUE:
+                return action.reportValue(name, event.stringValue);
+            case ODDynatraceEvent.REPORT_ERROR:
+                return action.reportError(name, event.intValue);
+            default:
+                return DynatraceUEM.CPWR_Error_InvalidParameter;
+        }
+    }
+
+    private int dispatchEnterAction(ODDynatraceEvent event, String name) {
+        if (event.handle == ODDynatraceHandleTable.INVALID_HANDLE) {
+            return ODDynatraceHandleTable.INVALID_HANDLE;
+        }
+        UemAction parent = null;
+        if (event.parent != ODDynatraceHandleTable.INVALID_HANDLE) {
+            parent = actions.get(event.parent);
+            if (parent == null) {
+                actions.remove(event.handle);
+                return missingActionStatus(event.parent);
+            }
+        }
+        if (name == null) {
+            actions.remove(event.handle);
+            return DynatraceUEM.CPWR_Error_InvalidParameter;
+        }
+        UemAction action = parent != null ? DynatraceUEM.enterAction(name, parent) : DynatraceUEM.enterAction(name);
+        if (action == null) {
+            actions.remove(event.handle);
+            return ODDynatraceHandleTable.INVALID_HANDLE;
+        }
+        actions.set(event.handle, action);
+        actionTree.add(event.handle, event.parent);
+        return event.handle;
+    }
+
+    // Children are left before their parent, deepest first, so none of them stays open in the table
+    private int dispatchLeaveAction(int handle) {
+        int child;
+        while ((child = actionTree.firstChildOf(handle)) != ODDynatraceHandleTable.INVALID_HANDLE) {
+            dispatchLeaveAction(child);
+        }
+        if (coalescer != null) {
+            coalescer.flushAction(handle);
+        }
+        actionTree.remove(handle);
+        UemAction action = actions.remove(handle);
+        return action != null ? action.leaveAction() : missingActionStatus(handle);
+    }
+
+    private int missingActionStatus(int handle) {
+        return actions.isStale(handle) ? DynatraceUEM.CPWR_Error_ActionEnded : DynatraceUEM.CPWR_Error_ActionNotFound;
+    }
+
+    // Keeps the event until the ADK is started. The handle of a spilled enter stays reserved until the replay.
+    private int spillEvent(ODDynatraceEvent event, String name) {
+        if (event.type == ODDynatraceEvent.ENTER_ACTION) {
+            if (event.handle == ODDynatraceHandleTable.INVALID_HANDLE) {
+                return ODDynatraceHandleTable.INVALID_HANDLE;
+            }
+            if (name == null || spillLog == null || !spillLog.append(event, name)) {
+                actions.remove(event.handle);
+                return ODDynatraceHandleTable.INVALID_HANDLE;
+            }
+            return event.handle;
+        }
+        if (event.handle == ODDynatraceHandleTable.INVALID_HANDLE) {
+            return DynatraceUEM.CPWR_Error_ActionNotFound;
+        }
+        return spillLog != null && spillLog.append(event, name != null ? name : "")
+                ? DynatraceUEM.CPWR_UemOn
+                : DynatraceUEM.CPWR_Error_NotInitialized;
+    }
+
+    private void replaySpillLog() {
+        if (spillLog == null) {
+            return;
+        }
+        // Handles written by a previous launch are remapped, and their actions still open left after the replay
+        final Map<Integer, Integer> previousActions = new HashMap<>();
+        spillLog.replay(new ODDynatraceSpillLog.Replayer() {
+            @Override
+            public void replay(ODDynatraceEvent event, boolean previousLaunch) {
+                if (previousLaunch) {
+                    int previousHandle = event.handle;
+                    if (event.type == ODDynatraceEvent.ENTER_ACTION) {
+                        Integer parent = previousActions.get(event.parent);
+                        event.handle = actions.reserve();
+                        event.parent = parent != null ? parent : ODDynatraceHandleTable.INVALID_HANDLE;
+                        previousActions.put(previousHandle, event.handle);
+                    } else {
+                        Integer handle = event.type == ODDynatraceEvent.LEAVE_ACTION
+                                ? previousActions.remove(previousHandle)
+                                : previousActions.get(previousHandle);
+                        event.handle = handle != null ? handle : ODDynatraceHandleTable.INVALID_HANDLE;
+                    }
+                }
+                dispatchEvent(event);
+            }
+        });
+        for (int handle : previousActions.values()) {
+            dispatchEvent(recordEvent.set(ODDynatraceEvent.LEAVE_ACTION, handle, null));
+        }
     }
-}
\ No newline at end of file
+}
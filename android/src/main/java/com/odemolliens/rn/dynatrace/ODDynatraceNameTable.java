@@ -0,0 +1,52 @@
+//
+//  ODDynatraceNameTable.java
+//  ODDynatraceNameTable
+//
+//  Created by OLIVIER DEMOLLIENS on 04/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import java.util.HashMap;
+import java.util.Map;
+import java.util.concurrent.atomic.AtomicReferenceArray;
+
+// Interned action, event and value names, mirrors ODDynatraceNameTable.m.
+// Registering a name is locked and done once, looking a name up by id afterwards
+// is lock-free and allocation-free, from any thread.
+class ODDynatraceNameTable {
+
+    static final int INVALID_NAME_ID = 0;
+
+    private final AtomicReferenceArray<String> names;
+    private final Map<String, Integer> ids = new HashMap<>();
+    private volatile int count;
+
+    ODDynatraceNameTable(int capacity) {
+        names = new AtomicReferenceArray<>(capacity);
+    }
+
+    int count() {
+        return count;
+    }
+
+    // Returns the existing id of an already registered name, INVALID_NAME_ID when the table is full
+    synchronized int register(String name) {
+        Integer nameId = ids.get(name);
+        if (nameId != null) {
+            return nameId;
+        }
+        if (count >= names.length()) {
+            return INVALID_NAME_ID;
+        }
+        names.set(count, name);
+        ids.put(name, count + 1);
+        count++;
+        return count;
+    }
+
+    String get(int nameId) {
+        return nameId > INVALID_NAME_ID && nameId <= count ? names.get(nameId - 1) : null;
+    }
+}
@@ -0,0 +1,78 @@
+//
+//  ODDynatracePackedQueue.java
+//  ODDynatracePackedQueue
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+// Packed batches queued in native memory by the thread receiving them and drained by the module thread,
+// through the PackedQueue of the native core (cpp/jni/ODDynatracePackedQueue.cpp). A single thread pushes.
+class ODDynatracePackedQueue {
+
+    // Drained records : int type, int handle, int name id, 4 bytes of padding, double value
+    static final int RECORD_LENGTH = 24;
+    static final int TYPE_OFFSET = 0;
+    static final int HANDLE_OFFSET = 4;
+    static final int NAME_ID_OFFSET = 8;
+    static final int VALUE_OFFSET = 16;
+
+    private static final boolean loaded = loadLibrary();
+
+    // Only changed by release()
+    private volatile long queue;
+    private final ByteBuffer records;
+
+    private static boolean loadLibrary() {
+        try {
+            System.loadLibrary("oddynatrace_jni");
+            return true;
+        } catch (UnsatisfiedLinkError e) {
+            return false;
+        }
+    }
+
+    // Returns null when the native library is not packaged, e.g. in the JVM unit tests
+    static ODDynatracePackedQueue create(int capacity) {
+        return loaded ? new ODDynatracePackedQueue(capacity) : null;
+    }
+
+    private ODDynatracePackedQueue(int capacity) {
+        queue = nativeCreate(capacity);
+        records = ByteBuffer.allocateDirect(nativeCapacity(queue) * RECORD_LENGTH).order(ByteOrder.nativeOrder());
+    }
+
+    // Queues the records of the first count numbers, PACKED_FIELDS per record.
+    // Returns false without queuing anything when they do not all fit.
+    boolean push(double[] packed, int count) {
+        return queue != 0 && nativePush(queue, packed, count);
+    }
+
+    // Moves up to maxCount of the oldest records into records(), returns how many. Module thread only.
+    int drain(int maxCount) {
+        return queue != 0 ? nativeDrain(queue, records, maxCount) : 0;
+    }
+
+    ByteBuffer records() {
+        return records;
+    }
+
+    // On the module thread, once no batch can be pushed anymore
+    void release() {
+        if (queue != 0) {
+            nativeDestroy(queue);
+            queue = 0;
+        }
+    }
+
+    private static native long nativeCreate(int capacity);
+    private static native int nativeCapacity(long queue);
+    private static native boolean nativePush(long queue, double[] packed, int count);
+    private static native int nativeDrain(long queue, ByteBuffer records, int maxCount);
+    private static native void nativeDestroy(long queue);
+}
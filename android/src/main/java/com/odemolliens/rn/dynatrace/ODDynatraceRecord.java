@@ -0,0 +1,127 @@
+//
+//  ODDynatraceRecord.java
+//  ODDynatraceRecord
+//
+//  Created by OLIVIER DEMOLLIENS on 18/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.Charset;
+
+// Binary layout of an event, same as ODDynatraceRecord.h. An instance is a view on a record
+// of a little-endian buffer: fields are read in place, only the strings are copied when asked for.
+final class ODDynatraceRecord {
+
+    static final int VERSION = 1;
+    static final int HEADER_LENGTH = 40;
+
+    private static final Charset UTF8 = Charset.forName("UTF-8");
+
+    private ByteBuffer buffer;
+    private int offset;
+
+    // Writes the event into the buffer at offset. Returns its length, 0 when it does not fit.
+    static int encode(ByteBuffer buffer, int offset, ODDynatraceEvent event, byte[] name, byte[] stringValue,
+                      int writer, long timestamp) {
+        int stringLength = stringValue != null ? stringValue.length : 0;
+        int length = HEADER_LENGTH + name.length + stringLength;
+        if (name.length > 0xFFFF || length > buffer.limit() - offset) {
+            return 0;
+        }
+        buffer.order(ByteOrder.LITTLE_ENDIAN);
+        buffer.putInt(offset, length);
+        buffer.put(offset + 4, (byte) VERSION);
+        buffer.put(offset + 5, (byte) event.type);
+        buffer.putShort(offset + 6, (short) name.length);
+        buffer.putInt(offset + 8, event.handle);
+        buffer.putInt(offset + 12, event.nameId);
+        buffer.putInt(offset + 16, writer);
+        buffer.putInt(offset + 20, stringLength);
+        buffer.putLong(offset + 24, timestamp);
+        if (event.type == ODDynatraceEvent.ENTER_ACTION) {
+            buffer.putLong(offset + 32, event.parent);
+        } else if (event.type == ODDynatraceEvent.REPORT_DOUBLE_VALUE) {
+            buffer.putDouble(offset + 32, event.doubleValue);
+        } else {
+            buffer.putLong(offset + 32, event.intValue);
+        }
+        ByteBuffer strings = buffer.duplicate();
+        strings.position(offset + HEADER_LENGTH);
+        strings.put(name);
+        if (stringValue != null) {
+            strings.put(stringValue);
+        }
+        return length;
+    }
+
+    // Points the view at the record at offset. Returns its length,
+    // 0 when the buffer is truncated or the record has an unknown version.
+    int wrap(ByteBuffer buffer, int offset, int limit) {
+        if (limit - offset < HEADER_LENGTH || buffer.get(offset + 4) != VERSION) {
+            return 0;
+        }
+        buffer.order(ByteOrder.LITTLE_ENDIAN);
+        int length = buffer.getInt(offset);
+        // Lengths are unsigned, a corrupt string length must not make the sum match
+        long expected = (long) HEADER_LENGTH + nameLengthAt(buffer, offset) + (buffer.getInt(offset + 20) & 0xFFFFFFFFL);
+        if (length < HEADER_LENGTH || length > limit - offset || expected != length) {
+            return 0;
+        }
+        this.buffer = buffer;
+        this.offset = offset;
+        return length;
+    }
+
+    int type() {
+        return buffer.get(offset + 5);
+    }
+
+    int handle() {
+        return buffer.getInt(offset + 8);
+    }
+
+    int nameId() {
+        return buffer.getInt(offset + 12);
+    }
+
+    int writer() {
+        return buffer.getInt(offset + 16);
+    }
+
+    long timestamp() {
+        return buffer.getLong(offset + 24);
+    }
+
+    // Also the parent handle of enter events
+    int intValue() {
+        return buffer.getInt(offset + 32);
+    }
+
+    double doubleValue() {
+        return buffer.getDouble(offset + 32);
+    }
+
+    String name() {
+        return string(offset + HEADER_LENGTH, nameLengthAt(buffer, offset));
+    }
+
+    String stringValue() {
+        return string(offset + HEADER_LENGTH + nameLengthAt(buffer, offset), buffer.getInt(offset + 20));
+    }
+
+    private String string(int position, int length) {
+        byte[] bytes = new byte[length];
+        ByteBuffer strings = buffer.duplicate();
+        strings.position(position);
+        strings.get(bytes);
+        return new String(bytes, UTF8);
+    }
+
+    private static int nameLengthAt(ByteBuffer buffer, int offset) {
+        return buffer.getShort(offset + 6) & 0xFFFF;
+    }
+}
@@ -0,0 +1,113 @@
+//
+//  ODDynatraceSampler.java
+//  ODDynatraceSampler
+//
+//  Created by OLIVIER DEMOLLIENS on 11/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import java.util.HashMap;
+import java.util.Map;
+import java.util.Random;
+import java.util.concurrent.atomic.AtomicLong;
+
+import com.facebook.react.bridge.ReadableMap;
+import com.facebook.react.bridge.ReadableMapKeySetIterator;
+
+// Decides which actions and events reach the ADK, mirrors ODDynatraceSampler.m.
+// A name is either always or never sampled during a session. Safe to call from any thread without locking.
+class ODDynatraceSampler {
+
+    private final long seed = new Random().nextLong();
+    private final boolean sessionSampled;
+    private final Map<String, Double> sampleRates = new HashMap<>();
+    // Token bucket kept as the time the next event is allowed, in ns (GCRA)
+    private final long interval;
+    private final long burstTolerance;
+    private final AtomicLong allowedAt = new AtomicLong(Long.MIN_VALUE);
+    private final AtomicLong sampledCount = new AtomicLong();
+    private final AtomicLong rateLimitedCount = new AtomicLong();
+
+    ODDynatraceSampler(ReadableMap options) {
+        double sampleRate = options != null && options.hasKey("sampleRate") ? options.getDouble("sampleRate") : 1;
+        sessionSampled = keep(seed, sampleRate);
+
+        if (options != null && options.hasKey("sampleRates")) {
+            ReadableMap rates = options.getMap("sampleRates");
+            ReadableMapKeySetIterator iterator = rates.keySetIterator();
+            while (iterator.hasNextKey()) {
+                String name = iterator.nextKey();
+                sampleRates.put(name, rates.getDouble(name));
+            }
+        }
+
+        double rateLimit = options != null && options.hasKey("rateLimit") ? options.getDouble("rateLimit") : 0;
+        if (rateLimit > 0) {
+            double burst = options.hasKey("rateLimitBurst") ? Math.max(options.getDouble("rateLimitBurst"), 1) : 1;
+            interval = (long) (1e9 / rateLimit);
+            burstTolerance = (long) ((burst - 1) * interval);
+        } else {
+            interval = 0;
+            burstTolerance = 0;
+        }
+    }
+
+    long sampledCount() {
+        return sampledCount.get();
+    }
+
+    long rateLimitedCount() {
+        return rateLimitedCount.get();
+    }
+
+    // True when the action or event of this name has to be dropped
+    boolean drop(String name) {
+        if (!sessionSampled) {
+            sampledCount.incrementAndGet();
+            return true;
+        }
+        Double sampleRate = name != null ? sampleRates.get(name) : null;
+        if (sampleRate != null && !keep(seed ^ name.hashCode(), sampleRate)) {
+            sampledCount.incrementAndGet();
+            return true;
+        }
+        if (!acquireToken()) {
+            rateLimitedCount.incrementAndGet();
+            return true;
+        }
+        return false;
+    }
+
+    private boolean acquireToken() {
+        if (interval == 0) {
+            return true;
+        }
+        long now = System.nanoTime();
+        while (true) {
+            long current = allowedAt.get();
+            long start = Math.max(current, now);
+            if (start - now > burstTolerance) {
+                return false;
+            }
+            if (allowedAt.compareAndSet(current, start + interval)) {
+                return true;
+            }
+        }
+    }
+
+    // splitmix64 finalizer, spreads close keys over the whole range
+    private static long mix(long key) {
+        key = (key ^ (key >>> 30)) * 0xbf58476d1ce4e5b9L;
+        key = (key ^ (key >>> 27)) * 0x94d049bb133111ebL;
+        return key ^ (key >>> 31);
+    }
+
+    private static boolean keep(long key, double rate) {
+        if (rate >= 1) {
+            return true;
+        }
+        return (mix(key) >>> 11) * 0x1.0p-53 < rate;
+    }
+}
@@ -0,0 +1,111 @@
+//
+//  ODDynatraceScreens.java
+//  ODDynatraceScreens
+//
+//  Created by OLIVIER DEMOLLIENS on 04/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import android.os.Handler;
+import android.os.Looper;
+import android.os.MessageQueue;
+
+import java.util.HashMap;
+import java.util.Map;
+
+// Screens marked from JS, mirrors ODDynatraceScreens.m. Each screen is an action open from its enter
+// to its exit, reporting "Time to first render" and "Time to interactive" (first main thread idle after
+// the first render) in milliseconds. Times are milliseconds since 1970, same clock as Date.now().
+// Only used from the module thread.
+class ODDynatraceScreens {
+
+    interface Reporter {
+        // Returns the handle of the action entered for the screen
+        int enterScreen(String name);
+
+        void reportValue(int action, String valueName, double value);
+
+        void exitScreen(int action);
+    }
+
+    private static final class Screen {
+        final int action;
+        final double enterTime;
+        boolean rendered;
+
+        Screen(int action, double enterTime) {
+            this.action = action;
+            this.enterTime = enterTime;
+        }
+    }
+
+    private final Handler handler;
+    private final Handler mainHandler = new Handler(Looper.getMainLooper());
+    private final Reporter reporter;
+    private final Map<String, Screen> screens = new HashMap<>();
+
+    ODDynatraceScreens(Handler handler, Reporter reporter) {
+        this.handler = handler;
+        this.reporter = reporter;
+    }
+
+    void enter(String name, double time) {
+        exit(name);
+        int action = reporter.enterScreen(name);
+        if (action != ODDynatraceHandleTable.INVALID_HANDLE) {
+            screens.put(name, new Screen(action, time));
+        }
+    }
+
+    void render(final String name, double time) {
+        final Screen screen = screens.get(name);
+        if (screen == null || screen.rendered) {
+            return;
+        }
+        screen.rendered = true;
+        reportValue(screen, "Time to first render", time);
+
+        mainHandler.post(new Runnable() {
+            @Override
+            public void run() {
+                Looper.myQueue().addIdleHandler(new MessageQueue.IdleHandler() {
+                    @Override
+                    public boolean queueIdle() {
+                        final double idleTime = System.currentTimeMillis();
+                        handler.post(new Runnable() {
+                            @Override
+                            public void run() {
+                                // Skipped when the screen was left before
+                                if (screens.get(name) == screen) {
+                                    reportValue(screen, "Time to interactive", idleTime);
+                                }
+                            }
+                        });
+                        return false;
+                    }
+                });
+            }
+        });
+    }
+
+    void exit(String name) {
+        Screen screen = screens.remove(name);
+        if (screen != null) {
+            reporter.exitScreen(screen.action);
+        }
+    }
+
+    // Leaves the open screens
+    void invalidate() {
+        for (Screen screen : screens.values()) {
+            reporter.exitScreen(screen.action);
+        }
+        screens.clear();
+    }
+
+    private void reportValue(Screen screen, String valueName, double time) {
+        reporter.reportValue(screen.action, valueName, Math.max(time - screen.enterTime, 0));
+    }
+}
@@ -0,0 +1,120 @@
+//
+//  ODDynatraceSpillLog.java
+//  ODDynatraceSpillLog
+//
+//  Created by OLIVIER DEMOLLIENS on 15/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import java.io.File;
+import java.io.IOException;
+import java.io.RandomAccessFile;
+import java.nio.ByteOrder;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.charset.Charset;
+import java.util.Random;
+
+// Events recorded while the ADK is not started, kept in a memory-mapped file of bounded size
+// until they can be replayed, mirrors ODDynatraceSpillLog.m. A record is only counted once fully
+// written, so the file stays readable after a crash. Only used from the module thread.
+class ODDynatraceSpillLog {
+
+    interface Replayer {
+        // Event strings are only valid during the call. Handles of events written by a previous
+        // launch do not exist anymore.
+        void replay(ODDynatraceEvent event, boolean previousLaunch);
+    }
+
+    private static final int MAGIC = 0x4c53444f; // "ODSL"
+    private static final int VERSION = 2;
+    // Followed by ODDynatraceRecord records. The size is written last, readers ignore the records past it.
+    private static final int HEADER_LENGTH = 16;
+    private static final int SIZE_OFFSET = 8;
+    private static final Charset UTF8 = Charset.forName("UTF-8");
+
+    private final MappedByteBuffer bytes;
+    private final int capacity;
+    private final int launch = new Random().nextInt();
+    private final ODDynatraceEvent replayedEvent = new ODDynatraceEvent();
+    private final ODDynatraceRecord record = new ODDynatraceRecord();
+    private long droppedCount;
+
+    // Returns null when the file can't be mapped
+    static ODDynatraceSpillLog open(File file, int capacity) {
+        try {
+            return new ODDynatraceSpillLog(file, Math.max(capacity, HEADER_LENGTH));
+        } catch (IOException e) {
+            return null;
+        }
+    }
+
+    private ODDynatraceSpillLog(File file, int capacity) throws IOException {
+        this.capacity = capacity;
+        RandomAccessFile randomAccessFile = new RandomAccessFile(file, "rw");
+        try {
+            randomAccessFile.setLength(capacity);
+            bytes = randomAccessFile.getChannel().map(FileChannel.MapMode.READ_WRITE, 0, capacity);
+        } finally {
+            randomAccessFile.close();
+        }
+        bytes.order(ByteOrder.LITTLE_ENDIAN);
+        if (bytes.getInt(0) != MAGIC || bytes.getInt(4) != VERSION
+                || size() < 0 || size() > capacity - HEADER_LENGTH) {
+            bytes.putInt(0, MAGIC);
+            bytes.putInt(4, VERSION);
+            bytes.putInt(SIZE_OFFSET, 0);
+        }
+    }
+
+    int capacity() {
+        return capacity;
+    }
+
+    int size() {
+        return bytes.getInt(SIZE_OFFSET);
+    }
+
+    long droppedCount() {
+        return droppedCount;
+    }
+
+    // The name replaces the event name id, which is not kept across launches. Returns false when full.
+    boolean append(ODDynatraceEvent event, String name) {
+        byte[] stringValue = event.type == ODDynatraceEvent.REPORT_STRING_VALUE && event.stringValue != null
+                ? event.stringValue.getBytes(UTF8)
+                : null;
+        int length = ODDynatraceRecord.encode(bytes, HEADER_LENGTH + size(), event, name.getBytes(UTF8), stringValue,
+                launch, System.currentTimeMillis());
+        if (length == 0) {
+            droppedCount++;
+            return false;
+        }
+        bytes.putInt(SIZE_OFFSET, size() + length);
+        return true;
+    }
+
+    // Calls the replayer with each event in order, then empties the log
+    void replay(Replayer replayer) {
+        int offset = HEADER_LENGTH;
+        int end = HEADER_LENGTH + size();
+        int length;
+        while ((length = record.wrap(bytes, offset, end)) > 0) {
+            ODDynatraceEvent event = replayedEvent.set(record.type(), record.handle(), record.name());
+            if (event.type == ODDynatraceEvent.ENTER_ACTION) {
+                event.parent = record.intValue();
+            } else if (event.type == ODDynatraceEvent.REPORT_STRING_VALUE) {
+                event.stringValue = record.stringValue();
+            } else if (event.type == ODDynatraceEvent.REPORT_DOUBLE_VALUE) {
+                event.doubleValue = record.doubleValue();
+            } else {
+                event.intValue = record.intValue();
+            }
+            replayer.replay(event, record.writer() != launch);
+            offset += length;
+        }
+        bytes.putInt(SIZE_OFFSET, 0);
+    }
+}
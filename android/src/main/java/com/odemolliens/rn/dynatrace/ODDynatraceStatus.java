@@ -0,0 +1,90 @@
+//
+//  ODDynatraceStatus.java
+//  ODDynatraceStatus
+//
+//  Created by OLIVIER DEMOLLIENS on 20/11/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import com.dynatrace.apm.uem.mobile.android.DynatraceUEM;
+import com.facebook.react.bridge.Arguments;
+import com.facebook.react.bridge.WritableMap;
+
+// Status code names and descriptions, kept identical to ODDynatraceStatus.m
+final class ODDynatraceStatus {
+
+    private ODDynatraceStatus() {
+    }
+
+    static String name(int statusCode) {
+        switch (statusCode) {
+            case DynatraceUEM.CPWR_UemOff:
+                return "CPWR_UemOff";
+            case DynatraceUEM.CPWR_UemOn:
+                return "CPWR_UemOn";
+            case DynatraceUEM.CPWR_Error_NotInitialized:
+                return "CPWR_Error_NotInitialized";
+            case DynatraceUEM.CPWR_Error_ActionNotFound:
+                return "CPWR_Error_ActionNotFound";
+            case DynatraceUEM.CPWR_Error_InvalidParameter:
+                return "CPWR_Error_InvalidParameter";
+            case DynatraceUEM.CPWR_Error_ActionEnded:
+                return "CPWR_Error_ActionEnded";
+            case DynatraceUEM.CPWR_ReportErrorOff:
+                return "CPWR_ReportErrorOff";
+            default:
+                return "CPWR_Unknown(" + statusCode + ")";
+        }
+    }
+
+    static String description(int statusCode) {
+        switch (statusCode) {
+            case DynatraceUEM.CPWR_UemOff:
+                return "ADK is not enabled or can't capture data";
+            case DynatraceUEM.CPWR_UemOn:
+                return "Successful";
+            case DynatraceUEM.CPWR_Error_NotInitialized:
+                return "ADK is not initialized";
+            case DynatraceUEM.CPWR_Error_InvalidParameter:
+                return "a parameter is null or empty";
+            case DynatraceUEM.CPWR_Error_ActionNotFound:
+                return "action not found";
+            case DynatraceUEM.CPWR_Error_ActionEnded:
+                return "action already ended";
+            default:
+                return "Failed";
+        }
+    }
+
+    // Number of results per status code, so failures can be read on demand instead of per call.
+    // Not thread safe, only used on the module thread.
+    static final class Counts {
+
+        // Status codes range from -10 to 5, same as ODDynatraceStatus.m
+        private static final int MIN = -10;
+        private static final int MAX = 5;
+
+        private final long[] counts = new long[MAX - MIN + 1];
+
+        // Codes out of the range are ignored
+        void count(int statusCode) {
+            if (statusCode != 0 && statusCode >= MIN && statusCode <= MAX) {
+                counts[statusCode - MIN]++;
+            }
+        }
+
+        // Count per status name, e.g. { CPWR_UemOn: 12, CPWR_Error_ActionEnded: 1 }
+        WritableMap toMap() {
+            WritableMap map = Arguments.createMap();
+            for (int statusCode = MIN; statusCode <= MAX; statusCode++) {
+                long count = counts[statusCode - MIN];
+                if (count > 0) {
+                    map.putDouble(name(statusCode), count);
+                }
+            }
+            return map;
+        }
+    }
+}
@@ -0,0 +1,130 @@
+//
+//  ODDynatraceTelemetry.java
+//  ODDynatraceTelemetry
+//
+//  Created by OLIVIER DEMOLLIENS on 05/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import android.os.Handler;
+
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.atomic.AtomicLongArray;
+
+import com.facebook.react.bridge.Arguments;
+import com.facebook.react.bridge.ReadableMap;
+import com.facebook.react.bridge.WritableMap;
+
+// Cost of the module itself, mirrors ODDynatraceTelemetry.m. Counters are atomics and the time spent
+// in the ADK goes to one lock-free ODDynatraceHistogram per event type, so it stays enabled.
+// Recording is allowed from any thread, snapshots are taken on the module thread.
+class ODDynatraceTelemetry {
+
+    private final AtomicLongArray eventCounts = new AtomicLongArray(ODDynatraceEvent.TYPE_COUNT);
+    private final ODDynatraceHistogram[] latencies = new ODDynatraceHistogram[ODDynatraceEvent.TYPE_COUNT];
+    private final ODDynatraceHistogram.Summary summary = new ODDynatraceHistogram.Summary();
+    private final AtomicLong batchCount = new AtomicLong();
+    private final AtomicLong recordCount = new AtomicLong();
+    private final AtomicLong byteCount = new AtomicLong();
+    private final AtomicLong maxQueueDepth = new AtomicLong();
+    private final Runnable dump;
+    private Handler handler;
+    private long interval;
+
+    // Only used by the snapshots
+    private final long startTime = System.nanoTime();
+    private long snapshotTime = startTime;
+    private long snapshotEventCount;
+
+    private final Runnable dumpRunnable = new Runnable() {
+        @Override
+        public void run() {
+            dump.run();
+            handler.postDelayed(this, interval);
+        }
+    };
+
+    ODDynatraceTelemetry(Runnable dump) {
+        this.dump = dump;
+        for (int i = 0; i < latencies.length; i++) {
+            latencies[i] = new ODDynatraceHistogram();
+        }
+    }
+
+    void recordEvent(int type, long nanoseconds) {
+        if (type < 0 || type >= ODDynatraceEvent.TYPE_COUNT) {
+            return;
+        }
+        eventCounts.incrementAndGet(type);
+        latencies[type].record(nanoseconds / 1e3);
+    }
+
+    // Estimated bytes of the records received from JS
+    void recordBatch(int records, long bytes) {
+        batchCount.incrementAndGet();
+        recordCount.addAndGet(records);
+        byteCount.addAndGet(bytes);
+    }
+
+    // Number of events found in the buffer by one drain, kept as the maximum queue depth
+    void recordQueueDepth(int depth) {
+        long maxDepth = maxQueueDepth.get();
+        while (depth > maxDepth && !maxQueueDepth.compareAndSet(maxDepth, depth)) {
+            maxDepth = maxQueueDepth.get();
+        }
+    }
+
+    // Counters since the module was created, latencies in microseconds and rates since the previous snapshot
+    WritableMap snapshot() {
+        long now = System.nanoTime();
+        double elapsed = (now - snapshotTime) / 1e9;
+        snapshotTime = now;
+
+        WritableMap events = Arguments.createMap();
+        long eventCount = 0;
+        for (int i = 0; i < ODDynatraceEvent.TYPE_COUNT; i++) {
+            long count = eventCounts.get(i);
+            eventCount += count;
+            boolean recorded = latencies[i].summarize(summary);
+            WritableMap event = Arguments.createMap();
+            event.putDouble("count", count);
+            event.putDouble("p50", recorded ? summary.p50 : 0);
+            event.putDouble("p99", recorded ? summary.p99 : 0);
+            event.putDouble("max", recorded ? summary.max : 0);
+            events.putMap(ODDynatraceEvent.typeToString(i), event);
+        }
+        double eventsPerSecond = elapsed > 0 ? (eventCount - snapshotEventCount) / elapsed : 0;
+        snapshotEventCount = eventCount;
+
+        WritableMap snapshot = Arguments.createMap();
+        snapshot.putDouble("uptime", (now - startTime) / 1e9);
+        snapshot.putDouble("interval", elapsed);
+        snapshot.putDouble("eventsPerSecond", eventsPerSecond);
+        snapshot.putDouble("batches", batchCount.get());
+        snapshot.putDouble("records", recordCount.get());
+        snapshot.putDouble("bytes", byteCount.get());
+        snapshot.putDouble("maxQueueDepth", maxQueueDepth.getAndSet(0));
+        snapshot.putMap("events", events);
+        return snapshot;
+    }
+
+    // Dumps every statsDumpInterval seconds (startup option, disabled by default)
+    void start(ReadableMap options, Handler handler) {
+        invalidate();
+        this.handler = handler;
+        interval = options != null && options.hasKey("statsDumpInterval")
+                ? (long) (options.getDouble("statsDumpInterval") * 1000)
+                : 0;
+        if (interval > 0) {
+            handler.postDelayed(dumpRunnable, interval);
+        }
+    }
+
+    void invalidate() {
+        if (handler != null) {
+            handler.removeCallbacks(dumpRunnable);
+        }
+    }
+}
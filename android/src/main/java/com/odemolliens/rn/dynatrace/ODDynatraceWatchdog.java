@@ -0,0 +1,132 @@
+//
+//  ODDynatraceWatchdog.java
+//  ODDynatraceWatchdog
+//
+//  Created by OLIVIER DEMOLLIENS on 27/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import android.os.Handler;
+
+import com.facebook.react.bridge.ReactApplicationContext;
+import com.facebook.react.bridge.ReadableMap;
+
+// Pings the JS thread and measures how late it runs the ping, mirrors ODDynatraceWatchdog.m.
+// Disabled unless watchdogInterval is set. The latencies are aggregated in an ODDynatraceHistogram.
+// Only used from the module thread.
+class ODDynatraceWatchdog {
+
+    // Latencies of the JS thread over one report interval, in milliseconds
+    static final class Report {
+        double p50;
+        double p95;
+        double p99;
+        double max;
+        int sampleCount;
+        int longTaskCount;
+    }
+
+    interface Reporter {
+        void report(Report report);
+    }
+
+    private final Handler handler;
+    private final ReactApplicationContext reactContext;
+    private final long interval;
+    private final long longTaskThreshold;
+    private final long reportInterval;
+    private final Reporter reporter;
+
+    private boolean started;
+    private boolean pingPending;
+    private long nextReportTime;
+    private final ODDynatraceHistogram latencies = new ODDynatraceHistogram();
+    private final ODDynatraceHistogram.Summary summary = new ODDynatraceHistogram.Summary();
+    private final Report report = new Report();
+    private int longTaskCount;
+
+    private final Runnable tickRunnable = new Runnable() {
+        @Override
+        public void run() {
+            tick();
+            handler.postDelayed(this, interval / 1000000);
+        }
+    };
+
+    ODDynatraceWatchdog(ReadableMap options, Handler handler, ReactApplicationContext reactContext, Reporter reporter) {
+        this.handler = handler;
+        this.reactContext = reactContext;
+        this.reporter = reporter;
+        interval = nanos(options, "watchdogInterval", 0, 1000000);
+        longTaskThreshold = nanos(options, "longTaskThreshold", 50, 1000000);
+        reportInterval = nanos(options, "watchdogReportInterval", 60, 1000000000);
+    }
+
+    private static long nanos(ReadableMap options, String key, double defaultValue, long unit) {
+        return (long) ((options != null && options.hasKey(key) ? options.getDouble(key) : defaultValue) * unit);
+    }
+
+    void start() {
+        if (interval <= 0 || started) {
+            return;
+        }
+        started = true;
+        nextReportTime = System.nanoTime() + reportInterval;
+        handler.postDelayed(tickRunnable, interval / 1000000);
+    }
+
+    void invalidate() {
+        started = false;
+        handler.removeCallbacks(tickRunnable);
+    }
+
+    private void tick() {
+        final long now = System.nanoTime();
+        if (now >= nextReportTime) {
+            report();
+            nextReportTime = now + reportInterval;
+        }
+        if (pingPending) {
+            return;
+        }
+
+        // The latency is measured on the JS thread, then recorded back on the module thread
+        pingPending = true;
+        reactContext.runOnJSQueueThread(new Runnable() {
+            @Override
+            public void run() {
+                final long latency = System.nanoTime() - now;
+                handler.post(new Runnable() {
+                    @Override
+                    public void run() {
+                        recordLatency(latency);
+                    }
+                });
+            }
+        });
+    }
+
+    private void recordLatency(long latency) {
+        pingPending = false;
+        latencies.record(latency / 1e6);
+        if (latency >= longTaskThreshold) {
+            longTaskCount++;
+        }
+    }
+
+    private void report() {
+        if (!latencies.summarize(summary)) {
+            return;
+        }
+        report.p50 = summary.p50;
+        report.p95 = summary.p95;
+        report.p99 = summary.p99;
+        report.max = summary.max;
+        report.sampleCount = (int) summary.count;
+        report.longTaskCount = longTaskCount;
+        reporter.report(report);
+        longTaskCount = 0;
+    }
+}
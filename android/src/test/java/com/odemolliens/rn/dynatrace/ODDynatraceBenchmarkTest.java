@@ -0,0 +1,169 @@
+//
+//  ODDynatraceBenchmarkTest.java
+//  ODDynatraceBenchmarkTest
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import static org.junit.Assert.assertEquals;
+
+import java.nio.ByteBuffer;
+import java.nio.charset.Charset;
+
+import org.junit.Test;
+
+// Timings of the native building blocks, same cases as ODDynatraceBenchmarkTests.m. Each case runs once to warm
+// the JIT up, then prints the ns per operation of a second run. They are not asserted, timings are too noisy on a
+// shared machine to fail the build : compare the printed results of ./gradlew test between commits.
+public class ODDynatraceBenchmarkTest {
+
+    private static final int OPERATIONS = 100000;
+    private static final int PRODUCERS = 4;
+
+    private interface Operations {
+        void run() throws Exception;
+    }
+
+    private static void measure(String name, int operations, Operations block) throws Exception {
+        block.run();
+        long start = System.nanoTime();
+        block.run();
+        System.out.println(String.format("%s : %.1f ns/op", name, (System.nanoTime() - start) / (double) operations));
+    }
+
+    private static ODDynatraceEvent valueEvent(ODDynatraceEvent event, int value) {
+        event.set(ODDynatraceEvent.REPORT_INT_VALUE, 1, 1);
+        event.intValue = value;
+        return event;
+    }
+
+    @Test
+    public void eventBufferPushPop() throws Exception {
+        final ODDynatraceEventBuffer buffer = new ODDynatraceEventBuffer(1024, ODDynatraceEventBuffer.OverflowPolicy.DROP_NEWEST);
+        final ODDynatraceEvent event = new ODDynatraceEvent();
+        final ODDynatraceEvent popped = new ODDynatraceEvent();
+        measure("Event buffer push and pop", OPERATIONS, new Operations() {
+            @Override
+            public void run() {
+                for (int i = 0; i < OPERATIONS; i++) {
+                    buffer.push(valueEvent(event, i));
+                    buffer.pop(popped);
+                }
+            }
+        });
+        assertEquals(0, buffer.droppedCount());
+    }
+
+    // Producers of several threads pushing while the consumer pops, as with native callers and the module thread
+    @Test
+    public void eventBufferContendedPush() throws Exception {
+        final ODDynatraceEventBuffer buffer = new ODDynatraceEventBuffer(1024, ODDynatraceEventBuffer.OverflowPolicy.DROP_NEWEST);
+        measure("Event buffer push, " + PRODUCERS + " producers", OPERATIONS, new Operations() {
+            @Override
+            public void run() throws Exception {
+                Thread[] producers = new Thread[PRODUCERS];
+                for (int p = 0; p < PRODUCERS; p++) {
+                    producers[p] = new Thread(new Runnable() {
+                        @Override
+                        public void run() {
+                            ODDynatraceEvent event = new ODDynatraceEvent();
+                            for (int i = 0; i < OPERATIONS / PRODUCERS; i++) {
+                                buffer.push(valueEvent(event, i));
+                            }
+                        }
+                    });
+                    producers[p].start();
+                }
+                ODDynatraceEvent popped = new ODDynatraceEvent();
+                for (Thread producer : producers) {
+                    while (producer.isAlive()) {
+                        buffer.pop(popped);
+                    }
+                    producer.join();
+                }
+                while (buffer.pop(popped)) {
+                }
+            }
+        });
+    }
+
+    @Test
+    public void handleTableAddRemove() throws Exception {
+        final ODDynatraceHandleTable<Object> table = new ODDynatraceHandleTable<>(64);
+        final Object object = new Object();
+        measure("Handle table add and remove", OPERATIONS, new Operations() {
+            @Override
+            public void run() {
+                for (int i = 0; i < OPERATIONS; i++) {
+                    table.remove(table.add(object));
+                }
+            }
+        });
+    }
+
+    @Test
+    public void handleTableLookup() throws Exception {
+        final ODDynatraceHandleTable<Object> table = new ODDynatraceHandleTable<>(64);
+        final int[] handles = new int[64];
+        for (int i = 0; i < handles.length; i++) {
+            handles[i] = table.add(i);
+        }
+        measure("Handle table lookup", OPERATIONS, new Operations() {
+            @Override
+            public void run() {
+                for (int i = 0; i < OPERATIONS; i++) {
+                    table.get(handles[i % handles.length]);
+                }
+            }
+        });
+    }
+
+    @Test
+    public void recordEncodeDecode() throws Exception {
+        final ODDynatraceEvent event = new ODDynatraceEvent();
+        final byte[] name = "Items".getBytes(Charset.forName("UTF-8"));
+        final ByteBuffer buffer = ByteBuffer.allocate(ODDynatraceRecord.HEADER_LENGTH + name.length);
+        final ODDynatraceRecord record = new ODDynatraceRecord();
+        measure("Record encode and decode", OPERATIONS, new Operations() {
+            @Override
+            public void run() {
+                for (int i = 0; i < OPERATIONS; i++) {
+                    int length = ODDynatraceRecord.encode(buffer, 0, valueEvent(event, i), name, null, 0, i);
+                    record.wrap(buffer, 0, length);
+                    record.intValue();
+                }
+            }
+        });
+    }
+
+    @Test
+    public void histogramRecord() throws Exception {
+        final ODDynatraceHistogram histogram = new ODDynatraceHistogram();
+        measure("Histogram record", OPERATIONS, new Operations() {
+            @Override
+            public void run() {
+                for (int i = 0; i < OPERATIONS; i++) {
+                    histogram.record(0.5 + i % 1000);
+                }
+            }
+        });
+    }
+
+    @Test
+    public void histogramSummarize() throws Exception {
+        final ODDynatraceHistogram histogram = new ODDynatraceHistogram();
+        final ODDynatraceHistogram.Summary summary = new ODDynatraceHistogram.Summary();
+        measure("Histogram summarize", OPERATIONS / 100, new Operations() {
+            @Override
+            public void run() {
+                for (int i = 0; i < OPERATIONS / 100; i++) {
+                    histogram.record(0.5 + i % 1000);
+                    histogram.summarize(summary);
+                }
+            }
+        });
+    }
+}
@@ -0,0 +1,220 @@
+//
+//  ODDynatraceRecordTest.java
+//  ODDynatraceRecordTest
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+package com.odemolliens.rn.dynatrace;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.Charset;
+import java.util.Random;
+
+import com.facebook.react.bridge.JavaOnlyMap;
+
+import org.junit.Test;
+
+// Round trips of random events through the binary codec, and decoding of truncated and corrupt records,
+// same cases as ODDynatraceRecordTests.m
+public class ODDynatraceRecordTest {
+
+    private static final Charset UTF8 = Charset.forName("UTF-8");
+    private static final int ITERATIONS = 10000;
+    private static final int THROUGHPUT_RECORDS = 200000;
+
+    private final Random random = new Random(42);
+
+    private String randomString(int maxLength) {
+        StringBuilder builder = new StringBuilder();
+        int length = random.nextInt(maxLength + 1);
+        for (int i = 0; i < length; i++) {
+            // ASCII, accented letters and characters outside the BMP
+            int kind = random.nextInt(3);
+            builder.appendCodePoint(kind == 0 ? 0x20 + random.nextInt(0x5f)
+                    : kind == 1 ? 0xc0 + random.nextInt(0x40)
+                    : 0x1f600 + random.nextInt(0x40));
+        }
+        return builder.toString();
+    }
+
+    private ODDynatraceEvent randomEvent() {
+        ODDynatraceEvent event = new ODDynatraceEvent().set(random.nextInt(ODDynatraceEvent.TYPE_COUNT),
+                random.nextInt(), randomString(40));
+        event.nameId = random.nextInt();
+        event.parent = random.nextInt();
+        event.intValue = random.nextInt();
+        event.doubleValue = random.nextDouble() * random.nextInt();
+        if (event.type == ODDynatraceEvent.REPORT_STRING_VALUE) {
+            event.stringValue = randomString(200);
+        }
+        return event;
+    }
+
+    private static byte[] bytes(String string) {
+        return string != null ? string.getBytes(UTF8) : null;
+    }
+
+    private static ByteBuffer encoded(ODDynatraceEvent event) {
+        ByteBuffer buffer = ByteBuffer.allocate(4096);
+        int length = ODDynatraceRecord.encode(buffer, 0, event, bytes(event.name), bytes(event.stringValue), 7, 1515456000000L);
+        assertTrue(length > 0);
+        buffer.limit(length);
+        return buffer;
+    }
+
+    @Test
+    public void roundTripsRandomEvents() {
+        ByteBuffer buffer = ByteBuffer.allocate(64 * 1024);
+        ODDynatraceRecord record = new ODDynatraceRecord();
+        for (int i = 0; i < ITERATIONS; i++) {
+            ODDynatraceEvent event = randomEvent();
+            int offset = random.nextInt(1024);
+            long timestamp = random.nextLong();
+            int length = ODDynatraceRecord.encode(buffer, offset, event, bytes(event.name), bytes(event.stringValue),
+                    i, timestamp);
+            assertEquals(ODDynatraceRecord.HEADER_LENGTH + bytes(event.name).length
+                    + (event.stringValue != null ? bytes(event.stringValue).length : 0), length);
+
+            assertEquals(length, record.wrap(buffer, offset, offset + length));
+            assertEquals(event.type, record.type());
+            assertEquals(event.handle, record.handle());
+            assertEquals(event.nameId, record.nameId());
+            assertEquals(i, record.writer());
+            assertEquals(timestamp, record.timestamp());
+            assertEquals(event.name, record.name());
+            if (event.type == ODDynatraceEvent.ENTER_ACTION) {
+                assertEquals(event.parent, record.intValue());
+            } else if (event.type == ODDynatraceEvent.REPORT_DOUBLE_VALUE) {
+                assertEquals(event.doubleValue, record.doubleValue(), 0);
+            } else {
+                assertEquals(event.intValue, record.intValue());
+            }
+            assertEquals(event.stringValue != null ? event.stringValue : "", record.stringValue());
+        }
+    }
+
+    @Test
+    public void doesNotEncodeRecordsNotFitting() {
+        ODDynatraceEvent event = new ODDynatraceEvent().set(ODDynatraceEvent.REPORT_EVENT, 1, "Refresh");
+        int length = encoded(event).limit();
+        ByteBuffer buffer = ByteBuffer.allocate(length - 1);
+        assertEquals(0, ODDynatraceRecord.encode(buffer, 0, event, bytes(event.name), null, 0, 0));
+        assertEquals(0, ODDynatraceRecord.encode(ByteBuffer.allocate(1 << 17), 0, event, new byte[0x10000], null, 0, 0));
+    }
+
+    @Test
+    public void rejectsTruncatedRecords() {
+        ODDynatraceEvent event = new ODDynatraceEvent().set(ODDynatraceEvent.REPORT_STRING_VALUE, 1, "Status");
+        event.stringValue = "Loaded";
+        ByteBuffer buffer = encoded(event);
+        ODDynatraceRecord record = new ODDynatraceRecord();
+        for (int limit = 0; limit < buffer.limit(); limit++) {
+            assertEquals(0, record.wrap(buffer, 0, limit));
+        }
+    }
+
+    @Test
+    public void rejectsOtherVersions() {
+        ByteBuffer buffer = encoded(new ODDynatraceEvent().set(ODDynatraceEvent.LEAVE_ACTION, 1, ""));
+        ODDynatraceRecord record = new ODDynatraceRecord();
+        for (int version = 0; version < 256; version++) {
+            buffer.put(4, (byte) version);
+            assertEquals(version == ODDynatraceRecord.VERSION ? buffer.limit() : 0, record.wrap(buffer, 0, buffer.limit()));
+        }
+    }
+
+    @Test
+    public void rejectsInconsistentLengths() {
+        ODDynatraceEvent event = new ODDynatraceEvent().set(ODDynatraceEvent.REPORT_STRING_VALUE, 1, "Status");
+        event.stringValue = "Loaded";
+        ByteBuffer buffer = encoded(event).order(ByteOrder.LITTLE_ENDIAN);
+        ODDynatraceRecord record = new ODDynatraceRecord();
+        int length = buffer.limit();
+
+        buffer.putInt(0, length - 1);
+        assertEquals(0, record.wrap(buffer, 0, length));
+        buffer.putInt(0, length);
+        buffer.putShort(6, (short) 7);
+        assertEquals(0, record.wrap(buffer, 0, length));
+        // A string length read as negative must not balance a longer name
+        buffer.putShort(6, (short) 18);
+        buffer.putInt(20, -6);
+        assertEquals(0, record.wrap(buffer, 0, length));
+    }
+
+    @Test
+    public void decodesRandomBytesWithoutThrowing() {
+        ByteBuffer buffer = ByteBuffer.allocate(256).order(ByteOrder.LITTLE_ENDIAN);
+        ODDynatraceRecord record = new ODDynatraceRecord();
+        byte[] bytes = new byte[256];
+        for (int i = 0; i < ITERATIONS; i++) {
+            random.nextBytes(bytes);
+            buffer.clear();
+            buffer.put(bytes);
+            buffer.put(4, (byte) ODDynatraceRecord.VERSION);
+            // Small lengths, so some of the random records are consistent
+            buffer.putInt(0, random.nextInt(256));
+            buffer.putShort(6, (short) random.nextInt(128));
+            buffer.putInt(20, random.nextInt(4) == 0 ? random.nextInt() : random.nextInt(128));
+            int limit = random.nextInt(257);
+            int length = record.wrap(buffer, 0, limit);
+            if (length > 0) {
+                assertTrue(length <= limit);
+                record.name();
+                record.stringValue();
+            }
+        }
+    }
+
+    // Writes and reads the same value records through the codec and through maps like the ones of submitBatch,
+    // and prints the records per second of both. Only the results are asserted, timings are too noisy on a
+    // shared machine to fail the build.
+    @Test
+    public void comparesCodecThroughputWithMaps() {
+        ODDynatraceEvent event = new ODDynatraceEvent().set(ODDynatraceEvent.REPORT_INT_VALUE, 1, "Items");
+        byte[] name = bytes(event.name);
+        ByteBuffer buffer = ByteBuffer.allocate(ODDynatraceRecord.HEADER_LENGTH + name.length);
+        ODDynatraceRecord record = new ODDynatraceRecord();
+        long codecSum = 0;
+        long mapSum = 0;
+        long codecTime = 0;
+        long mapTime = 0;
+        // The first pass warms the JIT up
+        for (int pass = 0; pass < 2; pass++) {
+            codecSum = 0;
+            long start = System.nanoTime();
+            for (int i = 0; i < THROUGHPUT_RECORDS; i++) {
+                event.intValue = i;
+                int length = ODDynatraceRecord.encode(buffer, 0, event, name, null, 0, i);
+                if (record.wrap(buffer, 0, length) > 0 && record.type() == ODDynatraceEvent.REPORT_INT_VALUE) {
+                    codecSum += record.handle() + record.intValue() + record.name().length();
+                }
+            }
+            codecTime = System.nanoTime() - start;
+
+            mapSum = 0;
+            start = System.nanoTime();
+            for (int i = 0; i < THROUGHPUT_RECORDS; i++) {
+                JavaOnlyMap map = new JavaOnlyMap();
+                map.putString("type", "intValue");
+                map.putInt("handle", 1);
+                map.putString("name", "Items");
+                map.putInt("value", i);
+                if (ODDynatraceEvent.typeFromString(map.getString("type")) == ODDynatraceEvent.REPORT_INT_VALUE) {
+                    mapSum += map.getInt("handle") + map.getInt("value") + map.getString("name").length();
+                }
+            }
+            mapTime = System.nanoTime() - start;
+        }
+
+        System.out.println(String.format("Record codec : %.0f records/s, maps : %.0f records/s",
+                THROUGHPUT_RECORDS * 1e9 / codecTime, THROUGHPUT_RECORDS * 1e9 / mapTime));
+        assertEquals(mapSum, codecSum);
+    }
+}
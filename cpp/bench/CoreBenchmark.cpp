@@ -0,0 +1,186 @@
+//
+//  CoreBenchmark.cpp
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "MockBackend.h"
+#include "oddynatrace/Core.h"
+#include "oddynatrace/PackedQueue.h"
+
+using namespace oddynatrace;
+
+// Every allocation of the process is counted, so each benchmark can report its allocations per operation.
+// GCC sees the replaced operators inlined at call sites and takes the malloc / free pairs for mismatches.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+static std::atomic<uint64_t> allocationCount{0};
+
+void *operator new(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace {
+
+class AllocationCounter {
+public:
+    explicit AllocationCounter(benchmark::State &state) : state_(state), start_(allocationCount.load()) {}
+
+    ~AllocationCounter()
+    {
+        state_.counters["allocs/op"] = benchmark::Counter(static_cast<double>(allocationCount.load() - start_),
+                                                          benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State &state_;
+    uint64_t start_;
+};
+
+void EventBufferPushPop(benchmark::State &state)
+{
+    EventBuffer<Event> buffer(1024);
+    int value = 0;
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        buffer.push([&](Event &event) {
+            event.type = EventType::ReportIntValue;
+            event.intValue = value++;
+        });
+        buffer.pop([](Event &event) { benchmark::DoNotOptimize(event.intValue); });
+    }
+}
+BENCHMARK(EventBufferPushPop);
+
+void HandleTableAddRemove(benchmark::State &state)
+{
+    HandleTable<Backend::Action> table;
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        table.remove(table.add(1));
+    }
+}
+BENCHMARK(HandleTableAddRemove);
+
+void HandleTableLookup(benchmark::State &state)
+{
+    HandleTable<Backend::Action> table;
+    Handle handles[64];
+    for (Backend::Action i = 0; i < 64; i++) {
+        handles[i] = table.add(i + 1);
+    }
+    size_t i = 0;
+    Backend::Action action;
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(table.get(handles[i++ % 64], action));
+    }
+}
+BENCHMARK(HandleTableLookup);
+
+// Packed batch of the Android module, 64 records queued and drained, per record
+void PackedQueuePushDrain(benchmark::State &state)
+{
+    PackedQueue queue(4096);
+    std::vector<double> packed(64 * PackedQueue::Fields, 1);
+    std::vector<uint8_t> records(64 * PackedQueue::RecordLength);
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        queue.push(packed.data(), packed.size());
+        benchmark::DoNotOptimize(queue.drain(records.data(), records.size(), 64));
+    }
+    state.SetItemsProcessed(state.iterations() * 64);
+}
+BENCHMARK(PackedQueuePushDrain);
+
+// Producer side of the core, the calls of the native API, with a consumer draining on its own thread.
+// Names are sent as ids, or as strings copied into the buffer slots.
+class CoreFixture : public benchmark::Fixture {
+public:
+    void SetUp(const benchmark::State &state) override
+    {
+        if (state.thread_index() != 0) {
+            return;
+        }
+        backend_.reset(new MockBackend(false));
+        CoreOptions options;
+        options.eventBufferCapacity = 4096;
+        core_.reset(new Core(*backend_, options));
+        core_->startup("app", "https://example.com");
+        action_ = core_->enterAction("action");
+        core_->drain();
+        stopped_ = false;
+        consumer_ = std::thread([this] {
+            while (!stopped_.load(std::memory_order_acquire)) {
+                core_->drain();
+            }
+        });
+    }
+
+    void TearDown(const benchmark::State &state) override
+    {
+        if (state.thread_index() != 0) {
+            return;
+        }
+        stopped_.store(true, std::memory_order_release);
+        consumer_.join();
+        core_->shutdown();
+    }
+
+protected:
+    std::unique_ptr<MockBackend> backend_;
+    std::unique_ptr<Core> core_;
+    Handle action_ = InvalidHandle;
+    std::thread consumer_;
+    std::atomic<bool> stopped_{false};
+};
+
+BENCHMARK_DEFINE_F(CoreFixture, ReportValueWithNameId)(benchmark::State &state)
+{
+    NameId nameId = core_->registerName("value");
+    int value = 0;
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        core_->reportValue(nameId, value++, action_);
+    }
+}
+BENCHMARK_REGISTER_F(CoreFixture, ReportValueWithNameId)->ThreadRange(1, 4)->UseRealTime();
+
+BENCHMARK_DEFINE_F(CoreFixture, ReportValueWithName)(benchmark::State &state)
+{
+    int value = 0;
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        core_->reportValue("value", value++, action_);
+    }
+}
+BENCHMARK_REGISTER_F(CoreFixture, ReportValueWithName)->ThreadRange(1, 4)->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,42 @@
+//
+//  Backend.h
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace oddynatrace {
+
+// The DynatraceUEM ADK as seen by the core : the calls of UEMAction / UemAction and DynatraceUEM,
+// returning CPWR status codes. Only called by the consumer of the events, never concurrently.
+class Backend {
+public:
+    // Opaque reference to an ADK action, e.g. a retained UEMAction or a JNI global reference
+    using Action = uintptr_t;
+
+    static constexpr Action NoAction = 0;
+
+    virtual ~Backend() = default;
+
+    virtual int32_t startup(std::string_view applicationName, std::string_view serverURL) = 0;
+    virtual int32_t shutdown() = 0;
+    virtual int32_t flush() = 0;
+
+    // NoAction when the ADK did not enter the action, parent is NoAction for root actions
+    virtual Action enterAction(std::string_view name, Action parent) = 0;
+    // Ends the action, and releases it
+    virtual int32_t leaveAction(Action action) = 0;
+    virtual int32_t reportEvent(Action action, std::string_view name) = 0;
+    virtual int32_t reportValue(Action action, std::string_view name, int32_t value) = 0;
+    virtual int32_t reportValue(Action action, std::string_view name, double value) = 0;
+    virtual int32_t reportValue(Action action, std::string_view name, std::string_view value) = 0;
+    virtual int32_t reportError(Action action, std::string_view name, int32_t errorValue) = 0;
+};
+
+} // namespace oddynatrace
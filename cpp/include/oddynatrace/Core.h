@@ -0,0 +1,115 @@
+//
+//  Core.h
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "oddynatrace/Backend.h"
+#include "oddynatrace/Event.h"
+#include "oddynatrace/EventBuffer.h"
+#include "oddynatrace/HandleTable.h"
+#include "oddynatrace/NameTable.h"
+#include "oddynatrace/Sampler.h"
+#include "oddynatrace/Status.h"
+
+namespace oddynatrace {
+
+struct CoreOptions {
+    // Size of the event buffer shared by all producers, rounded up to a power of two
+    size_t eventBufferCapacity = 1024;
+    OverflowPolicy overflowPolicy = OverflowPolicy::DropNewest;
+    size_t actionCapacity = 64;
+    size_t nameCapacity = 4096;
+};
+
+// Event pipeline of the modules : producers of any thread queue their calls, a single consumer
+// dispatches them to the ADK in order, the way ODDynatrace.m and ODDynatraceModule.java do.
+class Core {
+public:
+    explicit Core(Backend &backend, const CoreOptions &options = CoreOptions());
+
+    Core(const Core &) = delete;
+    Core &operator=(const Core &) = delete;
+
+    // Called by the producer queuing the first event after a drain, to schedule the next drain
+    // on the consumer thread. Must be set before the first event.
+    void setDrainHandler(std::function<void()> drainHandler) { drainHandler_ = std::move(drainHandler); }
+
+    // Replaces the sampler, null keeps every event. Producers keep reading the previous one
+    // without locking, so replaced samplers are only freed with the core.
+    void setSampler(std::unique_ptr<Sampler> sampler);
+    const Sampler *sampler() const { return sampler_.load(std::memory_order_acquire); }
+
+    // Producers, from any thread. Entering an action reserves its handle under the handle table lock,
+    // registering a name takes the name table lock, the other calls only queue an event.
+    NameId registerName(std::string_view name) { return names_.registerName(name); }
+    // Returns InvalidHandle when the action is sampled out or the table is full,
+    // a negative status code when the parent action does not exist or already ended
+    Handle enterAction(std::string_view name, Handle parent = InvalidHandle);
+    Handle enterAction(NameId nameId, Handle parent = InvalidHandle);
+    // Leaving an action leaves its children first
+    void leaveAction(Handle action);
+    void reportEvent(std::string_view name, Handle action);
+    void reportEvent(NameId nameId, Handle action);
+    void reportValue(std::string_view name, int32_t value, Handle action);
+    void reportValue(NameId nameId, int32_t value, Handle action);
+    void reportValue(std::string_view name, double value, Handle action);
+    void reportValue(NameId nameId, double value, Handle action);
+    void reportValue(std::string_view name, std::string_view value, Handle action);
+    void reportError(std::string_view name, int32_t errorValue, Handle action);
+    void reportError(NameId nameId, int32_t errorValue, Handle action);
+
+    // Consumer, one thread at a time
+    int32_t startup(std::string_view applicationName, std::string_view serverURL);
+    // Dispatches the queued events to the backend in order, returns how many there were
+    size_t drain();
+    int32_t flush();
+    // Dispatches the queued events, then forgets the open actions and shuts the backend down
+    int32_t shutdown();
+
+    const NameTable &names() const { return names_; }
+    uint64_t droppedCount() const { return events_.droppedCount(); }
+    size_t queuedCount() const { return events_.count(); }
+    size_t actionCount() const { return actions_.count(); }
+    // Only read on the consumer thread
+    const StatusCounts &statusCounts() const { return statusCounts_; }
+
+private:
+    Handle enter(std::string_view name, NameId nameId, Handle parent);
+    bool dropEvent(EventType type, Handle handle, NameId nameId, std::string_view name);
+    void push(EventType type, Handle handle, Handle parent, NameId nameId, std::string_view name,
+              int32_t intValue, double doubleValue, std::string_view stringValue);
+
+    int32_t dispatch(const Event &event);
+    int32_t perform(const Event &event);
+    int32_t dispatchEnterAction(const Event &event, std::string_view name);
+    int32_t dispatchLeaveAction(Handle handle);
+    int32_t missingActionStatus(Handle handle) const;
+
+    Backend &backend_;
+    HandleTable<Backend::Action> actions_;
+    NameTable names_;
+    EventBuffer<Event> events_;
+    std::atomic_flag drainScheduled_ = ATOMIC_FLAG_INIT;
+    std::function<void()> drainHandler_;
+    std::atomic<Sampler *> sampler_{nullptr};
+    std::vector<std::unique_ptr<Sampler>> samplers_;
+    std::mutex samplersMutex_;
+    // Open actions with their parent, so leaving an action leaves its children first. Consumer only.
+    std::vector<std::pair<Handle, Handle>> openActions_;
+    StatusCounts statusCounts_;
+};
+
+} // namespace oddynatrace
@@ -0,0 +1,50 @@
+//
+//  Event.h
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "oddynatrace/HandleTable.h"
+#include "oddynatrace/NameTable.h"
+
+namespace oddynatrace {
+
+// Same values as ODDynatraceEventType and the type constants of ODDynatraceEvent.java
+enum class EventType : uint8_t {
+    EnterAction,
+    LeaveAction,
+    ReportEvent,
+    ReportIntValue,
+    ReportDoubleValue,
+    ReportStringValue,
+    ReportError,
+};
+
+constexpr int EventTypeCount = static_cast<int>(EventType::ReportError) + 1;
+
+// Type of the batch records, e.g. "enter" or "intValue"
+const char *eventTypeName(EventType type);
+
+// One instrumentation call. The name is either an interned name id or a copied string.
+// The strings of the buffer slots keep their capacity from one event to the next,
+// so once they have grown to the usual name lengths queuing an event does not allocate.
+struct Event {
+    EventType type = EventType::EnterAction;
+    Handle handle = InvalidHandle;
+    // Only used by enter events, InvalidHandle for root actions
+    Handle parent = InvalidHandle;
+    NameId nameId = InvalidNameId;
+    int32_t intValue = 0;
+    double doubleValue = 0;
+    std::string name;
+    std::string stringValue;
+};
+
+} // namespace oddynatrace
@@ -0,0 +1,151 @@
+//
+//  EventBuffer.h
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace oddynatrace {
+
+enum class OverflowPolicy {
+    DropNewest,
+    DropOldest,
+};
+
+// Bounded lock-free queue, same algorithm as ODDynatraceEventBuffer.m and .java. Any thread can push,
+// values are popped by a single consumer. When full, the overflow policy drops either the pushed value
+// or the oldest queued one. Values are written and read in place in preallocated slots, so they can
+// keep their own storage from one lap to the next.
+template <typename T>
+class EventBuffer {
+public:
+    // The capacity is rounded up to a power of two
+    explicit EventBuffer(size_t capacity = 1024, OverflowPolicy overflowPolicy = OverflowPolicy::DropNewest)
+        : overflowPolicy_(overflowPolicy)
+    {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        slots_.reset(new Slot[size]);
+        for (size_t i = 0; i < size; i++) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    EventBuffer(const EventBuffer &) = delete;
+    EventBuffer &operator=(const EventBuffer &) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+    OverflowPolicy overflowPolicy() const { return overflowPolicy_; }
+    uint64_t droppedCount() const { return droppedCount_.load(std::memory_order_relaxed); }
+
+    size_t count() const
+    {
+        size_t enqueuePosition = enqueuePosition_.load(std::memory_order_relaxed);
+        size_t dequeuePosition = dequeuePosition_.load(std::memory_order_relaxed);
+        return enqueuePosition > dequeuePosition ? enqueuePosition - dequeuePosition : 0;
+    }
+
+    // Called on the pushing thread with each oldest value dropped to make room. Must be set before the first push.
+    void setDropHandler(std::function<void(const T &)> dropHandler) { dropHandler_ = std::move(dropHandler); }
+
+    // Fills a claimed slot with write(T &). Returns false when the value was dropped, write is then not called.
+    template <typename Write>
+    bool push(Write &&write)
+    {
+        for (;;) {
+            if (tryPush(write)) {
+                return true;
+            }
+            if (overflowPolicy_ == OverflowPolicy::DropNewest) {
+                droppedCount_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            pop([this](T &oldest) {
+                droppedCount_.fetch_add(1, std::memory_order_relaxed);
+                if (dropHandler_) {
+                    dropHandler_(oldest);
+                }
+            });
+        }
+    }
+
+    // Hands the oldest value to read(T &) in its slot. Dropping the oldest value makes producers
+    // dequeue too, hence the CAS on the dequeue position.
+    template <typename Read>
+    bool pop(Read &&read)
+    {
+        size_t position = dequeuePosition_.load(std::memory_order_relaxed);
+        Slot *slot;
+        for (;;) {
+            slot = &slots_[position & mask_];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (difference == 0) {
+                if (dequeuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = dequeuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+        read(slot->value);
+        slot->sequence.store(position + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // Every slot carries a sequence number telling producers and consumers whose turn it is,
+    // so claiming a slot is a single CAS
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    template <typename Write>
+    bool tryPush(Write &write)
+    {
+        size_t position = enqueuePosition_.load(std::memory_order_relaxed);
+        Slot *slot;
+        for (;;) {
+            slot = &slots_[position & mask_];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+        write(slot->value);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    OverflowPolicy overflowPolicy_;
+    size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<size_t> enqueuePosition_{0};
+    alignas(64) std::atomic<size_t> dequeuePosition_{0};
+    std::atomic<uint64_t> droppedCount_{0};
+    std::function<void(const T &)> dropHandler_;
+};
+
+} // namespace oddynatrace
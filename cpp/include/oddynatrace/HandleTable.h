@@ -0,0 +1,189 @@
+//
+//  HandleTable.h
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace oddynatrace {
+
+// Small integer standing for a native object on the JS side.
+// The low 16 bits are the slot index, the next 15 bits the slot generation.
+using Handle = int32_t;
+
+constexpr Handle InvalidHandle = 0;
+
+// Slot map giving O(1) handle lookups, same layout as ODDynatraceHandleTable.m and .java. Removing an object
+// bumps the slot generation, so a handle kept after its object was removed is detected as stale instead of
+// resolving to the next object stored in the same slot. Safe to use from any thread, every call takes the lock.
+template <typename T>
+class HandleTable {
+public:
+    static constexpr size_t MaxCount = 0xFFFF;
+
+    explicit HandleTable(size_t capacity = 64)
+    {
+        capacity = std::max<size_t>(std::min(capacity, MaxCount), 1);
+        slots_.reserve(capacity);
+        freeIndexes_.reserve(capacity);
+    }
+
+    // Returns InvalidHandle when the table is full
+    Handle add(T object)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return insert(State::Set, std::move(object));
+    }
+
+    // Hands out a handle before its object exists, get returns false until it is set
+    Handle reserve()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return insert(State::Reserved, T());
+    }
+
+    void set(Handle handle, T object)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (Slot *slot = liveSlot(handle)) {
+            slot->object = std::move(object);
+            slot->state = State::Set;
+        }
+    }
+
+    bool get(Handle handle, T &object) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const Slot *slot = liveSlot(handle);
+        if (!slot || slot->state != State::Set) {
+            return false;
+        }
+        object = slot->object;
+        return true;
+    }
+
+    // True for reserved handles too
+    bool contains(Handle handle) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return liveSlot(handle) != nullptr;
+    }
+
+    // True when the handle was handed out by the table and its object removed since
+    bool isStale(Handle handle) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return index(handle) < slots_.size() && generation(handle) != 0 && !liveSlot(handle);
+    }
+
+    // Frees reserved handles too, returns false when nothing was set for the handle
+    bool remove(Handle handle, T &object)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot *slot = liveSlot(handle);
+        if (!slot) {
+            return false;
+        }
+        bool set = slot->state == State::Set;
+        if (set) {
+            object = std::move(slot->object);
+        }
+        free(index(handle));
+        return set;
+    }
+
+    bool remove(Handle handle)
+    {
+        T object;
+        return remove(handle, object);
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < slots_.size(); i++) {
+            if (slots_[i].state != State::Free) {
+                free(i);
+            }
+        }
+    }
+
+    size_t count() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return slots_.size() - freeIndexes_.size();
+    }
+
+private:
+    enum class State : uint8_t { Free, Reserved, Set };
+
+    struct Slot {
+        T object;
+        uint16_t generation;
+        State state;
+    };
+
+    static constexpr uint16_t MaxGeneration = 0x7FFF;
+
+    static size_t index(Handle handle) { return static_cast<uint32_t>(handle) & 0xFFFF; }
+    static uint16_t generation(Handle handle) { return (static_cast<uint32_t>(handle) >> 16) & MaxGeneration; }
+
+    static Handle makeHandle(size_t index, uint16_t generation)
+    {
+        return static_cast<Handle>((static_cast<uint32_t>(generation) << 16) | static_cast<uint32_t>(index));
+    }
+
+    Handle insert(State state, T object)
+    {
+        size_t i;
+        if (!freeIndexes_.empty()) {
+            i = freeIndexes_.back();
+            freeIndexes_.pop_back();
+        } else {
+            i = slots_.size();
+            if (i >= MaxCount) {
+                return InvalidHandle;
+            }
+            slots_.push_back(Slot{T(), 1, State::Free});
+        }
+        slots_[i].object = std::move(object);
+        slots_[i].state = state;
+        return makeHandle(i, slots_[i].generation);
+    }
+
+    Slot *liveSlot(Handle handle)
+    {
+        size_t i = index(handle);
+        if (i >= slots_.size() || slots_[i].generation != generation(handle) || slots_[i].state == State::Free) {
+            return nullptr;
+        }
+        return &slots_[i];
+    }
+
+    const Slot *liveSlot(Handle handle) const
+    {
+        return const_cast<HandleTable *>(this)->liveSlot(handle);
+    }
+
+    void free(size_t i)
+    {
+        slots_[i].object = T();
+        slots_[i].state = State::Free;
+        slots_[i].generation = slots_[i].generation == MaxGeneration ? 1 : slots_[i].generation + 1;
+        freeIndexes_.push_back(static_cast<uint16_t>(i));
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<Slot> slots_;
+    std::vector<uint16_t> freeIndexes_;
+};
+
+} // namespace oddynatrace
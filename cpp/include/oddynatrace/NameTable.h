@@ -0,0 +1,49 @@
+//
+//  NameTable.h
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace oddynatrace {
+
+using NameId = uint32_t;
+
+constexpr NameId InvalidNameId = 0;
+
+// Interned action, event and value names. Registering a name is locked and done once,
+// looking a name up by id afterwards is lock-free and allocation-free, from any thread.
+class NameTable {
+public:
+    explicit NameTable(size_t capacity = 4096);
+
+    size_t count() const { return count_.load(std::memory_order_acquire); }
+
+    // Returns the existing id of an already registered name, InvalidNameId when the table is full
+    NameId registerName(std::string_view name);
+
+    // Empty for unknown ids. The view stays valid as long as the table.
+    std::string_view name(NameId nameId) const;
+
+private:
+    size_t capacity_;
+    // Names are never removed and the storage never moves, so a reader only needs
+    // to see the count published after the name it looks up
+    std::unique_ptr<std::string[]> names_;
+    std::atomic<uint32_t> count_{0};
+    std::unordered_map<std::string_view, NameId> ids_;
+    std::mutex mutex_;
+};
+
+} // namespace oddynatrace
@@ -0,0 +1,51 @@
+//
+//  PackedQueue.h
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "oddynatrace/EventBuffer.h"
+
+namespace oddynatrace {
+
+// Record of a packed batch of the Android module : the event type, the action handle, the name id and the value
+struct PackedRecord {
+    int32_t type;
+    int32_t handle;
+    int32_t nameId;
+    double value;
+};
+
+// Queue of the packed batches, sent by JS as flat arrays of PackedQueue::Fields numbers per record. The thread
+// receiving the batches queues their records, the module thread drains them one batch at a time, so they are
+// dispatched in order with the other batches. A single thread queues batches, which are queued whole or not at all.
+class PackedQueue {
+public:
+    static constexpr size_t Fields = 4;
+    // Drained records, in native byte order : i32 type, i32 handle, i32 name id, 4 bytes of padding, f64 value
+    static constexpr size_t RecordLength = 24;
+
+    // The capacity is rounded up to a power of two
+    explicit PackedQueue(size_t capacity = 4096) : records_(capacity) {}
+
+    size_t capacity() const { return records_.capacity(); }
+    size_t count() const { return records_.count(); }
+
+    // Queues the records of count numbers. Returns false without queuing anything when they do not all fit.
+    bool push(const double *packed, size_t count);
+
+    // Writes up to maxCount of the oldest records into the buffer, returns how many
+    size_t drain(uint8_t *buffer, size_t length, size_t maxCount);
+
+private:
+    EventBuffer<PackedRecord> records_;
+};
+
+} // namespace oddynatrace
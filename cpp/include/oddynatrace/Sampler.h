@@ -0,0 +1,65 @@
+//
+//  Sampler.h
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace oddynatrace {
+
+// Startup options of the sampler, see README "Sampling"
+struct SamplerOptions {
+    // Share of the sessions reported at all, between 0 and 1
+    double sampleRate = 1;
+    // Share of the sessions reporting a given name, per name
+    std::unordered_map<std::string, double> sampleRates;
+    // Events per second allowed overall, 0 for no limit, and how many can go at once
+    double rateLimit = 0;
+    double rateLimitBurst = 1;
+    // Picks the sampled sessions and names, random by default
+    uint64_t seed = 0;
+};
+
+// Decides which actions and events reach the ADK, same decisions as ODDynatraceSampler.m and .java.
+// A name is either always or never sampled during a session. Safe to call from any thread without locking.
+class Sampler {
+public:
+    explicit Sampler(const SamplerOptions &options = SamplerOptions());
+
+    // True when the action or event of this name has to be dropped
+    bool drop(std::string_view name);
+    // With the time in ns of a monotonic clock, for tests
+    bool drop(std::string_view name, uint64_t now);
+
+    // Events dropped by the sample rates and by the rate limit
+    uint64_t sampledCount() const { return sampledCount_.load(std::memory_order_relaxed); }
+    uint64_t rateLimitedCount() const { return rateLimitedCount_.load(std::memory_order_relaxed); }
+
+    // Same session draw as ODDynatraceSamplerKeep, exposed for tests
+    static bool keep(uint64_t key, double rate);
+
+private:
+    bool acquireToken(uint64_t now);
+
+    uint64_t seed_;
+    bool sessionSampled_;
+    // Keyed by name hash, looking a name up does not copy it
+    std::unordered_map<uint64_t, double> sampleRates_;
+    // Token bucket kept as the time the next event is allowed, in ns (GCRA)
+    uint64_t interval_ = 0;
+    uint64_t burstTolerance_ = 0;
+    std::atomic<uint64_t> allowedAt_{0};
+    std::atomic<uint64_t> sampledCount_{0};
+    std::atomic<uint64_t> rateLimitedCount_{0};
+};
+
+} // namespace oddynatrace
@@ -0,0 +1,63 @@
+//
+//  Status.h
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace oddynatrace {
+
+// Same values as CPWR_StatusCode of DynatraceUEM.h and the constants of DynatraceUEM.java
+enum StatusCode : int32_t {
+    UemOff = 1,
+    UemOn = 2,
+    CrashReportingUnavailable = 4,
+    CrashReportingAvailable = 5,
+    ErrorNotInitialized = -1,
+    ErrorInvalidRange = -2,
+    ErrorInternalError = -3,
+    ErrorActionNotFound = -4,
+    ErrorInvalidParameter = -5,
+    ErrorActionEnded = -6,
+    ReportErrorOff = -8,
+    TruncatedEventName = -9,
+    CrashReportInvalid = -10,
+};
+
+// Constant name of a status code, e.g. "CPWR_UemOn", nullptr for unknown codes.
+// Same names as ODDynatraceStatus.m and ODDynatraceStatus.java.
+const char *statusName(int32_t statusCode);
+
+// Human readable meaning of a status code, used in the module logs
+const char *statusDescription(int32_t statusCode);
+
+// Number of results per status code. Not thread safe, only used by the consumer of the events.
+class StatusCounts {
+public:
+    static constexpr int32_t Min = CrashReportInvalid;
+    static constexpr int32_t Max = CrashReportingAvailable;
+
+    // Codes out of the range are ignored
+    void count(int32_t statusCode)
+    {
+        if (statusCode != 0 && statusCode >= Min && statusCode <= Max) {
+            counts_[statusCode - Min]++;
+        }
+    }
+
+    uint64_t operator[](int32_t statusCode) const
+    {
+        return statusCode >= Min && statusCode <= Max ? counts_[statusCode - Min] : 0;
+    }
+
+private:
+    uint64_t counts_[Max - Min + 1] = {};
+};
+
+} // namespace oddynatrace
@@ -0,0 +1,78 @@
+//
+//  ODDynatracePackedQueue.cpp
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+// Natives of ODDynatracePackedQueue.java, the queue is owned by the Java object through its address
+
+#include <jni.h>
+
+#include <new>
+
+#include "oddynatrace/PackedQueue.h"
+
+using oddynatrace::PackedQueue;
+
+namespace {
+
+PackedQueue *queue(jlong address)
+{
+    return reinterpret_cast<PackedQueue *>(static_cast<uintptr_t>(address));
+}
+
+} // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL
+Java_com_odemolliens_rn_dynatrace_ODDynatracePackedQueue_nativeCreate(JNIEnv *, jclass, jint capacity)
+{
+    PackedQueue *packedQueue = new (std::nothrow) PackedQueue(capacity > 0 ? static_cast<size_t>(capacity) : 1);
+    return static_cast<jlong>(reinterpret_cast<uintptr_t>(packedQueue));
+}
+
+JNIEXPORT jint JNICALL
+Java_com_odemolliens_rn_dynatrace_ODDynatracePackedQueue_nativeCapacity(JNIEnv *, jclass, jlong address)
+{
+    return address != 0 ? static_cast<jint>(queue(address)->capacity()) : 0;
+}
+
+// The numbers are read in place, the critical section only lasts the copy into the queue
+JNIEXPORT jboolean JNICALL
+Java_com_odemolliens_rn_dynatrace_ODDynatracePackedQueue_nativePush(JNIEnv *env, jclass, jlong address,
+                                                                    jdoubleArray packed, jint count)
+{
+    if (address == 0 || count < 0 || count > env->GetArrayLength(packed)) {
+        return JNI_FALSE;
+    }
+    auto *numbers = static_cast<jdouble *>(env->GetPrimitiveArrayCritical(packed, nullptr));
+    if (!numbers) {
+        return JNI_FALSE;
+    }
+    bool pushed = queue(address)->push(numbers, static_cast<size_t>(count));
+    env->ReleasePrimitiveArrayCritical(packed, numbers, JNI_ABORT);
+    return pushed ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_odemolliens_rn_dynatrace_ODDynatracePackedQueue_nativeDrain(JNIEnv *env, jclass, jlong address,
+                                                                     jobject records, jint maxCount)
+{
+    auto *buffer = static_cast<uint8_t *>(env->GetDirectBufferAddress(records));
+    jlong length = env->GetDirectBufferCapacity(records);
+    if (address == 0 || !buffer || length <= 0 || maxCount <= 0) {
+        return 0;
+    }
+    return static_cast<jint>(queue(address)->drain(buffer, static_cast<size_t>(length), static_cast<size_t>(maxCount)));
+}
+
+JNIEXPORT void JNICALL
+Java_com_odemolliens_rn_dynatrace_ODDynatracePackedQueue_nativeDestroy(JNIEnv *, jclass, jlong address)
+{
+    delete queue(address);
+}
+
+} // extern "C"
@@ -0,0 +1,172 @@
+//
+//  MockBackend.cpp
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#include "MockBackend.h"
+
+#include <cstdio>
+
+#include "oddynatrace/Status.h"
+
+namespace oddynatrace {
+
+int32_t MockBackend::startup(std::string_view applicationName, std::string_view serverURL)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (applicationName.empty() || serverURL.empty()) {
+        return ErrorInvalidParameter;
+    }
+    started_ = true;
+    return log(false, [] { return std::string("startup"); });
+}
+
+int32_t MockBackend::shutdown()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    started_ = false;
+    actions_.clear();
+    freeActions_.clear();
+    return log(false, [] { return std::string("shutdown"); });
+}
+
+int32_t MockBackend::flush()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return started_ ? log(false, [] { return std::string("flush"); }) : ErrorNotInitialized;
+}
+
+Backend::Action MockBackend::enterAction(std::string_view name, Action parent)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!started_ || name.empty()) {
+        return NoAction;
+    }
+    const MockAction *parentAction = nullptr;
+    if (parent != NoAction && !(parentAction = action(parent))) {
+        return NoAction;
+    }
+    log(true, [&] {
+        return "enter " + std::string(name) + (parentAction ? " parent " + parentAction->name : std::string());
+    });
+    size_t index;
+    if (!freeActions_.empty()) {
+        index = freeActions_.back();
+        freeActions_.pop_back();
+    } else {
+        index = actions_.size();
+        actions_.emplace_back();
+    }
+    actions_[index].name.assign(name);
+    actions_[index].open = true;
+    return index + 1;
+}
+
+int32_t MockBackend::leaveAction(Action action)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!started_) {
+        return ErrorNotInitialized;
+    }
+    if (action == NoAction || action > actions_.size()) {
+        return ErrorActionNotFound;
+    }
+    MockAction &mockAction = actions_[action - 1];
+    if (!mockAction.open) {
+        return ErrorActionEnded;
+    }
+    int32_t statusCode = log(true, [&] { return "leave " + mockAction.name; });
+    mockAction.open = false;
+    freeActions_.push_back(action - 1);
+    return statusCode;
+}
+
+int32_t MockBackend::reportEvent(Action action, std::string_view name)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!started_) {
+        return ErrorNotInitialized;
+    }
+    return this->action(action) ? log(true, [&] { return "event " + std::string(name); }) : ErrorActionNotFound;
+}
+
+int32_t MockBackend::reportValue(Action action, std::string_view name, int32_t value)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!started_) {
+        return ErrorNotInitialized;
+    }
+    return this->action(action)
+        ? log(true, [&] { return "value " + std::string(name) + " " + std::to_string(value); })
+        : ErrorActionNotFound;
+}
+
+int32_t MockBackend::reportValue(Action action, std::string_view name, double value)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!started_) {
+        return ErrorNotInitialized;
+    }
+    return this->action(action) ? log(true, [&] {
+        char formatted[32];
+        snprintf(formatted, sizeof(formatted), "%g", value);
+        return "value " + std::string(name) + " " + formatted;
+    }) : ErrorActionNotFound;
+}
+
+int32_t MockBackend::reportValue(Action action, std::string_view name, std::string_view value)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!started_) {
+        return ErrorNotInitialized;
+    }
+    return this->action(action)
+        ? log(true, [&] { return "value " + std::string(name) + " " + std::string(value); })
+        : ErrorActionNotFound;
+}
+
+int32_t MockBackend::reportError(Action action, std::string_view name, int32_t errorValue)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!started_) {
+        return ErrorNotInitialized;
+    }
+    return this->action(action)
+        ? log(true, [&] { return "error " + std::string(name) + " " + std::to_string(errorValue); })
+        : ErrorActionNotFound;
+}
+
+std::vector<std::string> MockBackend::calls() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return calls_;
+}
+
+std::set<std::thread::id> MockBackend::actionThreads() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return actionThreads_;
+}
+
+size_t MockBackend::openActionCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const MockAction &mockAction : actions_) {
+        count += mockAction.open;
+    }
+    return count;
+}
+
+const MockBackend::MockAction *MockBackend::action(Action action) const
+{
+    if (action == NoAction || action > actions_.size() || !actions_[action - 1].open) {
+        return nullptr;
+    }
+    return &actions_[action - 1];
+}
+
+} // namespace oddynatrace
@@ -0,0 +1,83 @@
+//
+//  MockBackend.h
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "oddynatrace/Backend.h"
+#include "oddynatrace/Status.h"
+
+namespace oddynatrace {
+
+// DynatraceUEM stand-in for the tests and benchmarks. Returns the ADK status codes, CPWR_Error_NotInitialized
+// until startup, and logs the calls it receives in the same format as ODDynatraceFakeADK.m :
+// "enter <name>", "enter <name> parent <parent name>", "event <name>", "value <name> <value>",
+// "error <name> <value>", "leave <name>", "startup", "flush", "shutdown".
+class MockBackend : public Backend {
+public:
+    // Without logging, the calls are only counted
+    explicit MockBackend(bool logging = true) : logging_(logging) {}
+
+    int32_t startup(std::string_view applicationName, std::string_view serverURL) override;
+    int32_t shutdown() override;
+    int32_t flush() override;
+    Action enterAction(std::string_view name, Action parent) override;
+    int32_t leaveAction(Action action) override;
+    int32_t reportEvent(Action action, std::string_view name) override;
+    int32_t reportValue(Action action, std::string_view name, int32_t value) override;
+    int32_t reportValue(Action action, std::string_view name, double value) override;
+    int32_t reportValue(Action action, std::string_view name, std::string_view value) override;
+    int32_t reportError(Action action, std::string_view name, int32_t errorValue) override;
+
+    std::vector<std::string> calls() const;
+    uint64_t callCount() const { return callCount_.load(std::memory_order_relaxed); }
+    // Threads the action calls were made from
+    std::set<std::thread::id> actionThreads() const;
+    // Actions entered and not left
+    size_t openActionCount() const;
+
+private:
+    struct MockAction {
+        std::string name;
+        bool open;
+    };
+
+    // Called with the lock held, the call is only formatted when logging
+    template <typename Format>
+    int32_t log(bool actionCall, Format &&format)
+    {
+        callCount_.fetch_add(1, std::memory_order_relaxed);
+        if (logging_) {
+            calls_.push_back(format());
+            if (actionCall) {
+                actionThreads_.insert(std::this_thread::get_id());
+            }
+        }
+        return UemOn;
+    }
+
+    const MockAction *action(Action action) const;
+
+    bool logging_;
+    bool started_ = false;
+    mutable std::mutex mutex_;
+    std::vector<std::string> calls_;
+    std::set<std::thread::id> actionThreads_;
+    // Action n is actions_[n - 1], so Backend::NoAction is never handed out. Left actions are reused.
+    std::vector<MockAction> actions_;
+    std::vector<size_t> freeActions_;
+    std::atomic<uint64_t> callCount_{0};
+};
+
+} // namespace oddynatrace
@@ -0,0 +1,286 @@
+//
+//  Core.cpp
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#include "oddynatrace/Core.h"
+
+#include <algorithm>
+
+namespace oddynatrace {
+
+Core::Core(Backend &backend, const CoreOptions &options)
+    : backend_(backend),
+      actions_(options.actionCapacity),
+      names_(options.nameCapacity),
+      events_(options.eventBufferCapacity, options.overflowPolicy)
+{
+    // A dropped enter never reaches the backend, give its reserved handle back
+    events_.setDropHandler([this](const Event &event) {
+        if (event.type == EventType::EnterAction) {
+            actions_.remove(event.handle);
+        }
+    });
+}
+
+void Core::setSampler(std::unique_ptr<Sampler> sampler)
+{
+    std::lock_guard<std::mutex> lock(samplersMutex_);
+    sampler_.store(sampler.get(), std::memory_order_release);
+    if (sampler) {
+        samplers_.push_back(std::move(sampler));
+    }
+}
+
+// Producers
+
+Handle Core::enterAction(std::string_view name, Handle parent)
+{
+    return enter(name, InvalidNameId, parent);
+}
+
+Handle Core::enterAction(NameId nameId, Handle parent)
+{
+    return enter(std::string_view(), nameId, parent);
+}
+
+Handle Core::enter(std::string_view name, NameId nameId, Handle parent)
+{
+    if (parent != InvalidHandle && !actions_.contains(parent)) {
+        return missingActionStatus(parent);
+    }
+    Sampler *sampler = sampler_.load(std::memory_order_acquire);
+    if (sampler && sampler->drop(nameId != InvalidNameId ? names_.name(nameId) : name)) {
+        return InvalidHandle;
+    }
+    Handle handle = actions_.reserve();
+    if (handle != InvalidHandle) {
+        push(EventType::EnterAction, handle, parent, nameId, name, 0, 0, std::string_view());
+    }
+    return handle;
+}
+
+void Core::leaveAction(Handle action)
+{
+    push(EventType::LeaveAction, action, InvalidHandle, InvalidNameId, std::string_view(), 0, 0, std::string_view());
+}
+
+void Core::reportEvent(std::string_view name, Handle action)
+{
+    push(EventType::ReportEvent, action, InvalidHandle, InvalidNameId, name, 0, 0, std::string_view());
+}
+
+void Core::reportEvent(NameId nameId, Handle action)
+{
+    push(EventType::ReportEvent, action, InvalidHandle, nameId, std::string_view(), 0, 0, std::string_view());
+}
+
+void Core::reportValue(std::string_view name, int32_t value, Handle action)
+{
+    push(EventType::ReportIntValue, action, InvalidHandle, InvalidNameId, name, value, 0, std::string_view());
+}
+
+void Core::reportValue(NameId nameId, int32_t value, Handle action)
+{
+    push(EventType::ReportIntValue, action, InvalidHandle, nameId, std::string_view(), value, 0, std::string_view());
+}
+
+void Core::reportValue(std::string_view name, double value, Handle action)
+{
+    push(EventType::ReportDoubleValue, action, InvalidHandle, InvalidNameId, name, 0, value, std::string_view());
+}
+
+void Core::reportValue(NameId nameId, double value, Handle action)
+{
+    push(EventType::ReportDoubleValue, action, InvalidHandle, nameId, std::string_view(), 0, value, std::string_view());
+}
+
+void Core::reportValue(std::string_view name, std::string_view value, Handle action)
+{
+    push(EventType::ReportStringValue, action, InvalidHandle, InvalidNameId, name, 0, 0, value);
+}
+
+void Core::reportError(std::string_view name, int32_t errorValue, Handle action)
+{
+    push(EventType::ReportError, action, InvalidHandle, InvalidNameId, name, errorValue, 0, std::string_view());
+}
+
+void Core::reportError(NameId nameId, int32_t errorValue, Handle action)
+{
+    push(EventType::ReportError, action, InvalidHandle, nameId, std::string_view(), errorValue, 0, std::string_view());
+}
+
+// Events of actions sampled out at enter are dropped with them, without being counted again
+bool Core::dropEvent(EventType type, Handle handle, NameId nameId, std::string_view name)
+{
+    if (handle == InvalidHandle) {
+        return true;
+    }
+    if (type == EventType::LeaveAction) {
+        return false;
+    }
+    Sampler *sampler = sampler_.load(std::memory_order_acquire);
+    return sampler && sampler->drop(nameId != InvalidNameId ? names_.name(nameId) : name);
+}
+
+void Core::push(EventType type, Handle handle, Handle parent, NameId nameId, std::string_view name,
+                int32_t intValue, double doubleValue, std::string_view stringValue)
+{
+    if (type != EventType::EnterAction && dropEvent(type, handle, nameId, name)) {
+        return;
+    }
+    bool pushed = events_.push([&](Event &event) {
+        event.type = type;
+        event.handle = handle;
+        event.parent = parent;
+        event.nameId = nameId;
+        event.intValue = intValue;
+        event.doubleValue = doubleValue;
+        event.name.assign(name);
+        event.stringValue.assign(stringValue);
+    });
+    if (!pushed) {
+        if (type == EventType::EnterAction) {
+            actions_.remove(handle);
+        }
+        return;
+    }
+    if (!drainScheduled_.test_and_set(std::memory_order_acq_rel) && drainHandler_) {
+        drainHandler_();
+    }
+}
+
+// Consumer
+
+int32_t Core::startup(std::string_view applicationName, std::string_view serverURL)
+{
+    int32_t statusCode = backend_.startup(applicationName, serverURL);
+    statusCounts_.count(statusCode);
+    return statusCode;
+}
+
+size_t Core::drain()
+{
+    // Cleared first, an event queued after the last pop schedules the next drain
+    drainScheduled_.clear(std::memory_order_release);
+    size_t count = 0;
+    while (events_.pop([this](Event &event) { dispatch(event); })) {
+        count++;
+    }
+    return count;
+}
+
+int32_t Core::flush()
+{
+    drain();
+    int32_t statusCode = backend_.flush();
+    statusCounts_.count(statusCode);
+    return statusCode;
+}
+
+int32_t Core::shutdown()
+{
+    drain();
+    actions_.clear();
+    openActions_.clear();
+    return backend_.shutdown();
+}
+
+int32_t Core::dispatch(const Event &event)
+{
+    int32_t result = perform(event);
+    // Entered actions are counted as UemOn
+    statusCounts_.count(event.type == EventType::EnterAction && result > 0 ? UemOn : result);
+    return result;
+}
+
+// Returns the handle for enter events, the backend status code otherwise
+int32_t Core::perform(const Event &event)
+{
+    std::string_view name = event.nameId != InvalidNameId ? names_.name(event.nameId) : std::string_view(event.name);
+    if (event.type == EventType::EnterAction) {
+        return dispatchEnterAction(event, name);
+    }
+    if (event.type == EventType::LeaveAction) {
+        return dispatchLeaveAction(event.handle);
+    }
+
+    Backend::Action action;
+    if (!actions_.get(event.handle, action)) {
+        return missingActionStatus(event.handle);
+    }
+    if (name.empty()) {
+        return ErrorInvalidParameter;
+    }
+    switch (event.type) {
+        case EventType::ReportEvent:
+            return backend_.reportEvent(action, name);
+        case EventType::ReportIntValue:
+            return backend_.reportValue(action, name, event.intValue);
+        case EventType::ReportDoubleValue:
+            return backend_.reportValue(action, name, event.doubleValue);
+        case EventType::ReportStringValue:
+            return backend_.reportValue(action, name, std::string_view(event.stringValue));
+        case EventType::ReportError:
+            return backend_.reportError(action, name, event.intValue);
+        default:
+            return ErrorInvalidParameter;
+    }
+}
+
+int32_t Core::dispatchEnterAction(const Event &event, std::string_view name)
+{
+    if (event.handle == InvalidHandle) {
+        return InvalidHandle;
+    }
+    Backend::Action parent = Backend::NoAction;
+    if (event.parent != InvalidHandle && !actions_.get(event.parent, parent)) {
+        actions_.remove(event.handle);
+        return missingActionStatus(event.parent);
+    }
+    if (name.empty()) {
+        actions_.remove(event.handle);
+        return ErrorInvalidParameter;
+    }
+    Backend::Action action = backend_.enterAction(name, parent);
+    if (action == Backend::NoAction) {
+        actions_.remove(event.handle);
+        return InvalidHandle;
+    }
+    actions_.set(event.handle, action);
+    openActions_.emplace_back(event.handle, event.parent);
+    return event.handle;
+}
+
+// Children are left before their parent, deepest first, so none of them stays open in the table
+int32_t Core::dispatchLeaveAction(Handle handle)
+{
+    for (;;) {
+        auto child = std::find_if(openActions_.begin(), openActions_.end(), [handle](const std::pair<Handle, Handle> &open) {
+            return open.second == handle;
+        });
+        if (child == openActions_.end()) {
+            break;
+        }
+        dispatchLeaveAction(child->first);
+    }
+    auto open = std::find_if(openActions_.begin(), openActions_.end(), [handle](const std::pair<Handle, Handle> &open) {
+        return open.first == handle;
+    });
+    if (open != openActions_.end()) {
+        *open = openActions_.back();
+        openActions_.pop_back();
+    }
+    Backend::Action action;
+    return actions_.remove(handle, action) ? backend_.leaveAction(action) : missingActionStatus(handle);
+}
+
+int32_t Core::missingActionStatus(Handle handle) const
+{
+    return actions_.isStale(handle) ? ErrorActionEnded : ErrorActionNotFound;
+}
+
+} // namespace oddynatrace
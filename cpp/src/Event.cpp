@@ -0,0 +1,22 @@
+//
+//  Event.cpp
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#include "oddynatrace/Event.h"
+
+namespace oddynatrace {
+
+const char *eventTypeName(EventType type)
+{
+    static const char *const names[EventTypeCount] = {
+        "enter", "leave", "event", "intValue", "doubleValue", "stringValue", "error",
+    };
+    int index = static_cast<int>(type);
+    return index < EventTypeCount ? names[index] : nullptr;
+}
+
+} // namespace oddynatrace
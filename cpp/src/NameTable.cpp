@@ -0,0 +1,45 @@
+//
+//  NameTable.cpp
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#include "oddynatrace/NameTable.h"
+
+namespace oddynatrace {
+
+NameTable::NameTable(size_t capacity)
+    : capacity_(capacity), names_(new std::string[capacity])
+{
+    ids_.reserve(capacity);
+}
+
+NameId NameTable::registerName(std::string_view name)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = ids_.find(name);
+    if (found != ids_.end()) {
+        return found->second;
+    }
+    uint32_t count = count_.load(std::memory_order_relaxed);
+    if (count >= capacity_) {
+        return InvalidNameId;
+    }
+    names_[count].assign(name.data(), name.size());
+    NameId nameId = count + 1;
+    ids_.emplace(names_[count], nameId);
+    count_.store(count + 1, std::memory_order_release);
+    return nameId;
+}
+
+std::string_view NameTable::name(NameId nameId) const
+{
+    if (nameId == InvalidNameId || nameId > count_.load(std::memory_order_acquire)) {
+        return std::string_view();
+    }
+    return names_[nameId - 1];
+}
+
+} // namespace oddynatrace
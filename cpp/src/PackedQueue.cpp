@@ -0,0 +1,71 @@
+//
+//  PackedQueue.cpp
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#include "oddynatrace/PackedQueue.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace oddynatrace {
+
+static_assert(PackedQueue::RecordLength >= 20, "a drained record holds 3 ints and a double");
+
+// Saturates like the (int) casts of Java, NaN gives 0
+static int32_t toInt(double value)
+{
+    if (std::isnan(value)) {
+        return 0;
+    }
+    if (value <= INT32_MIN) {
+        return INT32_MIN;
+    }
+    if (value >= INT32_MAX) {
+        return INT32_MAX;
+    }
+    return static_cast<int32_t>(value);
+}
+
+bool PackedQueue::push(const double *packed, size_t count)
+{
+    size_t recordCount = count / Fields;
+    // Only the consumer runs concurrently, the room left can only grow
+    if (recordCount > records_.capacity() - records_.count()) {
+        return false;
+    }
+    for (size_t i = 0; i < recordCount * Fields; i += Fields) {
+        records_.push([&](PackedRecord &record) {
+            record.type = toInt(packed[i]);
+            record.handle = toInt(packed[i + 1]);
+            record.nameId = toInt(packed[i + 2]);
+            record.value = packed[i + 3];
+        });
+    }
+    return true;
+}
+
+size_t PackedQueue::drain(uint8_t *buffer, size_t length, size_t maxCount)
+{
+    size_t count = 0;
+    while (count < maxCount && (count + 1) * RecordLength <= length) {
+        uint8_t *bytes = buffer + count * RecordLength;
+        bool popped = records_.pop([bytes](PackedRecord &record) {
+            std::memcpy(bytes, &record.type, 4);
+            std::memcpy(bytes + 4, &record.handle, 4);
+            std::memcpy(bytes + 8, &record.nameId, 4);
+            std::memset(bytes + 12, 0, 4);
+            std::memcpy(bytes + 16, &record.value, 8);
+        });
+        if (!popped) {
+            break;
+        }
+        count++;
+    }
+    return count;
+}
+
+} // namespace oddynatrace
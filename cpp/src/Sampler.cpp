@@ -0,0 +1,104 @@
+//
+//  Sampler.cpp
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#include "oddynatrace/Sampler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace oddynatrace {
+
+// splitmix64 finalizer, spreads close keys over the whole range
+static uint64_t mix(uint64_t key)
+{
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return key ^ (key >> 31);
+}
+
+// FNV-1a, the same name hashes the same way on every platform
+static uint64_t hashName(std::string_view name)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (char c : name) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+bool Sampler::keep(uint64_t key, double rate)
+{
+    if (rate >= 1) {
+        return true;
+    }
+    return (mix(key) >> 11) * 0x1.0p-53 < rate;
+}
+
+Sampler::Sampler(const SamplerOptions &options)
+    : seed_(options.seed != 0 ? options.seed : (static_cast<uint64_t>(std::random_device()()) << 32) | std::random_device()()),
+      sessionSampled_(keep(seed_, options.sampleRate))
+{
+    for (const auto &sampleRate : options.sampleRates) {
+        sampleRates_[hashName(sampleRate.first)] = sampleRate.second;
+    }
+    if (options.rateLimit > 0) {
+        double burst = std::max(options.rateLimitBurst, 1.0);
+        interval_ = static_cast<uint64_t>(1e9 / options.rateLimit);
+        burstTolerance_ = static_cast<uint64_t>((burst - 1) * interval_);
+    }
+}
+
+bool Sampler::drop(std::string_view name)
+{
+    if (interval_ == 0) {
+        return drop(name, 0);
+    }
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return drop(name, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()));
+}
+
+bool Sampler::drop(std::string_view name, uint64_t now)
+{
+    if (!sessionSampled_) {
+        sampledCount_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    if (!sampleRates_.empty()) {
+        uint64_t hash = hashName(name);
+        auto sampleRate = sampleRates_.find(hash);
+        if (sampleRate != sampleRates_.end() && !keep(seed_ ^ hash, sampleRate->second)) {
+            sampledCount_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    if (!acquireToken(now)) {
+        rateLimitedCount_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool Sampler::acquireToken(uint64_t now)
+{
+    if (interval_ == 0) {
+        return true;
+    }
+    uint64_t allowedAt = allowedAt_.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t start = std::max(allowedAt, now);
+        if (start - now > burstTolerance_) {
+            return false;
+        }
+        if (allowedAt_.compare_exchange_weak(allowedAt, start + interval_, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+} // namespace oddynatrace
@@ -0,0 +1,46 @@
+//
+//  Status.cpp
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#include "oddynatrace/Status.h"
+
+namespace oddynatrace {
+
+const char *statusName(int32_t statusCode)
+{
+    switch (statusCode) {
+        case UemOff: return "CPWR_UemOff";
+        case UemOn: return "CPWR_UemOn";
+        case CrashReportingUnavailable: return "CPWR_CrashReportingUnavailable";
+        case CrashReportingAvailable: return "CPWR_CrashReportingAvailable";
+        case ErrorNotInitialized: return "CPWR_Error_NotInitialized";
+        case ErrorInvalidRange: return "CPWR_Error_InvalidRange";
+        case ErrorInternalError: return "CPWR_Error_InternalError";
+        case ErrorActionNotFound: return "CPWR_Error_ActionNotFound";
+        case ErrorInvalidParameter: return "CPWR_Error_InvalidParameter";
+        case ErrorActionEnded: return "CPWR_Error_ActionEnded";
+        case ReportErrorOff: return "CPWR_ReportErrorOff";
+        case TruncatedEventName: return "CPWR_TruncatedEventName";
+        case CrashReportInvalid: return "CPWR_CrashReportInvalid";
+    }
+    return nullptr;
+}
+
+const char *statusDescription(int32_t statusCode)
+{
+    switch (statusCode) {
+        case UemOff: return "ADK is not enabled or can't capture data";
+        case UemOn: return "Successful";
+        case ErrorNotInitialized: return "ADK is not initialized";
+        case ErrorInvalidParameter: return "a parameter is null or empty";
+        case ErrorActionNotFound: return "action not found";
+        case ErrorActionEnded: return "action already ended";
+        default: return "Failed";
+    }
+}
+
+} // namespace oddynatrace
@@ -0,0 +1,275 @@
+//
+//  CoreTest.cpp
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MockBackend.h"
+#include "oddynatrace/Core.h"
+
+using namespace oddynatrace;
+
+namespace {
+
+// Drains the core on its own thread whenever a producer schedules a drain, like the module queues do
+class CoreTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        // Large enough for the producers never to drop, whatever the consumer scheduling
+        CoreOptions options;
+        options.eventBufferCapacity = 16384;
+        start(options);
+    }
+
+    void TearDown() override { stop(); }
+
+    void start(const CoreOptions &options)
+    {
+        core_.reset(new Core(backend_, options));
+        core_->setDrainHandler([this] {
+            std::lock_guard<std::mutex> lock(mutex_);
+            drainScheduled_ = true;
+            condition_.notify_one();
+        });
+        ASSERT_EQ(core_->startup("app", "https://example.com"), UemOn);
+        consumer_ = std::thread([this] {
+            consumerId_ = std::this_thread::get_id();
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (;;) {
+                condition_.wait(lock, [this] { return drainScheduled_ || stopped_; });
+                bool stopped = stopped_;
+                drainScheduled_ = false;
+                lock.unlock();
+                core_->drain();
+                lock.lock();
+                if (stopped) {
+                    return;
+                }
+            }
+        });
+    }
+
+    void stop()
+    {
+        if (!consumer_.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+            condition_.notify_one();
+        }
+        consumer_.join();
+    }
+
+    // Last calls of the backend, once every queued event was dispatched
+    std::vector<std::string> calls()
+    {
+        stop();
+        core_->drain();
+        std::vector<std::string> calls = backend_.calls();
+        calls.erase(calls.begin());
+        return calls;
+    }
+
+    MockBackend backend_;
+    std::unique_ptr<Core> core_;
+    std::thread consumer_;
+    std::thread::id consumerId_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool drainScheduled_ = false;
+    bool stopped_ = false;
+};
+
+} // namespace
+
+TEST_F(CoreTest, CallsOfEachThreadReachTheBackendInOrder)
+{
+    const int producerCount = 8;
+    const int actionCount = 200;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producerCount; p++) {
+        producers.emplace_back([this, p] {
+            std::string prefix = "p" + std::to_string(p) + "-";
+            NameId valueName = core_->registerName(prefix + "value");
+            for (int i = 0; i < actionCount; i++) {
+                Handle action = core_->enterAction(prefix + std::to_string(i));
+                ASSERT_GT(action, InvalidHandle);
+                core_->reportValue(valueName, i, action);
+                core_->reportValue(prefix + "double", 0.5, action);
+                core_->reportValue(prefix + "string", std::string_view("s"), action);
+                core_->reportEvent(prefix + "event", action);
+                core_->reportError(prefix + "error", -i, action);
+                core_->leaveAction(action);
+            }
+        });
+    }
+    for (std::thread &producer : producers) {
+        producer.join();
+    }
+
+    std::vector<std::string> calls = this->calls();
+    EXPECT_EQ(calls.size(), static_cast<size_t>(producerCount * actionCount * 7));
+    EXPECT_EQ(core_->droppedCount(), 0u);
+    EXPECT_EQ(backend_.openActionCount(), 0u);
+    EXPECT_EQ(core_->actionCount(), 0u);
+
+    std::vector<std::vector<std::string>> callsOfProducer(producerCount);
+    for (const std::string &call : calls) {
+        size_t p = call.find(" p");
+        ASSERT_NE(p, std::string::npos) << call;
+        callsOfProducer[std::stoi(call.substr(p + 2))].push_back(call);
+    }
+    for (int p = 0; p < producerCount; p++) {
+        std::string prefix = "p" + std::to_string(p) + "-";
+        std::vector<std::string> expected;
+        for (int i = 0; i < actionCount; i++) {
+            expected.push_back("enter " + prefix + std::to_string(i));
+            expected.push_back("value " + prefix + "value " + std::to_string(i));
+            expected.push_back("value " + prefix + "double 0.5");
+            expected.push_back("value " + prefix + "string s");
+            expected.push_back("event " + prefix + "event");
+            expected.push_back("error " + prefix + "error " + std::to_string(-i));
+            expected.push_back("leave " + prefix + std::to_string(i));
+        }
+        EXPECT_EQ(callsOfProducer[p], expected);
+    }
+}
+
+TEST_F(CoreTest, BackendIsOnlyCalledFromTheConsumer)
+{
+    std::thread producer([this] {
+        for (int i = 0; i < 100; i++) {
+            Handle action = core_->enterAction("action");
+            core_->reportEvent("event", action);
+            core_->leaveAction(action);
+        }
+    });
+    producer.join();
+    std::thread::id consumerId = consumerId_;
+    stop();
+    std::set<std::thread::id> threads = backend_.actionThreads();
+    ASSERT_EQ(threads.size(), 1u);
+    EXPECT_EQ(*threads.begin(), consumerId);
+}
+
+TEST_F(CoreTest, LeavingAnActionLeavesItsChildrenFirst)
+{
+    Handle root = core_->enterAction("root");
+    Handle child = core_->enterAction("child", root);
+    Handle grandChild = core_->enterAction("grandChild", child);
+    core_->leaveAction(root);
+    core_->leaveAction(grandChild);
+
+    EXPECT_EQ(calls(), (std::vector<std::string>{
+        "enter root",
+        "enter child parent root",
+        "enter grandChild parent child",
+        "leave grandChild",
+        "leave child",
+        "leave root",
+    }));
+    EXPECT_EQ(backend_.openActionCount(), 0u);
+    EXPECT_EQ(core_->statusCounts()[ErrorActionEnded], 1u);
+}
+
+TEST_F(CoreTest, EndedActionsAreReportedAsEnded)
+{
+    Handle action = core_->enterAction("action");
+    core_->leaveAction(action);
+    calls();
+    EXPECT_EQ(core_->enterAction("child", action), ErrorActionEnded);
+    EXPECT_EQ(core_->enterAction("child", 12345), ErrorActionNotFound);
+
+    core_->reportEvent("event", action);
+    core_->drain();
+    EXPECT_EQ(core_->statusCounts()[ErrorActionEnded], 1u);
+}
+
+TEST_F(CoreTest, NamesAreRegisteredOnce)
+{
+    NameId nameId = core_->registerName("action");
+    EXPECT_EQ(core_->registerName("action"), nameId);
+    Handle action = core_->enterAction(nameId);
+    core_->reportEvent(nameId, action);
+    core_->leaveAction(action);
+    EXPECT_EQ(calls(), (std::vector<std::string>{"enter action", "event action", "leave action"}));
+}
+
+TEST_F(CoreTest, DroppedEntersGiveTheirHandleBack)
+{
+    stop();
+    CoreOptions options;
+    options.eventBufferCapacity = 4;
+    consumer_ = std::thread();
+    core_.reset(new Core(backend_, options));
+    core_->startup("app", "https://example.com");
+
+    // Nothing drains, the buffer fills up
+    for (int i = 0; i < 4; i++) {
+        EXPECT_GT(core_->enterAction("action"), InvalidHandle);
+    }
+    EXPECT_EQ(core_->actionCount(), 4u);
+    core_->enterAction("dropped");
+    EXPECT_EQ(core_->droppedCount(), 1u);
+    EXPECT_EQ(core_->actionCount(), 4u);
+}
+
+TEST_F(CoreTest, DropOldestGivesTheDroppedHandlesBack)
+{
+    stop();
+    CoreOptions options;
+    options.eventBufferCapacity = 4;
+    options.overflowPolicy = OverflowPolicy::DropOldest;
+    consumer_ = std::thread();
+    core_.reset(new Core(backend_, options));
+    core_->startup("app", "https://example.com");
+
+    Handle first = core_->enterAction("first");
+    for (int i = 0; i < 4; i++) {
+        core_->enterAction("action");
+    }
+    EXPECT_EQ(core_->droppedCount(), 1u);
+    EXPECT_EQ(core_->actionCount(), 4u);
+    EXPECT_EQ(core_->enterAction("child", first), ErrorActionEnded);
+}
+
+TEST_F(CoreTest, SampledOutActionsAreNotReported)
+{
+    SamplerOptions options;
+    options.sampleRates["sampled"] = 0;
+    core_->setSampler(std::unique_ptr<Sampler>(new Sampler(options)));
+
+    EXPECT_EQ(core_->enterAction("sampled"), InvalidHandle);
+    Handle action = core_->enterAction("kept");
+    core_->reportEvent("sampled", action);
+    core_->reportEvent("kept", action);
+    // Calls on the action sampled out are dropped with it
+    core_->reportEvent("kept", InvalidHandle);
+    core_->leaveAction(action);
+
+    EXPECT_EQ(calls(), (std::vector<std::string>{"enter kept", "event kept", "leave kept"}));
+    EXPECT_EQ(core_->sampler()->sampledCount(), 2u);
+}
+
+TEST_F(CoreTest, ShutdownForgetsTheOpenActions)
+{
+    Handle action = core_->enterAction("action");
+    stop();
+    EXPECT_EQ(core_->shutdown(), UemOn);
+    EXPECT_EQ(core_->actionCount(), 0u);
+    EXPECT_EQ(core_->enterAction("child", action), ErrorActionEnded);
+    EXPECT_EQ(backend_.calls(), (std::vector<std::string>{"startup", "enter action", "shutdown"}));
+}
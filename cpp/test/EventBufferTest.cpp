@@ -0,0 +1,124 @@
+//
+//  EventBufferTest.cpp
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "oddynatrace/EventBuffer.h"
+
+using namespace oddynatrace;
+
+namespace {
+
+bool push(EventBuffer<int> &buffer, int value)
+{
+    return buffer.push([value](int &slot) { slot = value; });
+}
+
+bool pop(EventBuffer<int> &buffer, int &value)
+{
+    return buffer.pop([&value](int &slot) { value = slot; });
+}
+
+} // namespace
+
+TEST(EventBufferTest, CapacityIsRoundedUpToAPowerOfTwo)
+{
+    EXPECT_EQ(EventBuffer<int>(100).capacity(), 128u);
+    EXPECT_EQ(EventBuffer<int>(128).capacity(), 128u);
+    EXPECT_EQ(EventBuffer<int>(0).capacity(), 2u);
+}
+
+TEST(EventBufferTest, ValuesArePoppedInOrder)
+{
+    EventBuffer<int> buffer(8);
+    int value = 0;
+    EXPECT_FALSE(pop(buffer, value));
+    // Several laps, the slots are reused
+    for (int lap = 0; lap < 3; lap++) {
+        for (int i = 0; i < 8; i++) {
+            EXPECT_TRUE(push(buffer, lap * 8 + i));
+        }
+        EXPECT_EQ(buffer.count(), 8u);
+        for (int i = 0; i < 8; i++) {
+            ASSERT_TRUE(pop(buffer, value));
+            EXPECT_EQ(value, lap * 8 + i);
+        }
+        EXPECT_EQ(buffer.count(), 0u);
+    }
+    EXPECT_EQ(buffer.droppedCount(), 0u);
+}
+
+TEST(EventBufferTest, DropNewestDropsThePushedValue)
+{
+    EventBuffer<int> buffer(4, OverflowPolicy::DropNewest);
+    for (int i = 0; i < 6; i++) {
+        EXPECT_EQ(push(buffer, i), i < 4);
+    }
+    EXPECT_EQ(buffer.droppedCount(), 2u);
+    int value = 0;
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(pop(buffer, value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(pop(buffer, value));
+}
+
+TEST(EventBufferTest, DropOldestMakesRoom)
+{
+    EventBuffer<int> buffer(4, OverflowPolicy::DropOldest);
+    std::vector<int> dropped;
+    buffer.setDropHandler([&dropped](const int &value) { dropped.push_back(value); });
+    for (int i = 0; i < 6; i++) {
+        EXPECT_TRUE(push(buffer, i));
+    }
+    EXPECT_EQ(buffer.droppedCount(), 2u);
+    EXPECT_EQ(dropped, (std::vector<int>{0, 1}));
+    int value = 0;
+    for (int i = 2; i < 6; i++) {
+        ASSERT_TRUE(pop(buffer, value));
+        EXPECT_EQ(value, i);
+    }
+}
+
+TEST(EventBufferTest, ValuesOfEachProducerArePoppedInOrder)
+{
+    const int producerCount = 4;
+    const int valueCount = 100000;
+    EventBuffer<int> buffer(256);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producerCount; p++) {
+        producers.emplace_back([&buffer, p] {
+            for (int i = 0; i < valueCount; i++) {
+                while (!push(buffer, p * valueCount + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> next(producerCount, 0);
+    int popped = 0;
+    int value = 0;
+    while (popped < producerCount * valueCount) {
+        if (!pop(buffer, value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        int producer = value / valueCount;
+        ASSERT_EQ(value % valueCount, next[producer]);
+        next[producer]++;
+        popped++;
+    }
+    for (std::thread &producer : producers) {
+        producer.join();
+    }
+    EXPECT_FALSE(pop(buffer, value));
+}
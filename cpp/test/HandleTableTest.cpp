@@ -0,0 +1,98 @@
+//
+//  HandleTableTest.cpp
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include "oddynatrace/HandleTable.h"
+
+using namespace oddynatrace;
+
+TEST(HandleTableTest, AddedObjectsAreFoundByHandle)
+{
+    HandleTable<int> table;
+    Handle first = table.add(10);
+    Handle second = table.add(20);
+    ASSERT_NE(first, InvalidHandle);
+    ASSERT_NE(second, InvalidHandle);
+    ASSERT_NE(first, second);
+
+    int object = 0;
+    EXPECT_TRUE(table.get(first, object));
+    EXPECT_EQ(object, 10);
+    EXPECT_TRUE(table.get(second, object));
+    EXPECT_EQ(object, 20);
+    EXPECT_EQ(table.count(), 2u);
+    EXPECT_FALSE(table.get(InvalidHandle, object));
+}
+
+TEST(HandleTableTest, RemovedHandlesAreStale)
+{
+    HandleTable<int> table;
+    Handle handle = table.add(10);
+    int object = 0;
+    EXPECT_TRUE(table.remove(handle, object));
+    EXPECT_EQ(object, 10);
+    EXPECT_TRUE(table.isStale(handle));
+    EXPECT_FALSE(table.contains(handle));
+    EXPECT_FALSE(table.remove(handle));
+
+    // The slot is reused with a new generation, the old handle does not resolve to the new object
+    Handle reused = table.add(30);
+    EXPECT_NE(reused, handle);
+    EXPECT_FALSE(table.get(handle, object));
+    EXPECT_TRUE(table.get(reused, object));
+    EXPECT_EQ(object, 30);
+    EXPECT_FALSE(table.isStale(reused));
+}
+
+TEST(HandleTableTest, UnknownHandlesAreNotStale)
+{
+    HandleTable<int> table;
+    table.add(10);
+    EXPECT_FALSE(table.isStale(InvalidHandle));
+    EXPECT_FALSE(table.isStale(12345));
+}
+
+TEST(HandleTableTest, ReservedHandlesAreSetLater)
+{
+    HandleTable<int> table;
+    Handle handle = table.reserve();
+    int object = 0;
+    EXPECT_TRUE(table.contains(handle));
+    EXPECT_FALSE(table.get(handle, object));
+
+    table.set(handle, 10);
+    EXPECT_TRUE(table.get(handle, object));
+    EXPECT_EQ(object, 10);
+
+    Handle unset = table.reserve();
+    EXPECT_FALSE(table.remove(unset));
+    EXPECT_FALSE(table.contains(unset));
+    table.set(unset, 20);
+    EXPECT_FALSE(table.get(unset, object));
+}
+
+TEST(HandleTableTest, ClearFreesEverySlot)
+{
+    HandleTable<int> table;
+    Handle handle = table.add(10);
+    table.reserve();
+    table.clear();
+    EXPECT_EQ(table.count(), 0u);
+    EXPECT_TRUE(table.isStale(handle));
+}
+
+TEST(HandleTableTest, FullTableReturnsInvalidHandle)
+{
+    HandleTable<int> table;
+    for (size_t i = 0; i < HandleTable<int>::MaxCount; i++) {
+        ASSERT_NE(table.add(1), InvalidHandle);
+    }
+    EXPECT_EQ(table.add(1), InvalidHandle);
+    EXPECT_EQ(table.reserve(), InvalidHandle);
+}
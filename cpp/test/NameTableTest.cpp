@@ -0,0 +1,71 @@
+//
+//  NameTableTest.cpp
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "oddynatrace/NameTable.h"
+
+using namespace oddynatrace;
+
+TEST(NameTableTest, NamesAreRegisteredOnce)
+{
+    NameTable names;
+    NameId load = names.registerName("load");
+    NameId render = names.registerName("render");
+    EXPECT_NE(load, InvalidNameId);
+    EXPECT_NE(load, render);
+    EXPECT_EQ(names.registerName(std::string("load")), load);
+    EXPECT_EQ(names.count(), 2u);
+    EXPECT_EQ(names.name(load), "load");
+    EXPECT_EQ(names.name(render), "render");
+}
+
+TEST(NameTableTest, UnknownIdsHaveNoName)
+{
+    NameTable names;
+    names.registerName("load");
+    EXPECT_TRUE(names.name(InvalidNameId).empty());
+    EXPECT_TRUE(names.name(2).empty());
+}
+
+TEST(NameTableTest, FullTableReturnsInvalidNameId)
+{
+    NameTable names(2);
+    EXPECT_NE(names.registerName("a"), InvalidNameId);
+    EXPECT_NE(names.registerName("b"), InvalidNameId);
+    EXPECT_EQ(names.registerName("c"), InvalidNameId);
+    EXPECT_NE(names.registerName("a"), InvalidNameId);
+}
+
+TEST(NameTableTest, NamesRegisteredFromSeveralThreadsGetOneId)
+{
+    NameTable names;
+    std::vector<std::vector<NameId>> ids(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < ids.size(); t++) {
+        threads.emplace_back([&names, &ids, t] {
+            for (int i = 0; i < 100; i++) {
+                ids[t].push_back(names.registerName("name" + std::to_string(i)));
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(names.count(), 100u);
+    for (size_t t = 1; t < ids.size(); t++) {
+        EXPECT_EQ(ids[t], ids[0]);
+    }
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(names.name(ids[0][i]), "name" + std::to_string(i));
+    }
+}
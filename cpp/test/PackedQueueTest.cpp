@@ -0,0 +1,131 @@
+//
+//  PackedQueueTest.cpp
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "oddynatrace/PackedQueue.h"
+
+using namespace oddynatrace;
+
+namespace {
+
+PackedRecord drained(const uint8_t *bytes)
+{
+    PackedRecord record;
+    std::memcpy(&record.type, bytes, 4);
+    std::memcpy(&record.handle, bytes + 4, 4);
+    std::memcpy(&record.nameId, bytes + 8, 4);
+    std::memcpy(&record.value, bytes + 16, 8);
+    return record;
+}
+
+} // namespace
+
+TEST(PackedQueueTest, DrainsTheRecordsOfABatch)
+{
+    PackedQueue queue(8);
+    const double packed[] = {3, 65537, 2, 42, 4, 65537, 3, 0.25, 7, 0, 5, 12.5};
+    ASSERT_TRUE(queue.push(packed, 12));
+    EXPECT_EQ(queue.count(), 3u);
+
+    uint8_t buffer[3 * PackedQueue::RecordLength];
+    ASSERT_EQ(queue.drain(buffer, sizeof(buffer), 3), 3u);
+    for (size_t i = 0; i < 3; i++) {
+        PackedRecord record = drained(buffer + i * PackedQueue::RecordLength);
+        EXPECT_EQ(record.type, packed[i * 4]);
+        EXPECT_EQ(record.handle, packed[i * 4 + 1]);
+        EXPECT_EQ(record.nameId, packed[i * 4 + 2]);
+        EXPECT_EQ(record.value, packed[i * 4 + 3]);
+    }
+    EXPECT_EQ(queue.count(), 0u);
+}
+
+TEST(PackedQueueTest, DrainsOneBatchAtATime)
+{
+    PackedQueue queue(8);
+    const double first[] = {3, 1, 1, 1, 3, 1, 1, 2};
+    const double second[] = {3, 1, 1, 3};
+    queue.push(first, 8);
+    queue.push(second, 4);
+
+    uint8_t buffer[8 * PackedQueue::RecordLength];
+    ASSERT_EQ(queue.drain(buffer, sizeof(buffer), 2), 2u);
+    EXPECT_EQ(drained(buffer + PackedQueue::RecordLength).value, 2);
+    ASSERT_EQ(queue.drain(buffer, sizeof(buffer), 1), 1u);
+    EXPECT_EQ(drained(buffer).value, 3);
+}
+
+TEST(PackedQueueTest, BatchesAreQueuedWholeOrNotAtAll)
+{
+    PackedQueue queue(4);
+    std::vector<double> packed(3 * PackedQueue::Fields, 1);
+    EXPECT_TRUE(queue.push(packed.data(), packed.size()));
+    EXPECT_FALSE(queue.push(packed.data(), 2 * PackedQueue::Fields));
+    EXPECT_EQ(queue.count(), 3u);
+    EXPECT_TRUE(queue.push(packed.data(), PackedQueue::Fields));
+    EXPECT_EQ(queue.count(), 4u);
+}
+
+TEST(PackedQueueTest, DrainStopsAtTheEndOfTheBuffer)
+{
+    PackedQueue queue(8);
+    std::vector<double> packed(4 * PackedQueue::Fields, 1);
+    queue.push(packed.data(), packed.size());
+    uint8_t buffer[2 * PackedQueue::RecordLength + 1];
+    EXPECT_EQ(queue.drain(buffer, sizeof(buffer), 4), 2u);
+    EXPECT_EQ(queue.count(), 2u);
+}
+
+TEST(PackedQueueTest, NumbersOutOfRangeSaturate)
+{
+    PackedQueue queue(4);
+    const double packed[] = {NAN, 1e12, -1e12, 1.5, 3.9, -3.9, 0, 0};
+    queue.push(packed, 8);
+    uint8_t buffer[2 * PackedQueue::RecordLength];
+    ASSERT_EQ(queue.drain(buffer, sizeof(buffer), 2), 2u);
+    PackedRecord record = drained(buffer);
+    EXPECT_EQ(record.type, 0);
+    EXPECT_EQ(record.handle, INT32_MAX);
+    EXPECT_EQ(record.nameId, INT32_MIN);
+    record = drained(buffer + PackedQueue::RecordLength);
+    EXPECT_EQ(record.type, 3);
+    EXPECT_EQ(record.handle, -3);
+}
+
+TEST(PackedQueueTest, RecordsArriveInOrderWhileDraining)
+{
+    const int batchCount = 10000;
+    PackedQueue queue(64);
+    std::thread producer([&queue] {
+        for (int batch = 0; batch < batchCount; batch++) {
+            const double packed[] = {3, 1, 1, static_cast<double>(batch * 2), 3, 1, 1, static_cast<double>(batch * 2 + 1)};
+            while (!queue.push(packed, 8)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint8_t buffer[64 * PackedQueue::RecordLength];
+    double expected = 0;
+    while (expected < batchCount * 2) {
+        size_t count = queue.drain(buffer, sizeof(buffer), 64);
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_EQ(drained(buffer + i * PackedQueue::RecordLength).value, expected);
+            expected++;
+        }
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+}
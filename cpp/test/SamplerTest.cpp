@@ -0,0 +1,86 @@
+//
+//  SamplerTest.cpp
+//  ODDynatraceCore
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "oddynatrace/Sampler.h"
+
+using namespace oddynatrace;
+
+TEST(SamplerTest, DefaultOptionsKeepEverything)
+{
+    Sampler sampler;
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_FALSE(sampler.drop("name" + std::to_string(i)));
+    }
+    EXPECT_EQ(sampler.sampledCount(), 0u);
+    EXPECT_EQ(sampler.rateLimitedCount(), 0u);
+}
+
+TEST(SamplerTest, SessionSampledOutDropsEverything)
+{
+    SamplerOptions options;
+    options.sampleRate = 0;
+    Sampler sampler(options);
+    EXPECT_TRUE(sampler.drop("load"));
+    EXPECT_TRUE(sampler.drop("render"));
+    EXPECT_EQ(sampler.sampledCount(), 2u);
+}
+
+TEST(SamplerTest, NameIsAlwaysOrNeverSampledDuringASession)
+{
+    SamplerOptions options;
+    options.sampleRates["never"] = 0;
+    options.sampleRates["sometimes"] = 0.5;
+    options.seed = 42;
+    Sampler sampler(options);
+    bool sometimes = sampler.drop("sometimes");
+    for (int i = 0; i < 100; i++) {
+        EXPECT_TRUE(sampler.drop("never"));
+        EXPECT_FALSE(sampler.drop("other"));
+        EXPECT_EQ(sampler.drop("sometimes"), sometimes);
+    }
+}
+
+TEST(SamplerTest, KeepFollowsTheRate)
+{
+    int kept = 0;
+    for (uint64_t key = 1; key <= 100000; key++) {
+        kept += Sampler::keep(key, 0.25);
+    }
+    EXPECT_NEAR(kept / 100000.0, 0.25, 0.01);
+    EXPECT_TRUE(Sampler::keep(1, 1));
+    EXPECT_FALSE(Sampler::keep(1, 0));
+}
+
+TEST(SamplerTest, RateLimitLetsABurstThrough)
+{
+    SamplerOptions options;
+    options.rateLimit = 10;
+    options.rateLimitBurst = 3;
+    Sampler sampler(options);
+    const uint64_t second = 1000000000;
+    uint64_t now = 10 * second;
+    EXPECT_FALSE(sampler.drop("a", now));
+    EXPECT_FALSE(sampler.drop("a", now));
+    EXPECT_FALSE(sampler.drop("a", now));
+    EXPECT_TRUE(sampler.drop("a", now));
+    EXPECT_EQ(sampler.rateLimitedCount(), 1u);
+
+    // One token every 100 ms
+    EXPECT_FALSE(sampler.drop("a", now + second / 10));
+    EXPECT_TRUE(sampler.drop("a", now + second / 10));
+    // A second later the bucket is full again
+    now += 2 * second;
+    for (int i = 0; i < 3; i++) {
+        EXPECT_FALSE(sampler.drop("a", now));
+    }
+    EXPECT_TRUE(sampler.drop("a", now));
+}
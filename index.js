@@ -3,4 +3,486 @@ import { NativeModules } from 'react-native';
 
 const { ODDynatrace } = NativeModules;
 
-export default ODDynatrace;
+const INT_MIN = -2147483648;
+const INT_MAX = 2147483647;
+
+// Synchronous native calls need the JS engine hook, missing when debugging remotely
+const synchronousAvailable = typeof global.nativeCallSyncHook === 'function'
+  && ODDynatrace != null
+  && typeof ODDynatrace.enterActionSync === 'function';
+
+// Batches of handle and name id records sent as flat arrays of numbers, Android only
+const packedAvailable = ODDynatrace != null && typeof ODDynatrace.submitPacked === 'function';
+
+// Same event types as ODDynatraceEvent.java, 7 for recorded values
+const PACKED_TYPES = {
+  leave: 1,
+  event: 2,
+  intValue: 3,
+  doubleValue: 4,
+  error: 6,
+  record: 7,
+};
+
+const config = {
+  batchSize: 50,
+  flushInterval: 16,
+  synchronous: synchronousAvailable,
+  packed: packedAvailable,
+};
+
+let queue = [];
+let callbacks = [];
+let timer = null;
+// Batches sent and not handled natively yet
+let pendingBatches = 0;
+
+function packable(record) {
+  return PACKED_TYPES[record.type] !== undefined
+    && (record.type === 'record' || typeof record.handle === 'number')
+    && (record.type === 'leave' || typeof record.nameId === 'number');
+}
+
+// Type, handle, name id and value of each record
+function pack(records) {
+  const packed = new Array(records.length * 4);
+  for (let i = 0; i < records.length; i++) {
+    const record = records[i];
+    packed[i * 4] = PACKED_TYPES[record.type];
+    packed[i * 4 + 1] = record.handle || 0;
+    packed[i * 4 + 2] = record.nameId || 0;
+    packed[i * 4 + 3] = record.value || 0;
+  }
+  return packed;
+}
+
+function flush() {
+  if (timer !== null) {
+    clearTimeout(timer);
+    timer = null;
+  }
+  if (queue.length === 0) {
+    return;
+  }
+  const records = queue;
+  const pending = callbacks;
+  queue = [];
+  callbacks = [];
+  pendingBatches++;
+  if (config.packed && pending.length === 0 && records.every(packable)) {
+    ODDynatrace.submitPacked(pack(records)).then(batchHandled, batchHandled);
+    return;
+  }
+  ODDynatrace.submitBatch(records).then(
+    (values) => {
+      batchHandled();
+      pending.forEach(({ index, resolve }) => resolve(values[index]));
+    },
+    (error) => {
+      batchHandled();
+      pending.forEach(({ reject }) => reject(error));
+    },
+  );
+}
+
+function batchHandled() {
+  pendingBatches--;
+}
+
+function enqueue(record) {
+  queue.push(record);
+  if (queue.length >= config.batchSize) {
+    flush();
+  } else if (timer === null) {
+    timer = setTimeout(flush, config.flushInterval);
+  }
+}
+
+// Resolves with the native result of the record once its batch has been replayed
+function enqueueWithResult(record) {
+  return new Promise((resolve, reject) => {
+    callbacks.push({ index: queue.length, resolve, reject });
+    enqueue(record);
+  });
+}
+
+// Actions are either handles returned by enterAction, or action names grouped per batch
+function target(action) {
+  return typeof action === 'number' ? { handle: action } : { action };
+}
+
+// Names are either strings or ids returned by registerNames
+function nameField(name) {
+  return typeof name === 'number' ? { nameId: name } : { name };
+}
+
+function valueType(value) {
+  if (typeof value === 'string') {
+    return 'stringValue';
+  }
+  return Number.isInteger(value) && value >= INT_MIN && value <= INT_MAX ? 'intValue' : 'doubleValue';
+}
+
+// Constant names of the negative status codes, same as ODDynatraceStatus
+const STATUS_NAMES = {
+  [-1]: 'CPWR_Error_NotInitialized',
+  [-4]: 'CPWR_Error_ActionNotFound',
+  [-5]: 'CPWR_Error_InvalidParameter',
+  [-6]: 'CPWR_Error_ActionEnded',
+};
+
+// enterAction returns a handle, or a negative status code when the parent action is missing
+function actionHandle(result) {
+  if (result >= 0) {
+    return result;
+  }
+  const error = new Error(`enterAction failed with status ${result}`);
+  error.code = STATUS_NAMES[result] || `CPWR_Unknown(${result})`;
+  error.status = result;
+  throw error;
+}
+
+function eventRecord(action, eventName) {
+  return { type: 'event', ...target(action), ...nameField(eventName) };
+}
+
+function valueRecord(action, valueName, value) {
+  return { type: valueType(value), ...target(action), ...nameField(valueName), value };
+}
+
+function errorRecord(action, errorName, errorValue) {
+  return { type: 'error', ...target(action), ...nameField(errorName), value: errorValue };
+}
+
+// Screen marks carry the JS time, the native side computes the screen times from them
+function screenRecord(mark, screenName) {
+  return { type: 'screen', mark, ...nameField(screenName), time: Date.now() };
+}
+
+// Name of the focused route of a react-navigation state
+function activeRouteName(state) {
+  const route = state.routes[state.index];
+  return route.routes ? activeRouteName(route) : route.routeName;
+}
+
+// Same calls resolving with the ADK status code. They always go through the batch queue, the synchronous
+// calls only queue the event and can't know it. The plain calls made after them wait for their batch,
+// see synchronousReady, so both keep the order of the calls on a handle.
+const withStatus = {
+  leaveAction(handle) {
+    return enqueueWithResult({ type: 'leave', handle });
+  },
+
+  reportEvent(action, eventName) {
+    return enqueueWithResult(eventRecord(action, eventName));
+  },
+
+  reportValue(action, valueName, value) {
+    return enqueueWithResult(valueRecord(action, valueName, value));
+  },
+
+  reportError(action, errorName, errorValue) {
+    return enqueueWithResult(errorRecord(action, errorName, errorValue));
+  },
+};
+
+// Synchronous calls write their event into the native buffer right away, which the module queue drains before
+// handling the next batch. They only skip the batch queue once it is empty and the batches sent before were
+// handled, so all the calls reach the ADK in the order they were made.
+function synchronousReady() {
+  return config.synchronous && queue.length === 0 && pendingBatches === 0;
+}
+
+// Handle based calls skip the batch queue when synchronous calls are enabled
+function synchronous(action) {
+  return typeof action === 'number' && synchronousReady();
+}
+
+// Ids of the names passed to recordValue, registered once per name so the recorded values reach the native
+// histograms without a name lookup. 0 while the registration of a batched call is pending or when the table is full.
+const recordNameIds = new Map();
+
+function recordNameId(name) {
+  let nameId = recordNameIds.get(name);
+  if (nameId === undefined) {
+    if (config.synchronous) {
+      [nameId] = ODDynatrace.registerNamesSync([name]);
+    } else {
+      nameId = 0;
+      // Keeps recording by name when the registration fails
+      ODDynatrace.registerNames([name])
+        .then(([registered]) => recordNameIds.set(name, registered))
+        .catch(() => recordNameIds.set(name, 0));
+    }
+    recordNameIds.set(name, nameId);
+  }
+  return nameId;
+}
+
+// Status passed to stopWebRequest when the request failed without a response
+const WEB_REQUEST_FAILED = -1;
+
+function stopWebRequest(handle, statusCode) {
+  if (handle !== 0) {
+    ODDynatrace.stopWebRequest(handle, statusCode);
+  }
+}
+
+// Tag of the current action, cached natively. Without synchronous calls the last resolved tag is used.
+let requestTag = { header: null, value: null };
+
+function currentRequestTag() {
+  if (config.synchronous) {
+    return ODDynatrace.getRequestTagSync();
+  }
+  ODDynatrace.getRequestTag().then((tag) => {
+    requestTag = tag;
+  });
+  return requestTag;
+}
+
+// Headers with the request tag added, either a Headers instance or a plain object
+function tagHeaders(headers = {}) {
+  const { header, value } = currentRequestTag();
+  if (value == null) {
+    return headers;
+  }
+  if (typeof Headers !== 'undefined' && headers instanceof Headers) {
+    const tagged = new Headers(headers);
+    tagged.set(header, value);
+    return tagged;
+  }
+  return { ...headers, [header]: value };
+}
+
+// Drop-in replacement of the global fetch tagging and timing the request
+async function tracedFetch(input, init = {}) {
+  const request = typeof input === 'string' ? null : input;
+  const { handle, header, value } = await ODDynatrace.startWebRequest(request ? request.url : input);
+  let options = init;
+  if (value != null) {
+    const headers = new Headers(init.headers || (request && request.headers));
+    headers.set(header, value);
+    options = { ...init, headers };
+  }
+  try {
+    const response = await fetch(input, options);
+    stopWebRequest(handle, response.status);
+    return response;
+  } catch (error) {
+    stopWebRequest(handle, WEB_REQUEST_FAILED);
+    throw error;
+  }
+}
+
+export default {
+  configure(options) {
+    flush();
+    Object.assign(config, options);
+    config.synchronous = config.synchronous && synchronousAvailable;
+    config.packed = config.packed && packedAvailable;
+  },
+
+  get isSynchronous() {
+    return config.synchronous;
+  },
+
+  get isPacked() {
+    return config.packed;
+  },
+
+  // Resolves with the ADK startup status code
+  startup(appId, serverURL, options = {}) {
+    return ODDynatrace.startup(appId, serverURL, options);
+  },
+
+  shutdown() {
+    flush();
+    ODDynatrace.shutdown();
+  },
+
+  // Call once startup resolved. Resolves with the ADK status code.
+  enableCrashReporting(sendCrashReport = true) {
+    return ODDynatrace.enableCrashReporting(sendCrashReport);
+  },
+
+  // Resolves with { crashed, breadcrumbs: [{ type, name, timestamp }] } of the previous launch
+  getPreviousBreadcrumbs() {
+    return ODDynatrace.getPreviousBreadcrumbs();
+  },
+
+  registerNames(names) {
+    if (config.synchronous) {
+      return Promise.resolve(ODDynatrace.registerNamesSync(names));
+    }
+    return ODDynatrace.registerNames(names);
+  },
+
+  // Rejects with error.code "CPWR_Error_ActionNotFound" or "CPWR_Error_ActionEnded" when the parent is not open
+  enterAction(actionName, parentAction = 0) {
+    if (!synchronousReady()) {
+      return enqueueWithResult({ type: 'enter', ...nameField(actionName), parent: parentAction }).then(actionHandle);
+    }
+    return new Promise(resolve => resolve(actionHandle(typeof actionName === 'number'
+      ? ODDynatrace.enterActionWithIdSync(actionName, parentAction)
+      : ODDynatrace.enterActionSync(actionName, parentAction))));
+  },
+
+  leaveAction(handle) {
+    if (synchronous(handle)) {
+      ODDynatrace.leaveActionSync(handle);
+    } else {
+      enqueue({ type: 'leave', handle });
+    }
+  },
+
+  reportEvent(action, eventName) {
+    if (!synchronous(action)) {
+      enqueue(eventRecord(action, eventName));
+    } else if (typeof eventName === 'number') {
+      ODDynatrace.reportEventWithIdSync(action, eventName);
+    } else {
+      ODDynatrace.reportEventSync(action, eventName);
+    }
+  },
+
+  reportValue(action, valueName, value) {
+    const type = valueType(value);
+    const byId = typeof valueName === 'number';
+    if (!synchronous(action) || (byId && type === 'stringValue')) {
+      enqueue(valueRecord(action, valueName, value));
+    } else if (type === 'intValue' && byId) {
+      ODDynatrace.reportIntValueWithIdSync(action, valueName, value);
+    } else if (type === 'intValue') {
+      ODDynatrace.reportIntValueSync(action, valueName, value);
+    } else if (type === 'doubleValue' && byId) {
+      ODDynatrace.reportDoubleValueWithIdSync(action, valueName, value);
+    } else if (type === 'doubleValue') {
+      ODDynatrace.reportDoubleValueSync(action, valueName, value);
+    } else {
+      ODDynatrace.reportStringValueSync(action, valueName, value);
+    }
+  },
+
+  reportError(action, errorName, errorValue) {
+    if (!synchronous(action)) {
+      enqueue(errorRecord(action, errorName, errorValue));
+    } else if (typeof errorName === 'number') {
+      ODDynatrace.reportErrorWithIdSync(action, errorName, errorValue);
+    } else {
+      ODDynatrace.reportErrorSync(action, errorName, errorValue);
+    }
+  },
+
+  // leaveAction, reportEvent, reportValue and reportError resolving with their status code,
+  // e.g. ODDynatrace.withStatus.reportEvent(home, "Refresh"). The plain calls don't create any promise.
+  withStatus,
+
+  // Aggregated natively, see README "Recorded values"
+  recordValue(name, value) {
+    const nameId = typeof name === 'number' ? name : recordNameId(name);
+    if (!synchronousReady()) {
+      enqueue({ type: 'record', ...nameField(nameId || name), value });
+    } else if (nameId) {
+      ODDynatrace.recordValueWithIdSync(nameId, value);
+    } else {
+      ODDynatrace.recordValueSync(name, value);
+    }
+  },
+
+  // Screens, see README "Screens". Call screenRendered from the componentDidMount of the screen.
+  enterScreen(screenName) {
+    enqueue(screenRecord('enter', screenName));
+  },
+
+  screenRendered(screenName) {
+    enqueue(screenRecord('render', screenName));
+  },
+
+  exitScreen(screenName) {
+    enqueue(screenRecord('exit', screenName));
+  },
+
+  // Pass as onNavigationStateChange of a react-navigation navigator to track its routes as screens
+  onNavigationStateChange(previousState, currentState) {
+    const previousScreen = activeRouteName(previousState);
+    const currentScreen = activeRouteName(currentState);
+    if (previousScreen !== currentScreen) {
+      enqueue(screenRecord('exit', previousScreen));
+      enqueue(screenRecord('enter', currentScreen));
+    }
+  },
+
+  startWebRequest(url) {
+    return ODDynatrace.startWebRequest(url);
+  },
+
+  stopWebRequest,
+
+  fetch: tracedFetch,
+
+  // Request tagging without timing, see README "Request tagging"
+  getRequestTag() {
+    return currentRequestTag();
+  },
+
+  tagHeaders,
+
+  taggedFetch(input, init = {}) {
+    const headers = init.headers || (typeof input === 'string' ? undefined : input.headers);
+    return fetch(input, { ...init, headers: tagHeaders(headers) });
+  },
+
+  // Call after xhr.open
+  tagXMLHttpRequest(xhr) {
+    const { header, value } = currentRequestTag();
+    if (value != null) {
+      xhr.setRequestHeader(header, value);
+    }
+    return xhr;
+  },
+
+  // The tag is sent with the handshake
+  openWebSocket(url, protocols) {
+    return new WebSocket(url, protocols, { headers: tagHeaders() });
+  },
+
+  // Sends the queued calls, then the events collected by the ADK. Resolves with the ADK status code.
+  flush() {
+    flush();
+    return ODDynatrace.flush();
+  },
+
+  // "wifi", "cellular", "none" or "unknown", e.g. from NetInfo, used by the flush scheduler
+  setNetworkType(networkType) {
+    ODDynatrace.setNetworkType(networkType);
+  },
+
+  getEventBufferStats() {
+    return ODDynatrace.getEventBufferStats();
+  },
+
+  getSpillLogStats() {
+    return ODDynatrace.getSpillLogStats();
+  },
+
+  getSamplingStats() {
+    return ODDynatrace.getSamplingStats();
+  },
+
+  // Resolves with the number of results per status name, e.g. { CPWR_UemOn: 120, CPWR_Error_ActionEnded: 2 }
+  getStatusCounts() {
+    return ODDynatrace.getStatusCounts();
+  },
+
+  // Resolves with the startup statusCode, and the milliseconds spent waiting for a deferred startup (wait)
+  // and in the ADK startup (duration)
+  getStartupStats() {
+    return ODDynatrace.getStartupStats();
+  },
+
+  // Snapshot of what the module costs and of the stats above, see README "Module stats"
+  getStats() {
+    return ODDynatrace.getStats();
+  },
+};
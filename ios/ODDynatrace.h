@@ -14,7 +14,57 @@
 #import "React/RCTBridgeModule.h"   // Required when used as a Pod in a Swift project
 #endif
 
+#import "ODDynatraceEventBuffer.h"
+#import "ODDynatraceHandleTable.h"
+#import "ODDynatraceNameTable.h"
+
 @interface ODDynatrace : NSObject <RCTBridgeModule>
 
+// QoS of the serial queue the module methods run on, defaults to QOS_CLASS_UTILITY.
+// Must be set before the bridge is created.
++ (void)setQualityOfService:(qos_class_t)qualityOfService;
+
+// Size of the event buffer shared by all callers, defaults to 1024 events dropping the newest ones.
+// Must be set before the bridge is created.
++ (void)setEventBufferCapacity:(NSUInteger)capacity overflowPolicy:(ODDynatraceOverflowPolicy)overflowPolicy;
+
+// Size of the file keeping the events recorded while the ADK is not started, defaults to 256 KB.
+// 0 disables it. Must be set before the bridge is created.
++ (void)setSpillLogCapacity:(NSUInteger)capacity;
+
+// Number of breadcrumbs kept for crash reports, defaults to 64. 0 disables them.
+// Must be set before the bridge is created.
++ (void)setBreadcrumbCapacity:(NSUInteger)capacity;
+
+// Native instrumentation API, for other native modules and background workers.
+// These methods can be called from any thread, the ADK is called from the module queue. Entering an action
+// reserves its handle under the handle table lock, and checks its parent under the same lock. The other calls
+// only queue an event in the lock-free buffer.
+- (ODDynatraceHandle)enterActionWithName:(nonnull NSString *)actionName;
+// Returns a negative CPWR_StatusCode when the parent action does not exist or already ended.
+// Leaving an action leaves its children first.
+- (ODDynatraceHandle)enterActionWithName:(nonnull NSString *)actionName parentAction:(ODDynatraceHandle)parentAction;
+- (void)leaveAction:(ODDynatraceHandle)action;
+- (void)reportEventWithName:(nonnull NSString *)eventName action:(ODDynatraceHandle)action;
+- (void)reportValueWithName:(nonnull NSString *)valueName intValue:(int)intValue action:(ODDynatraceHandle)action;
+- (void)reportValueWithName:(nonnull NSString *)valueName doubleValue:(double)doubleValue action:(ODDynatraceHandle)action;
+- (void)reportValueWithName:(nonnull NSString *)valueName stringValue:(nonnull NSString *)stringValue action:(ODDynatraceHandle)action;
+- (void)reportErrorWithName:(nonnull NSString *)errorName errorValue:(int)errorValue action:(ODDynatraceHandle)action;
+
+// Aggregates high frequency values natively, only their count, min, max, p50, p90 and p99 are reported
+// periodically as values of an action named after them. The name variant registers the name on each call,
+// taking the name table lock : frequent callers register it once and use the id variant.
+- (void)recordValue:(double)value name:(nonnull NSString *)name;
+- (void)recordValue:(double)value nameId:(ODDynatraceNameId)nameId;
+
+// Variants taking names registered once, so the calls neither copy nor allocate strings
+- (ODDynatraceNameId)registerName:(nonnull NSString *)name;
+- (ODDynatraceHandle)enterActionWithNameId:(ODDynatraceNameId)actionNameId;
+- (ODDynatraceHandle)enterActionWithNameId:(ODDynatraceNameId)actionNameId parentAction:(ODDynatraceHandle)parentAction;
+- (void)reportEventWithNameId:(ODDynatraceNameId)eventNameId action:(ODDynatraceHandle)action;
+- (void)reportValueWithNameId:(ODDynatraceNameId)valueNameId intValue:(int)intValue action:(ODDynatraceHandle)action;
+- (void)reportValueWithNameId:(ODDynatraceNameId)valueNameId doubleValue:(double)doubleValue action:(ODDynatraceHandle)action;
+- (void)reportErrorWithNameId:(ODDynatraceNameId)errorNameId errorValue:(int)errorValue action:(ODDynatraceHandle)action;
+
 @end
   
@@ -8,37 +8,1281 @@
 
 #import "ODDynatrace.h"
 #import "DynatraceUEM.h"
+#import "ODDynatraceActionTree.h"
+#import "ODDynatraceArena.h"
+#import "ODDynatraceBreadcrumbs.h"
+#import "ODDynatraceCoalescer.h"
+#import "ODDynatraceFlushScheduler.h"
+#import "ODDynatraceMetrics.h"
+#import "ODDynatraceSampler.h"
+#import "ODDynatraceScreens.h"
+#import "ODDynatraceSpillLog.h"
+#import "ODDynatraceStatus.h"
+#import "ODDynatraceTelemetry.h"
+#import "ODDynatraceWatchdog.h"
+
+#import <stdatomic.h>
+
+#if __has_include(<React/RCTLog.h>)
+#import <React/RCTBridge+Private.h>
+#import <React/RCTLog.h>
+#else
+#import "RCTBridge+Private.h"
+#import "RCTLog.h"
+#endif
+
+static qos_class_t ODDynatraceQualityOfService = QOS_CLASS_UTILITY;
+static NSUInteger ODDynatraceEventBufferCapacity = 1024;
+static ODDynatraceOverflowPolicy ODDynatraceEventBufferOverflowPolicy = ODDynatraceOverflowPolicyDropNewest;
+static NSUInteger ODDynatraceSpillLogCapacity = 256 * 1024;
+static NSUInteger ODDynatraceBreadcrumbCapacity = 64;
+
+static NSDictionary<NSString *, NSNumber *> *ODDynatraceEventTypes(void)
+{
+    static NSDictionary<NSString *, NSNumber *> *types;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        types = @{
+            @"enter": @(ODDynatraceEventEnterAction),
+            @"leave": @(ODDynatraceEventLeaveAction),
+            @"event": @(ODDynatraceEventReportEvent),
+            @"intValue": @(ODDynatraceEventReportIntValue),
+            @"doubleValue": @(ODDynatraceEventReportDoubleValue),
+            @"stringValue": @(ODDynatraceEventReportStringValue),
+            @"error": @(ODDynatraceEventReportError),
+        };
+    });
+    return types;
+}
+
+// Estimated size of a record on the bridge : UTF-16 strings and 8 bytes numbers, keys excluded
+static NSUInteger ODDynatraceRecordSize(NSDictionary *record)
+{
+    __block NSUInteger size = 0;
+    [record enumerateKeysAndObjectsUsingBlock:^(NSString *key, id value, BOOL *stop) {
+        size += [value isKindOfClass:[NSString class]] ? [(NSString *)value length] * sizeof(unichar) : sizeof(double);
+    }];
+    return size;
+}
+
+// Actions opened by name during one batch, an open addressing table allocated from the batch arena
+typedef struct {
+    CFStringRef name;
+    ODDynatraceHandle handle;
+} ODDynatraceBatchAction;
+
+typedef struct {
+    ODDynatraceBatchAction *entries;
+    size_t mask;
+} ODDynatraceBatchActions;
+
+static ODDynatraceBatchAction *ODDynatraceBatchActionFind(ODDynatraceBatchActions *batchActions, CFStringRef name)
+{
+    size_t index = CFHash(name) & batchActions->mask;
+    while (batchActions->entries[index].name && !CFEqual(batchActions->entries[index].name, name)) {
+        index = (index + 1) & batchActions->mask;
+    }
+    return &batchActions->entries[index];
+}
+
+// Opened once per process : a bridge reload creates a new module, which must neither read the active flag left by
+// the previous one as a crash nor map the file again
+static ODDynatraceBreadcrumbs *ODDynatraceSharedBreadcrumbs(void)
+{
+    static ODDynatraceBreadcrumbs *breadcrumbs;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        if (ODDynatraceBreadcrumbCapacity > 0) {
+            NSString *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+            breadcrumbs = [[ODDynatraceBreadcrumbs alloc] initWithPath:[caches stringByAppendingPathComponent:@"ODDynatrace.breadcrumbs"]
+                                                              capacity:ODDynatraceBreadcrumbCapacity];
+        }
+    });
+    return breadcrumbs;
+}
+
+// Runs the block on the main thread the next time its run loop has nothing left to do
+static void ODDynatraceRunWhenIdle(dispatch_block_t block)
+{
+    CFRunLoopObserverRef observer = CFRunLoopObserverCreateWithHandler(kCFAllocatorDefault, kCFRunLoopBeforeWaiting, false, 0,
+                                                                       ^(CFRunLoopObserverRef observer, CFRunLoopActivity activity) {
+        block();
+    });
+    CFRunLoopAddObserver(CFRunLoopGetMain(), observer, kCFRunLoopDefaultMode);
+    CFRelease(observer);
+}
+
+@interface ODDynatrace ()
+
+// Replaced on each startup, read by the callers of any thread
+@property (atomic, strong) ODDynatraceSampler *sampler;
+
+// Value tagging requests to the current action, refreshed on the module queue, read by the JS thread
+@property (atomic, copy) NSString *requestTag;
+
+@end
 
 @implementation ODDynatrace
+{
+    ODDynatraceHandleTable<UEMAction *> *_actions;
+    ODDynatraceHandleTable<UEMWebRequestTiming *> *_webRequests;
+    ODDynatraceEventBuffer *_events;
+    ODDynatraceNameTable *_names;
+    atomic_flag _drainScheduled;
+    // Bumped by each startup and shutdown call, a deferred startup only runs if none was made since
+    atomic_uint _startupGeneration;
+    BOOL _startupPending;
+    ODDynatraceFlushScheduler *_flushScheduler;
+    NSString *_networkType;
+    ODDynatraceSpillLog *_spillLog;
+    BOOL _started;
+    ODDynatraceArena *_arena;
+    ODDynatraceActionTree *_actionTree;
+    ODDynatraceStatusCounts *_statusCounts;
+    ODDynatraceWatchdog *_watchdog;
+    ODDynatraceMetrics *_metrics;
+    ODDynatraceBreadcrumbs *_breadcrumbs;
+    ODDynatraceScreens *_screens;
+    ODDynatraceTelemetry *_telemetry;
+    ODDynatraceCoalescer *_coalescer;
+    BOOL _requestTagStale;
+    CPWR_StatusCode _startupStatus;
+    CFTimeInterval _startupWait;
+    CFTimeInterval _startupDuration;
+}
+
+@synthesize bridge = _bridge;
+@synthesize methodQueue = _methodQueue;
+
++ (void)setQualityOfService:(qos_class_t)qualityOfService
+{
+    ODDynatraceQualityOfService = qualityOfService;
+}
+
++ (void)setEventBufferCapacity:(NSUInteger)capacity overflowPolicy:(ODDynatraceOverflowPolicy)overflowPolicy
+{
+    ODDynatraceEventBufferCapacity = capacity;
+    ODDynatraceEventBufferOverflowPolicy = overflowPolicy;
+}
+
++ (void)setSpillLogCapacity:(NSUInteger)capacity
+{
+    ODDynatraceSpillLogCapacity = capacity;
+}
 
-- (dispatch_queue_t)methodQueue
++ (void)setBreadcrumbCapacity:(NSUInteger)capacity
 {
-    return dispatch_get_main_queue();
+    ODDynatraceBreadcrumbCapacity = capacity;
+}
+
+- (instancetype)init
+{
+    if ((self = [super init])) {
+        dispatch_queue_attr_t attributes = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL,
+                                                                                   ODDynatraceQualityOfService,
+                                                                                   0);
+        _methodQueue = dispatch_queue_create("com.odemolliens.rn.dynatrace", attributes);
+        _actions = [[ODDynatraceHandleTable alloc] initWithCapacity:64];
+        _names = [[ODDynatraceNameTable alloc] initWithCapacity:4096];
+        _webRequests = [[ODDynatraceHandleTable alloc] initWithCapacity:16];
+        _networkType = @"unknown";
+        _arena = [[ODDynatraceArena alloc] initWithBlockSize:16 * 1024];
+        _actionTree = [ODDynatraceActionTree new];
+        _statusCounts = [ODDynatraceStatusCounts new];
+        _metrics = [[ODDynatraceMetrics alloc] initWithCapacity:4096];
+        _events = [[ODDynatraceEventBuffer alloc] initWithCapacity:ODDynatraceEventBufferCapacity
+                                                    overflowPolicy:ODDynatraceEventBufferOverflowPolicy];
+        atomic_flag_clear(&_drainScheduled);
+
+        NSString *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+        if (ODDynatraceSpillLogCapacity > 0) {
+            _spillLog = [[ODDynatraceSpillLog alloc] initWithPath:[caches stringByAppendingPathComponent:@"ODDynatrace.spill"]
+                                                         capacity:ODDynatraceSpillLogCapacity];
+        }
+        _breadcrumbs = ODDynatraceSharedBreadcrumbs();
+
+        __weak ODDynatrace *weakSelf = self;
+        _metrics.reportHandler = ^(ODDynatraceNameId nameId, const ODDynatraceHistogramSummary *summary) {
+            [weakSelf reportSummary:summary nameId:nameId];
+        };
+
+        _telemetry = [ODDynatraceTelemetry new];
+        _telemetry.dumpHandler = ^{
+            RCTLogInfo(@"Dynatrace stats %@", [weakSelf stats]);
+        };
+
+        _screens = [[ODDynatraceScreens alloc] initWithQueue:_methodQueue];
+        _screens.enterHandler = ^ODDynatraceHandle(NSString *name) {
+            return [weakSelf enterActionWithName:name];
+        };
+        _screens.valueHandler = ^(ODDynatraceHandle action, NSString *valueName, double value) {
+            [weakSelf reportValueWithName:valueName doubleValue:value action:action];
+        };
+        _screens.leaveHandler = ^(ODDynatraceHandle action) {
+            [weakSelf leaveAction:action];
+        };
+        _screens.idleHandler = ^(dispatch_block_t block) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                ODDynatraceRunWhenIdle(block);
+            });
+        };
+
+        // A dropped enter never reaches the ADK, give its reserved handle back
+        ODDynatraceHandleTable *actions = _actions;
+        _events.dropHandler = ^(const ODDynatraceEvent *event) {
+            if (event->type == ODDynatraceEventEnterAction) {
+                [actions removeObjectForHandle:event->handle];
+            }
+        };
+    }
+    return self;
 }
 
 RCT_EXPORT_MODULE()
 
 RCT_EXPORT_METHOD(startup:(NONNULL NSString *)appId
-                  serverURL:(NONNULL NSString *)serverURL)
+                  serverURL:(NONNULL NSString *)serverURL
+                  options:(NSDictionary *)options
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    [self cancelDeferredStartup];
+    unsigned int generation = atomic_load(&_startupGeneration);
+    self.sampler = [[ODDynatraceSampler alloc] initWithOptions:options];
+    [_flushScheduler invalidate];
+    _flushScheduler = [[ODDynatraceFlushScheduler alloc] initWithOptions:options queue:_methodQueue];
+    _flushScheduler.networkType = _networkType;
+    [_watchdog invalidate];
+    _watchdog = [self watchdogWithOptions:options];
+    [_watchdog start];
+    [_metrics startWithOptions:options queue:_methodQueue];
+    [_telemetry startWithOptions:options queue:_methodQueue];
+    [_coalescer flush];
+    _coalescer = [self coalescerWithOptions:options];
+
+    // The ADK registers UIApplication observers on startup, so it stays on the main thread.
+    CFAbsoluteTime requestTime = CFAbsoluteTimeGetCurrent();
+    __block CFAbsoluteTime startTime;
+    __block CFAbsoluteTime endTime;
+    __block CPWR_StatusCode statusCode;
+    dispatch_block_t startup = ^{
+        startTime = CFAbsoluteTimeGetCurrent();
+        statusCode = [DynatraceUEM startupWithApplicationName:appId
+                                                    serverURL:serverURL
+                                                 allowAnyCert:NO
+                                              certificatePath:nil
+                      ];
+        endTime = CFAbsoluteTimeGetCurrent();
+    };
+    dispatch_block_t didStartup = ^{
+        self->_startupWait = startTime - requestTime;
+        self->_startupDuration = endTime - startTime;
+        [self didStartup:statusCode];
+        resolve(@(statusCode));
+    };
+
+    // Waiting here keeps the calls queued behind it ordered without blocking the JS thread
+    double delay = [options[@"startupDelay"] doubleValue];
+    BOOL onIdle = [options[@"startupOnIdle"] boolValue];
+    if (delay <= 0 && !onIdle) {
+        dispatch_sync(dispatch_get_main_queue(), startup);
+        didStartup();
+        return;
+    }
+
+    // Deferred startups leave the launch frames alone, the calls made until then are spilled and replayed
+    _startupPending = YES;
+    dispatch_block_t deferredStartup = ^{
+        // Cancelled by a shutdown or a later startup
+        if (atomic_load(&self->_startupGeneration) != generation) {
+            resolve(@(CPWR_Error_NotInitialized));
+            return;
+        }
+        startup();
+        dispatch_async(self.methodQueue, ^{
+            // Cancelled after starting the ADK, by a shutdown or by a later startup taking over
+            if (atomic_load(&self->_startupGeneration) != generation) {
+                resolve(@(CPWR_Error_NotInitialized));
+                return;
+            }
+            self->_startupPending = NO;
+            didStartup();
+        });
+    };
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_MSEC)), dispatch_get_main_queue(), ^{
+        if (onIdle) {
+            ODDynatraceRunWhenIdle(deferredStartup);
+        } else {
+            deferredStartup();
+        }
+    });
+}
+
+// The generation is bumped on the main thread while a deferred startup is pending, so the deferred startup
+// either sees it was cancelled, or already started the ADK before the caller goes on.
+- (void)cancelDeferredStartup
+{
+    if (!_startupPending) {
+        atomic_fetch_add(&_startupGeneration, 1);
+        return;
+    }
+    _startupPending = NO;
+    dispatch_sync(dispatch_get_main_queue(), ^{
+        atomic_fetch_add(&self->_startupGeneration, 1);
+    });
+}
+
+- (void)didStartup:(CPWR_StatusCode)statusCode
 {
-    CPWR_StatusCode statusCode = [DynatraceUEM startupWithApplicationName:appId
-                                                                serverURL:serverURL
-                                                             allowAnyCert:NO
-                                                          certificatePath:nil
-                                  ];
+    _startupStatus = statusCode;
+    [self logStartupStatus:statusCode];
+    [_statusCounts countStatus:statusCode];
+    if (statusCode == CPWR_UemOn) {
+        _started = YES;
+        [self replaySpillLog];
+        [self reportCrashBreadcrumbs];
+        _requestTagStale = YES;
+        [self refreshRequestTag];
+    }
+}
+
+// The ADK sends the crash report itself, the breadcrumbs of the crashed launch follow as one action
+- (void)reportCrashBreadcrumbs
+{
+    if (![_breadcrumbs claimPreviousLaunchCrash]) {
+        return;
+    }
+    NSArray<NSDictionary *> *breadcrumbs = _breadcrumbs.previousBreadcrumbs;
+    if (breadcrumbs.count == 0) {
+        return;
+    }
+    ODDynatraceHandle action = [self enterActionWithName:@"Crash breadcrumbs"];
+    [breadcrumbs enumerateObjectsUsingBlock:^(NSDictionary *breadcrumb, NSUInteger index, BOOL *stop) {
+        NSString *value = [NSString stringWithFormat:@"%@ %@",
+                           ODDynatraceEventTypeName([breadcrumb[@"type"] unsignedCharValue]), breadcrumb[@"name"]];
+        [self reportValueWithName:[NSString stringWithFormat:@"%lu", (unsigned long)index + 1]
+                      stringValue:value
+                           action:action];
+    }];
+    [self leaveAction:action];
+}
+
+// Reports the JS thread latencies as values of a periodic action, through the same buffer as the other calls
+- (ODDynatraceWatchdog *)watchdogWithOptions:(NSDictionary *)options
+{
+    ODDynatraceWatchdog *watchdog = [[ODDynatraceWatchdog alloc] initWithOptions:options queue:_methodQueue];
+    NSString *actionName = options[@"watchdogActionName"] ?: @"JS thread";
+    __weak RCTBridge *bridge = _bridge;
+    __weak ODDynatrace *weakSelf = self;
+    watchdog.pingHandler = ^(dispatch_block_t ping) {
+        [bridge dispatchBlock:ping queue:RCTJSThread];
+    };
+    watchdog.reportHandler = ^(ODDynatraceWatchdogReport report) {
+        ODDynatrace *strongSelf = weakSelf;
+        ODDynatraceHandle action = [strongSelf enterActionWithName:actionName];
+        [strongSelf reportValueWithName:@"p50" doubleValue:report.p50 action:action];
+        [strongSelf reportValueWithName:@"p95" doubleValue:report.p95 action:action];
+        [strongSelf reportValueWithName:@"p99" doubleValue:report.p99 action:action];
+        [strongSelf reportValueWithName:@"max" doubleValue:report.max action:action];
+        [strongSelf reportValueWithName:@"Long tasks" intValue:(int)report.longTaskCount action:action];
+        [strongSelf leaveAction:action];
+    };
+    return watchdog;
+}
+
+// Repeated events within coalesceWindow milliseconds (startup option, disabled by default) are counted,
+// the count is reported right away so it stays before the leave of the action
+- (ODDynatraceCoalescer *)coalescerWithOptions:(NSDictionary *)options
+{
+    NSTimeInterval window = [options[@"coalesceWindow"] doubleValue] / 1000;
+    if (window <= 0) {
+        return nil;
+    }
+    ODDynatraceCoalescer *coalescer = [[ODDynatraceCoalescer alloc] initWithCapacity:64 window:window queue:_methodQueue];
+    __weak ODDynatrace *weakSelf = self;
+    coalescer.repeatHandler = ^(ODDynatraceHandle action, ODDynatraceNameId nameId, NSString *name, NSUInteger repeats) {
+        ODDynatrace *strongSelf = weakSelf;
+        NSString *valueName = [NSString stringWithFormat:@"%@ repeats", name ?: [strongSelf->_names nameForId:nameId]];
+        ODDynatraceEvent event = {
+            .type = ODDynatraceEventReportIntValue,
+            .handle = action,
+            .name = (__bridge CFStringRef)valueName,
+            .value.intValue = (int)MIN(repeats, INT_MAX),
+        };
+        [strongSelf dispatchEvent:&event];
+    };
+    return coalescer;
+}
+
+- (void)reportSummary:(const ODDynatraceHistogramSummary *)summary nameId:(ODDynatraceNameId)nameId
+{
+    ODDynatraceHandle action = [self enterActionWithNameId:nameId];
+    [self reportValueWithName:@"count" intValue:(int)MIN(summary->count, INT_MAX) action:action];
+    [self reportValueWithName:@"min" doubleValue:summary->min action:action];
+    [self reportValueWithName:@"max" doubleValue:summary->max action:action];
+    [self reportValueWithName:@"p50" doubleValue:summary->p50 action:action];
+    [self reportValueWithName:@"p90" doubleValue:summary->p90 action:action];
+    [self reportValueWithName:@"p99" doubleValue:summary->p99 action:action];
+    [self leaveAction:action];
+}
+
+- (void)logStartupStatus:(CPWR_StatusCode)statusCode
+{
+    if (statusCode == CPWR_UemOn) {
+        RCTLogInfo(@"Dynatrace startup status code = %@ (%@)",
+                   ODDynatraceStatusDescription(statusCode), ODDynatraceStatusName(statusCode));
+    } else {
+        RCTLogWarn(@"Dynatrace startup status code = %@ (%@)",
+                   ODDynatraceStatusDescription(statusCode), ODDynatraceStatusName(statusCode));
+    }
 }
 
 RCT_EXPORT_METHOD(shutdown)
 {
+    [self cancelDeferredStartup];
+    [_metrics report];
+    [_metrics invalidate];
+    [_telemetry invalidate];
+    [_screens invalidate];
+    [self drainEvents];
+    [_coalescer flush];
+    _coalescer = nil;
+    [_actions removeAllObjects];
+    [_actionTree removeAllActions];
+    [_webRequests removeAllObjects];
+    [_flushScheduler invalidate];
+    _flushScheduler = nil;
+    [_watchdog invalidate];
+    _watchdog = nil;
     [DynatraceUEM shutdown];
+    _started = NO;
+    self.requestTag = nil;
 }
 
-RCT_EXPORT_METHOD(enterAction:(NONNULL NSString *)actionName)
+// Sends the events collected by the ADK now, resolves with its status code
+RCT_EXPORT_METHOD(flush:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
 {
-    UEMAction *action = [UEMAction enterActionWithName: actionName];
-    //temporary leaving action directly
-    [action leaveAction];
+    [self drainEvents];
+    CPWR_StatusCode statusCode = _flushScheduler ? [_flushScheduler flush] : [DynatraceUEM flushEvents];
+    [_statusCounts countStatus:statusCode];
+    resolve(@(statusCode));
 }
 
-@end
+// Sends the ADK crash reports, complete or minimal. Resolves with the ADK status code.
+RCT_EXPORT_METHOD(enableCrashReporting:(BOOL)sendCrashReport
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    __block CPWR_StatusCode statusCode;
+    dispatch_sync(dispatch_get_main_queue(), ^{
+        statusCode = [DynatraceUEM enableCrashReportingWithReport:sendCrashReport];
+    });
+    [_statusCounts countStatus:statusCode];
+    resolve(@(statusCode));
+}
+
+// Resolves with the breadcrumbs of the previous launch, and whether it most likely crashed
+RCT_EXPORT_METHOD(getPreviousBreadcrumbs:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    NSMutableArray<NSDictionary *> *breadcrumbs = [NSMutableArray array];
+    for (NSDictionary *breadcrumb in _breadcrumbs.previousBreadcrumbs) {
+        [breadcrumbs addObject:@{
+            @"type": ODDynatraceEventTypeName([breadcrumb[@"type"] unsignedCharValue]) ?: @"unknown",
+            @"name": breadcrumb[@"name"],
+            @"timestamp": breadcrumb[@"timestamp"],
+        }];
+    }
+    resolve(@{
+        @"crashed": @(_breadcrumbs.previousLaunchCrashed),
+        @"breadcrumbs": breadcrumbs,
+    });
+}
+
+// Network type hint for the flush scheduler : "wifi", "cellular", "none" or "unknown"
+RCT_EXPORT_METHOD(setNetworkType:(NONNULL NSString *)networkType)
+{
+    _networkType = [networkType copy];
+    _flushScheduler.networkType = _networkType;
+}
+
+// Resolves with one result per record: the action handle for "enter" records,
+// the ADK status code for the others.
+RCT_EXPORT_METHOD(submitBatch:(NONNULL NSArray<NSDictionary *> *)records
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    // Events queued by native callers before this batch go first
+    [self drainEvents];
+
+    // At most one action per record, the table stays at most half full
+    size_t size = 2;
+    while (size < records.count * 2) {
+        size <<= 1;
+    }
+    ODDynatraceBatchActions batchActions = {
+        .entries = [_arena allocateZeroed:size * sizeof(ODDynatraceBatchAction)],
+        .mask = size - 1,
+    };
+
+    NSMutableArray<NSNumber *> *results = [NSMutableArray arrayWithCapacity:records.count];
+    NSUInteger bytes = 0;
+    for (NSDictionary *record in records) {
+        [results addObject:@([self dispatchRecord:record batchActions:&batchActions])];
+        bytes += ODDynatraceRecordSize(record);
+    }
+    [_telemetry recordBatch:records.count bytes:bytes];
+    for (size_t i = 0; i < size; i++) {
+        if (batchActions.entries[i].name) {
+            ODDynatraceEvent event = { .type = ODDynatraceEventLeaveAction, .handle = batchActions.entries[i].handle };
+            [self dispatchEvent:&event];
+        }
+    }
+    [_arena reset];
+    [_flushScheduler eventsReported:records.count];
+    [self refreshRequestTag];
+    resolve(results);
+}
+
+// Resolves with the id of each name, to use instead of the name in the other methods
+RCT_EXPORT_METHOD(registerNames:(NONNULL NSArray<NSString *> *)names
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    resolve([self registerNames:names]);
+}
+
+// Resolves with the header to add to the request and the handle of its timing
+RCT_EXPORT_METHOD(startWebRequest:(NONNULL NSString *)url
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    NSURL *requestURL = [NSURL URLWithString:url];
+    NSString *value = [DynatraceUEM getRequestTagValueForURL:requestURL];
+    ODDynatraceHandle handle = ODDynatraceInvalidHandle;
+    if (value) {
+        UEMWebRequestTiming *timing = [UEMWebRequestTiming getUEMWebRequestTiming:value requestUrl:requestURL];
+        if ([timing startWebRequestTiming] == CPWR_UemOn) {
+            handle = [_webRequests addObject:timing];
+        }
+    }
+    resolve(@{
+        @"handle": @(handle),
+        @"header": [DynatraceUEM getRequestTagHeader],
+        @"value": value ?: [NSNull null],
+    });
+}
+
+RCT_EXPORT_METHOD(stopWebRequest:(int)handle
+                  statusCode:(int)statusCode)
+{
+    UEMWebRequestTiming *timing = [_webRequests removeObjectForHandle:handle];
+    [timing stopWebRequestTiming:[NSString stringWithFormat:@"%d", statusCode]];
+}
+
+// Resolves with the header and value tagging requests to the current action, value is null before startup
+RCT_EXPORT_METHOD(getRequestTag:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    [self drainEvents];
+    resolve([self requestTagDictionary]);
+}
+
+// Snapshot of the module telemetry with the stats below, see README "Module stats"
+RCT_EXPORT_METHOD(getStats:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    resolve([self stats]);
+}
+
+RCT_EXPORT_METHOD(getEventBufferStats:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    resolve([self eventBufferStats]);
+}
+
+RCT_EXPORT_METHOD(getSpillLogStats:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    resolve([self spillLogStats]);
+}
+
+// Resolves with the number of results per status name since the module was created
+RCT_EXPORT_METHOD(getStatusCounts:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    resolve([_statusCounts dictionary]);
+}
+
+// Times in milliseconds spent waiting for the startup trigger, and in the ADK startup
+RCT_EXPORT_METHOD(getStartupStats:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    resolve([self startupStats]);
+}
+
+RCT_EXPORT_METHOD(getSamplingStats:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    resolve([self samplingStats]);
+}
+
+#pragma mark - Stats
+
+- (NSDictionary *)stats
+{
+    NSMutableDictionary *stats = [[_telemetry snapshot] mutableCopy];
+    stats[@"eventBuffer"] = [self eventBufferStats];
+    stats[@"spillLog"] = [self spillLogStats];
+    stats[@"sampling"] = [self samplingStats];
+    stats[@"startup"] = [self startupStats];
+    stats[@"statusCounts"] = [_statusCounts dictionary];
+    return stats;
+}
+
+- (NSDictionary *)eventBufferStats
+{
+    return @{
+        @"capacity": @(_events.capacity),
+        @"count": @(_events.count),
+        @"dropped": @(_events.droppedCount),
+        @"arenaBlocks": @(_arena.blockCount),
+    };
+}
+
+- (NSDictionary *)spillLogStats
+{
+    return @{
+        @"capacity": @(_spillLog.capacity),
+        @"size": @(_spillLog.size),
+        @"dropped": @(_spillLog.droppedCount),
+    };
+}
+
+- (NSDictionary *)startupStats
+{
+    return @{
+        @"statusCode": @(_startupStatus),
+        @"wait": @(_startupWait * 1000),
+        @"duration": @(_startupDuration * 1000),
+    };
+}
+
+- (NSDictionary *)samplingStats
+{
+    ODDynatraceSampler *sampler = self.sampler;
+    return @{
+        @"sampled": @(sampler.sampledCount),
+        @"rateLimited": @(sampler.rateLimitedCount),
+    };
+}
+
+#pragma mark - Synchronous API
+
+// Called directly on the JS thread without a bridge message when synchronous calls are available.
+// They only reserve a handle and queue an event, the ADK is called from the module queue.
+// The bridge only converts arguments of types known to RCTConvert, so handles and name ids are taken as int.
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(enterActionSync:(NONNULL NSString *)actionName
+                                       parentAction:(int)parentAction)
+{
+    return @([self enterActionWithName:actionName parentAction:parentAction]);
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(leaveActionSync:(int)action)
+{
+    [self leaveAction:action];
+    return @YES;
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(reportEventSync:(int)action
+                                       eventName:(NONNULL NSString *)eventName)
+{
+    [self reportEventWithName:eventName action:action];
+    return @YES;
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(reportIntValueSync:(int)action
+                                       valueName:(NONNULL NSString *)valueName
+                                       value:(int)value)
+{
+    [self reportValueWithName:valueName intValue:value action:action];
+    return @YES;
+}
 
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(reportDoubleValueSync:(int)action
+                                       valueName:(NONNULL NSString *)valueName
+                                       value:(double)value)
+{
+    [self reportValueWithName:valueName doubleValue:value action:action];
+    return @YES;
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(reportStringValueSync:(int)action
+                                       valueName:(NONNULL NSString *)valueName
+                                       value:(NONNULL NSString *)value)
+{
+    [self reportValueWithName:valueName stringValue:value action:action];
+    return @YES;
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(reportErrorSync:(int)action
+                                       errorName:(NONNULL NSString *)errorName
+                                       errorValue:(int)errorValue)
+{
+    [self reportErrorWithName:errorName errorValue:errorValue action:action];
+    return @YES;
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(recordValueSync:(NONNULL NSString *)name
+                                       value:(double)value)
+{
+    [self recordValue:value name:name];
+    return @YES;
+}
+
+// Last tag of the module queue, without waiting for the events still queued
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(getRequestTagSync)
+{
+    return [self requestTagDictionary];
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(registerNamesSync:(NONNULL NSArray<NSString *> *)names)
+{
+    return [self registerNames:names];
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(enterActionWithIdSync:(int)actionNameId
+                                       parentAction:(int)parentAction)
+{
+    return @([self enterActionWithNameId:actionNameId parentAction:parentAction]);
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(recordValueWithIdSync:(int)nameId
+                                       value:(double)value)
+{
+    [self recordValue:value nameId:nameId];
+    return @YES;
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(reportEventWithIdSync:(int)action
+                                       eventNameId:(int)eventNameId)
+{
+    [self reportEventWithNameId:eventNameId action:action];
+    return @YES;
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(reportIntValueWithIdSync:(int)action
+                                       valueNameId:(int)valueNameId
+                                       value:(int)value)
+{
+    [self reportValueWithNameId:valueNameId intValue:value action:action];
+    return @YES;
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(reportDoubleValueWithIdSync:(int)action
+                                       valueNameId:(int)valueNameId
+                                       value:(double)value)
+{
+    [self reportValueWithNameId:valueNameId doubleValue:value action:action];
+    return @YES;
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(reportErrorWithIdSync:(int)action
+                                       errorNameId:(int)errorNameId
+                                       errorValue:(int)errorValue)
+{
+    [self reportErrorWithNameId:errorNameId errorValue:errorValue action:action];
+    return @YES;
+}
+
+#pragma mark - Native API
+
+- (NSArray<NSNumber *> *)registerNames:(NSArray<NSString *> *)names
+{
+    NSMutableArray<NSNumber *> *nameIds = [NSMutableArray arrayWithCapacity:names.count];
+    for (NSString *name in names) {
+        [nameIds addObject:@([_names registerName:name])];
+    }
+    return nameIds;
+}
+
+- (ODDynatraceNameId)registerName:(NSString *)name
+{
+    return [_names registerName:name];
+}
+
+- (ODDynatraceHandle)enterActionWithName:(NSString *)actionName
+{
+    return [self enterActionWithName:actionName parentAction:ODDynatraceInvalidHandle];
+}
+
+- (ODDynatraceHandle)enterActionWithName:(NSString *)actionName parentAction:(ODDynatraceHandle)parentAction
+{
+    if (parentAction != ODDynatraceInvalidHandle && ![_actions containsHandle:parentAction]) {
+        return [self missingActionStatus:parentAction];
+    }
+    if ([self.sampler dropName:actionName]) {
+        return ODDynatraceInvalidHandle;
+    }
+    ODDynatraceHandle handle = [_actions reserveHandle];
+    if (handle != ODDynatraceInvalidHandle) {
+        [self pushEvent:(ODDynatraceEvent){
+            .type = ODDynatraceEventEnterAction,
+            .handle = handle,
+            .parent = parentAction,
+            .name = (CFStringRef)CFBridgingRetain([actionName copy]),
+        }];
+    }
+    return handle;
+}
+
+- (void)leaveAction:(ODDynatraceHandle)action
+{
+    [self pushEvent:(ODDynatraceEvent){ .type = ODDynatraceEventLeaveAction, .handle = action }];
+}
+
+- (void)reportEventWithName:(NSString *)eventName action:(ODDynatraceHandle)action
+{
+    [self pushEvent:(ODDynatraceEvent){
+        .type = ODDynatraceEventReportEvent,
+        .handle = action,
+        .name = (CFStringRef)CFBridgingRetain([eventName copy]),
+    }];
+}
+
+- (void)reportValueWithName:(NSString *)valueName intValue:(int)intValue action:(ODDynatraceHandle)action
+{
+    [self pushEvent:(ODDynatraceEvent){
+        .type = ODDynatraceEventReportIntValue,
+        .handle = action,
+        .name = (CFStringRef)CFBridgingRetain([valueName copy]),
+        .value.intValue = intValue,
+    }];
+}
+
+- (void)reportValueWithName:(NSString *)valueName doubleValue:(double)doubleValue action:(ODDynatraceHandle)action
+{
+    [self pushEvent:(ODDynatraceEvent){
+        .type = ODDynatraceEventReportDoubleValue,
+        .handle = action,
+        .name = (CFStringRef)CFBridgingRetain([valueName copy]),
+        .value.doubleValue = doubleValue,
+    }];
+}
+
+- (void)reportValueWithName:(NSString *)valueName stringValue:(NSString *)stringValue action:(ODDynatraceHandle)action
+{
+    [self pushEvent:(ODDynatraceEvent){
+        .type = ODDynatraceEventReportStringValue,
+        .handle = action,
+        .name = (CFStringRef)CFBridgingRetain([valueName copy]),
+        .value.stringValue = (CFStringRef)CFBridgingRetain([stringValue copy]),
+    }];
+}
+
+- (void)reportErrorWithName:(NSString *)errorName errorValue:(int)errorValue action:(ODDynatraceHandle)action
+{
+    [self pushEvent:(ODDynatraceEvent){
+        .type = ODDynatraceEventReportError,
+        .handle = action,
+        .name = (CFStringRef)CFBridgingRetain([errorName copy]),
+        .value.intValue = errorValue,
+    }];
+}
+
+- (void)recordValue:(double)value name:(NSString *)name
+{
+    [_metrics recordValue:value nameId:[_names registerName:name]];
+}
+
+- (void)recordValue:(double)value nameId:(ODDynatraceNameId)nameId
+{
+    [_metrics recordValue:value nameId:nameId];
+}
+
+- (ODDynatraceHandle)enterActionWithNameId:(ODDynatraceNameId)actionNameId
+{
+    return [self enterActionWithNameId:actionNameId parentAction:ODDynatraceInvalidHandle];
+}
+
+- (ODDynatraceHandle)enterActionWithNameId:(ODDynatraceNameId)actionNameId parentAction:(ODDynatraceHandle)parentAction
+{
+    if (parentAction != ODDynatraceInvalidHandle && ![_actions containsHandle:parentAction]) {
+        return [self missingActionStatus:parentAction];
+    }
+    if ([self.sampler dropName:[_names nameForId:actionNameId]]) {
+        return ODDynatraceInvalidHandle;
+    }
+    ODDynatraceHandle handle = [_actions reserveHandle];
+    if (handle != ODDynatraceInvalidHandle) {
+        [self pushEvent:(ODDynatraceEvent){
+            .type = ODDynatraceEventEnterAction,
+            .handle = handle,
+            .parent = parentAction,
+            .nameId = actionNameId,
+        }];
+    }
+    return handle;
+}
+
+- (void)reportEventWithNameId:(ODDynatraceNameId)eventNameId action:(ODDynatraceHandle)action
+{
+    [self pushEvent:(ODDynatraceEvent){
+        .type = ODDynatraceEventReportEvent,
+        .handle = action,
+        .nameId = eventNameId,
+    }];
+}
+
+- (void)reportValueWithNameId:(ODDynatraceNameId)valueNameId intValue:(int)intValue action:(ODDynatraceHandle)action
+{
+    [self pushEvent:(ODDynatraceEvent){
+        .type = ODDynatraceEventReportIntValue,
+        .handle = action,
+        .nameId = valueNameId,
+        .value.intValue = intValue,
+    }];
+}
+
+- (void)reportValueWithNameId:(ODDynatraceNameId)valueNameId doubleValue:(double)doubleValue action:(ODDynatraceHandle)action
+{
+    [self pushEvent:(ODDynatraceEvent){
+        .type = ODDynatraceEventReportDoubleValue,
+        .handle = action,
+        .nameId = valueNameId,
+        .value.doubleValue = doubleValue,
+    }];
+}
+
+- (void)reportErrorWithNameId:(ODDynatraceNameId)errorNameId errorValue:(int)errorValue action:(ODDynatraceHandle)action
+{
+    [self pushEvent:(ODDynatraceEvent){
+        .type = ODDynatraceEventReportError,
+        .handle = action,
+        .nameId = errorNameId,
+        .value.intValue = errorValue,
+    }];
+}
+
+#pragma mark - Event dispatch
+
+- (void)pushEvent:(ODDynatraceEvent)event
+{
+    if (event.type != ODDynatraceEventEnterAction && [self dropEvent:&event]) {
+        ODDynatraceEventRelease(&event);
+        return;
+    }
+    [_events push:&event];
+    if (!atomic_flag_test_and_set(&_drainScheduled)) {
+        dispatch_async(_methodQueue, ^{
+            atomic_flag_clear(&self->_drainScheduled);
+            [self drainEvents];
+        });
+    }
+}
+
+// Events of actions sampled out at enter are dropped with them, without being counted again
+- (BOOL)dropEvent:(const ODDynatraceEvent *)event
+{
+    if (event->handle == ODDynatraceInvalidHandle) {
+        return YES;
+    }
+    if (event->type == ODDynatraceEventLeaveAction) {
+        return NO;
+    }
+    NSString *name = event->name ? (__bridge NSString *)event->name : [_names nameForId:event->nameId];
+    return [self.sampler dropName:name];
+}
+
+// Single consumer of the event buffer, only called on the module queue
+- (void)drainEvents
+{
+    ODDynatraceEvent event;
+    NSUInteger count = 0;
+    while ([_events pop:&event]) {
+        [self dispatchEvent:&event];
+        ODDynatraceEventRelease(&event);
+        count++;
+    }
+    [_telemetry recordQueueDepth:count];
+    [_arena reset];
+    [_flushScheduler eventsReported:count];
+    [self refreshRequestTag];
+}
+
+- (int32_t)dispatchRecord:(NSDictionary *)record batchActions:(ODDynatraceBatchActions *)batchActions
+{
+    // Recorded values never reach the ADK one by one
+    if ([record[@"type"] isEqualToString:@"record"]) {
+        NSNumber *nameId = record[@"nameId"];
+        if (nameId) {
+            [self recordValue:[record[@"value"] doubleValue] nameId:nameId.unsignedIntValue];
+        } else {
+            [self recordValue:[record[@"value"] doubleValue] name:record[@"name"]];
+        }
+        return CPWR_UemOn;
+    }
+    if ([record[@"type"] isEqualToString:@"screen"]) {
+        return [self dispatchScreenRecord:record];
+    }
+
+    NSNumber *type = ODDynatraceEventTypes()[record[@"type"]];
+    if (!type) {
+        return CPWR_Error_InvalidParameter;
+    }
+
+    id value = record[@"value"];
+    ODDynatraceEvent event = {
+        .type = type.unsignedCharValue,
+        .parent = [record[@"parent"] intValue],
+        .nameId = [record[@"nameId"] unsignedIntValue],
+        .name = (__bridge CFStringRef)record[@"name"],
+    };
+    if (event.type == ODDynatraceEventEnterAction) {
+        NSString *actionName = record[@"name"] ?: [_names nameForId:event.nameId];
+        event.handle = [self.sampler dropName:actionName] ? ODDynatraceInvalidHandle : [_actions reserveHandle];
+    } else {
+        event.handle = [self handleForRecord:record batchActions:batchActions];
+        if (event.handle != ODDynatraceInvalidHandle && [self dropEvent:&event]) {
+            return CPWR_UemOff;
+        }
+    }
+    if (event.type == ODDynatraceEventReportDoubleValue) {
+        event.value.doubleValue = [value doubleValue];
+    } else if (event.type == ODDynatraceEventReportStringValue) {
+        event.value.stringValue = (__bridge CFStringRef)value;
+    } else {
+        event.value.intValue = [value intValue];
+    }
+    return [self dispatchEvent:&event];
+}
+
+// Screen marks only update the times of the screen, its action and values go through the buffer
+- (int32_t)dispatchScreenRecord:(NSDictionary *)record
+{
+    NSString *name = record[@"name"] ?: [_names nameForId:[record[@"nameId"] unsignedIntValue]];
+    NSString *mark = record[@"mark"];
+    if (!name) {
+        return CPWR_Error_InvalidParameter;
+    }
+    if ([mark isEqualToString:@"enter"]) {
+        [_screens enterScreen:name time:[record[@"time"] doubleValue]];
+    } else if ([mark isEqualToString:@"render"]) {
+        [_screens renderScreen:name time:[record[@"time"] doubleValue]];
+    } else if ([mark isEqualToString:@"exit"]) {
+        [_screens exitScreen:name];
+    } else {
+        return CPWR_Error_InvalidParameter;
+    }
+    return CPWR_UemOn;
+}
+
+- (ODDynatraceHandle)handleForRecord:(NSDictionary *)record batchActions:(ODDynatraceBatchActions *)batchActions
+{
+    NSNumber *handle = record[@"handle"];
+    if (handle) {
+        return handle.intValue;
+    }
+
+    // Records of the same batch reporting to the same action name share one action.
+    // The names are owned by the records until the end of the batch.
+    NSString *actionName = record[@"action"];
+    if (!actionName) {
+        return ODDynatraceInvalidHandle;
+    }
+    ODDynatraceBatchAction *batchAction = ODDynatraceBatchActionFind(batchActions, (__bridge CFStringRef)actionName);
+    if (!batchAction->name) {
+        ODDynatraceEvent event = {
+            .type = ODDynatraceEventEnterAction,
+            .name = (__bridge CFStringRef)actionName,
+        };
+        event.handle = [self.sampler dropName:actionName] ? ODDynatraceInvalidHandle : [_actions reserveHandle];
+        batchAction->name = (__bridge CFStringRef)actionName;
+        batchAction->handle = [self dispatchEvent:&event];
+    }
+    return batchAction->handle;
+}
+
+// Only place calling the ADK for actions. Returns the handle for enter events, the ADK status code otherwise.
+// Entered actions are counted as CPWR_UemOn, sampled out ones are not counted.
+- (int32_t)dispatchEvent:(const ODDynatraceEvent *)event
+{
+    // Repeats are only counted, see ODDynatraceCoalescer
+    if ([_coalescer coalesceEvent:event]) {
+        [_statusCounts countStatus:CPWR_UemOn];
+        return CPWR_UemOn;
+    }
+    // Written before calling the ADK, so a crash in the call keeps it
+    if (_breadcrumbs && event->handle != ODDynatraceInvalidHandle) {
+        [_breadcrumbs addBreadcrumb:event->type
+                               name:event->name ?: (__bridge CFStringRef)[_names nameForId:event->nameId]];
+    }
+    uint64_t start = ODDynatraceTelemetryNow();
+    int32_t result = [self performEvent:event];
+    [_telemetry recordEvent:event->type nanoseconds:ODDynatraceTelemetryNow() - start];
+    if (result == CPWR_UemOn) {
+        [_coalescer addEvent:event];
+    }
+    if (event->type == ODDynatraceEventEnterAction || event->type == ODDynatraceEventLeaveAction) {
+        _requestTagStale = YES;
+    }
+    if (event->type == ODDynatraceEventEnterAction && result > 0) {
+        [_statusCounts countStatus:CPWR_UemOn];
+    } else {
+        [_statusCounts countStatus:result];
+    }
+    return result;
+}
+
+// The tag depends on the innermost open action, it is asked again once per batch or drain having entered
+// or left actions. It is asked without URL, every request gets the same value.
+- (void)refreshRequestTag
+{
+    if (!_requestTagStale || !_started) {
+        return;
+    }
+    _requestTagStale = NO;
+    self.requestTag = [DynatraceUEM getRequestTagValueForURL:nil];
+}
+
+- (NSDictionary *)requestTagDictionary
+{
+    return @{
+        @"header": [DynatraceUEM getRequestTagHeader],
+        @"value": self.requestTag ?: [NSNull null],
+    };
+}
+
+- (int32_t)performEvent:(const ODDynatraceEvent *)event
+{
+    NSString *name = event->name ? (__bridge NSString *)event->name : [_names nameForId:event->nameId];
+    if (!_started) {
+        return [self spillEvent:event name:name];
+    }
+    if (event->type == ODDynatraceEventEnterAction) {
+        return [self dispatchEnterAction:event name:name];
+    }
+    if (event->type == ODDynatraceEventLeaveAction) {
+        return [self dispatchLeaveAction:event->handle];
+    }
+
+    UEMAction *action = [_actions objectForHandle:event->handle];
+    if (!action) {
+        return [self missingActionStatus:event->handle];
+    }
+    if (!name) {
+        return CPWR_Error_InvalidParameter;
+    }
+    switch (event->type) {
+        case ODDynatraceEventReportEvent:
+            return [action reportEventWithName:name];
+        case ODDynatraceEventReportIntValue:
+            return [action reportValueWithName:name intValue:event->value.intValue];
+        case ODDynatraceEventReportDoubleValue:
+            return [action reportValueWithName:name doubleValue:event->value.doubleValue];
+        case ODDynatraceEventReportStringValue:
+            return [action reportValueWithName:name stringValue:(__bridge NSString *)event->value.stringValue];
+        case ODDynatraceEventReportError:
+            return [action reportErrorWithName:name errorValue:event->value.intValue];
+        default:
+            return CPWR_Error_InvalidParameter;
+    }
+}
+
+- (int32_t)dispatchEnterAction:(const ODDynatraceEvent *)event name:(NSString *)name
+{
+    if (event->handle == ODDynatraceInvalidHandle) {
+        return ODDynatraceInvalidHandle;
+    }
+    UEMAction *parent = nil;
+    if (event->parent != ODDynatraceInvalidHandle) {
+        parent = [_actions objectForHandle:event->parent];
+        if (!parent) {
+            [_actions removeObjectForHandle:event->handle];
+            return [self missingActionStatus:event->parent];
+        }
+    }
+    if (!name) {
+        [_actions removeObjectForHandle:event->handle];
+        return CPWR_Error_InvalidParameter;
+    }
+    UEMAction *action = parent
+        ? [UEMAction enterActionWithName:name parentAction:parent]
+        : [UEMAction enterActionWithName:name];
+    if (!action) {
+        [_actions removeObjectForHandle:event->handle];
+        return ODDynatraceInvalidHandle;
+    }
+    [_actions setObject:action forHandle:event->handle];
+    [_actionTree addAction:event->handle parent:event->parent];
+    return event->handle;
+}
+
+// Children are left before their parent, deepest first, so none of them stays open in the table
+- (int32_t)dispatchLeaveAction:(ODDynatraceHandle)handle
+{
+    ODDynatraceHandle child;
+    while ((child = [_actionTree firstChildOf:handle]) != ODDynatraceInvalidHandle) {
+        [self dispatchLeaveAction:child];
+    }
+    [_coalescer flushAction:handle];
+    [_actionTree removeAction:handle];
+    UEMAction *action = [_actions removeObjectForHandle:handle];
+    return action ? [action leaveAction] : [self missingActionStatus:handle];
+}
+
+- (CPWR_StatusCode)missingActionStatus:(ODDynatraceHandle)handle
+{
+    return [_actions isStaleHandle:handle] ? CPWR_Error_ActionEnded : CPWR_Error_ActionNotFound;
+}
+
+#pragma mark - Spill log
+
+// Keeps the event until the ADK is started. The handle of a spilled enter stays reserved until the replay.
+- (int32_t)spillEvent:(const ODDynatraceEvent *)event name:(NSString *)name
+{
+    if (event->type == ODDynatraceEventEnterAction) {
+        if (event->handle == ODDynatraceInvalidHandle) {
+            return ODDynatraceInvalidHandle;
+        }
+        if (!name || ![_spillLog appendEvent:event name:name arena:_arena]) {
+            [_actions removeObjectForHandle:event->handle];
+            return ODDynatraceInvalidHandle;
+        }
+        return event->handle;
+    }
+    if (event->handle == ODDynatraceInvalidHandle) {
+        return CPWR_Error_ActionNotFound;
+    }
+    return [_spillLog appendEvent:event name:name ?: @"" arena:_arena] ? CPWR_UemOn : CPWR_Error_NotInitialized;
+}
+
+- (void)replaySpillLog
+{
+    // Handles written by a previous launch are remapped, and their actions still open left after the replay
+    NSMutableDictionary<NSNumber *, NSNumber *> *previousActions = [NSMutableDictionary dictionary];
+    [_spillLog replayEventsUsingBlock:^(ODDynatraceEvent *event, BOOL previousLaunch) {
+        if (previousLaunch) {
+            NSNumber *previousHandle = @(event->handle);
+            if (event->type == ODDynatraceEventEnterAction) {
+                event->handle = [self->_actions reserveHandle];
+                event->parent = previousActions[@(event->parent)].intValue;
+                previousActions[previousHandle] = @(event->handle);
+            } else {
+                event->handle = previousActions[previousHandle].intValue;
+                if (event->type == ODDynatraceEventLeaveAction) {
+                    [previousActions removeObjectForKey:previousHandle];
+                }
+            }
+        }
+        [self dispatchEvent:event];
+    }];
+    for (NSNumber *handle in previousActions.allValues) {
+        ODDynatraceEvent event = { .type = ODDynatraceEventLeaveAction, .handle = handle.intValue };
+        [self dispatchEvent:&event];
+    }
+}
+
+@end
@@ -0,0 +1,26 @@
+//
+//  ODDynatraceActionTree.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 22/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "ODDynatraceHandleTable.h"
+
+// Parent and child links of the open actions, stored in one array indexed like the handle table slots.
+// Not thread-safe, owned by the module queue.
+@interface ODDynatraceActionTree : NSObject
+
+- (void)addAction:(ODDynatraceHandle)action parent:(ODDynatraceHandle)parent;
+
+// Unlinks the action from its parent. Its children, if any, keep pointing to it.
+- (void)removeAction:(ODDynatraceHandle)action;
+
+// ODDynatraceInvalidHandle when the action has no child
+- (ODDynatraceHandle)firstChildOf:(ODDynatraceHandle)action;
+
+- (void)removeAllActions;
+
+@end
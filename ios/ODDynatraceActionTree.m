@@ -0,0 +1,98 @@
+//
+//  ODDynatraceActionTree.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 22/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceActionTree.h"
+
+// Children form a doubly linked list starting at their parent, so any node is unlinked in O(1)
+typedef struct {
+    ODDynatraceHandle action;
+    ODDynatraceHandle parent;
+    ODDynatraceHandle firstChild;
+    ODDynatraceHandle previousSibling;
+    ODDynatraceHandle nextSibling;
+} ODDynatraceActionNode;
+
+@implementation ODDynatraceActionTree
+{
+    ODDynatraceActionNode *_nodes;
+    NSUInteger _capacity;
+}
+
+- (void)dealloc
+{
+    free(_nodes);
+}
+
+// The node of a handle, NULL when the slot holds another action
+- (ODDynatraceActionNode *)nodeOf:(ODDynatraceHandle)action
+{
+    NSUInteger index = action & 0xFFFF;
+    if (action == ODDynatraceInvalidHandle || index >= _capacity || _nodes[index].action != action) {
+        return NULL;
+    }
+    return &_nodes[index];
+}
+
+- (void)addAction:(ODDynatraceHandle)action parent:(ODDynatraceHandle)parent
+{
+    NSUInteger index = action & 0xFFFF;
+    if (index >= _capacity) {
+        NSUInteger capacity = MAX(_capacity, 64);
+        while (capacity <= index) {
+            capacity *= 2;
+        }
+        _nodes = realloc(_nodes, capacity * sizeof(ODDynatraceActionNode));
+        memset(_nodes + _capacity, 0, (capacity - _capacity) * sizeof(ODDynatraceActionNode));
+        _capacity = capacity;
+    }
+
+    ODDynatraceActionNode *parentNode = [self nodeOf:parent];
+    _nodes[index] = (ODDynatraceActionNode){ .action = action };
+    if (parentNode) {
+        ODDynatraceActionNode *siblingNode = [self nodeOf:parentNode->firstChild];
+        if (siblingNode) {
+            siblingNode->previousSibling = action;
+        }
+        _nodes[index].parent = parent;
+        _nodes[index].nextSibling = parentNode->firstChild;
+        parentNode->firstChild = action;
+    }
+}
+
+- (void)removeAction:(ODDynatraceHandle)action
+{
+    ODDynatraceActionNode *node = [self nodeOf:action];
+    if (!node) {
+        return;
+    }
+    ODDynatraceActionNode *previousNode = [self nodeOf:node->previousSibling];
+    ODDynatraceActionNode *nextNode = [self nodeOf:node->nextSibling];
+    ODDynatraceActionNode *parentNode = [self nodeOf:node->parent];
+    if (previousNode) {
+        previousNode->nextSibling = node->nextSibling;
+    } else if (parentNode) {
+        parentNode->firstChild = node->nextSibling;
+    }
+    if (nextNode) {
+        nextNode->previousSibling = node->previousSibling;
+    }
+    *node = (ODDynatraceActionNode){ 0 };
+}
+
+- (ODDynatraceHandle)firstChildOf:(ODDynatraceHandle)action
+{
+    ODDynatraceActionNode *node = [self nodeOf:action];
+    return node ? node->firstChild : ODDynatraceInvalidHandle;
+}
+
+- (void)removeAllActions
+{
+    memset(_nodes, 0, _capacity * sizeof(ODDynatraceActionNode));
+}
+
+@end
@@ -0,0 +1,33 @@
+//
+//  ODDynatraceArena.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 20/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// Bump allocator for the scratch memory of one batch. Nothing is freed individually :
+// reset makes all the memory available again for the next batch, keeping its blocks,
+// so a steady flow of batches stops calling malloc. Not thread-safe, owned by the module queue.
+@interface ODDynatraceArena : NSObject
+
+- (nonnull instancetype)initWithBlockSize:(size_t)blockSize;
+
+// Number of blocks allocated since the arena was created
+@property (nonatomic, readonly) NSUInteger blockCount;
+@property (nonatomic, readonly) size_t usedSize;
+
+// 8-byte aligned memory, valid until the next reset
+- (nonnull void *)allocate:(size_t)size;
+
+// Zero-filled variant
+- (nonnull void *)allocateZeroed:(size_t)size;
+
+// UTF-8 bytes of the string, without copy when CoreFoundation already has them
+- (nonnull const char *)UTF8StringOf:(nonnull CFStringRef)string length:(nonnull size_t *)length;
+
+- (void)reset;
+
+@end
@@ -0,0 +1,112 @@
+//
+//  ODDynatraceArena.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 20/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceArena.h"
+
+typedef struct {
+    uint8_t *bytes;
+    size_t size;
+} ODDynatraceArenaBlock;
+
+@implementation ODDynatraceArena
+{
+    size_t _blockSize;
+    ODDynatraceArenaBlock *_blocks;
+    NSUInteger _blocksCapacity;
+    NSUInteger _currentBlock;
+    size_t _offset;
+    size_t _usedBefore;
+}
+
+- (instancetype)init
+{
+    return [self initWithBlockSize:16 * 1024];
+}
+
+- (instancetype)initWithBlockSize:(size_t)blockSize
+{
+    if ((self = [super init])) {
+        _blockSize = blockSize;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    for (NSUInteger i = 0; i < _blockCount; i++) {
+        free(_blocks[i].bytes);
+    }
+    free(_blocks);
+}
+
+- (size_t)usedSize
+{
+    return _usedBefore + _offset;
+}
+
+- (void *)allocate:(size_t)size
+{
+    size = (size + 7) & ~(size_t)7;
+    while (_currentBlock < _blockCount && _offset + size > _blocks[_currentBlock].size) {
+        // Blocks are kept in order, the end of a block too small is wasted until the next reset
+        _usedBefore += _blocks[_currentBlock].size;
+        _currentBlock++;
+        _offset = 0;
+    }
+    if (_currentBlock == _blockCount) {
+        [self addBlockOfSize:MAX(size, _blockSize)];
+    }
+    void *memory = _blocks[_currentBlock].bytes + _offset;
+    _offset += size;
+    return memory;
+}
+
+- (void *)allocateZeroed:(size_t)size
+{
+    void *memory = [self allocate:size];
+    memset(memory, 0, size);
+    return memory;
+}
+
+- (const char *)UTF8StringOf:(CFStringRef)string length:(size_t *)length
+{
+    const char *bytes = CFStringGetCStringPtr(string, kCFStringEncodingUTF8);
+    if (bytes) {
+        *length = strlen(bytes);
+        return bytes;
+    }
+    CFIndex characters = CFStringGetLength(string);
+    CFIndex capacity = CFStringGetMaximumSizeForEncoding(characters, kCFStringEncodingUTF8) + 1;
+    char *buffer = [self allocate:(size_t)capacity];
+    CFIndex used = 0;
+    CFStringGetBytes(string, CFRangeMake(0, characters), kCFStringEncodingUTF8, 0, false,
+                     (UInt8 *)buffer, capacity - 1, &used);
+    buffer[used] = '\0';
+    *length = (size_t)used;
+    return buffer;
+}
+
+- (void)reset
+{
+    _currentBlock = 0;
+    _offset = 0;
+    _usedBefore = 0;
+}
+
+- (void)addBlockOfSize:(size_t)size
+{
+    if (_blockCount == _blocksCapacity) {
+        _blocksCapacity = MAX(_blocksCapacity * 2, 4);
+        _blocks = realloc(_blocks, _blocksCapacity * sizeof(ODDynatraceArenaBlock));
+    }
+    _blocks[_blockCount].bytes = malloc(size);
+    _blocks[_blockCount].size = size;
+    _blockCount++;
+}
+
+@end
@@ -0,0 +1,35 @@
+//
+//  ODDynatraceBreadcrumbs.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 02/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "ODDynatraceEventBuffer.h"
+
+// Last events recorded through the module, kept in a memory-mapped ring of fixed size slots so they
+// are still on disk after a crash. Adding one neither locks nor allocates, only plain stores into
+// memory mapped at init, from any thread. The breadcrumbs of the previous launch are read at init,
+// so one instance is shared by the modules of all the bridges of the process.
+@interface ODDynatraceBreadcrumbs : NSObject
+
+// Returns nil when the file can't be mapped
+- (nullable instancetype)initWithPath:(nonnull NSString *)path capacity:(NSUInteger)capacity;
+
+@property (nonatomic, readonly) NSUInteger capacity;
+
+// YES when the previous launch ended while active in the foreground, most likely a crash
+@property (nonatomic, readonly) BOOL previousLaunchCrashed;
+
+// YES for the first caller only when the previous launch crashed, so its breadcrumbs are reported once
+- (BOOL)claimPreviousLaunchCrash;
+
+// Oldest first, @{ @"type": @(ODDynatraceEventType), @"name": NSString, @"timestamp": ms since 1970 }
+@property (nonatomic, readonly, nonnull) NSArray<NSDictionary *> *previousBreadcrumbs;
+
+// Names are truncated to 45 UTF-8 bytes
+- (void)addBreadcrumb:(ODDynatraceEventType)type name:(nullable CFStringRef)name;
+
+@end
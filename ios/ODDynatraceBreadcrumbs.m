@@ -0,0 +1,178 @@
+//
+//  ODDynatraceBreadcrumbs.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 02/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceBreadcrumbs.h"
+
+#import <UIKit/UIKit.h>
+#import <fcntl.h>
+#import <stdatomic.h>
+#import <sys/mman.h>
+#import <time.h>
+#import <unistd.h>
+
+static const uint32_t ODDynatraceBreadcrumbsMagic = 0x4342444f; // "ODBC"
+static const uint32_t ODDynatraceBreadcrumbsVersion = 1;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    // Set while the application is active, cleared when it goes to the background or terminates
+    volatile uint32_t active;
+} ODDynatraceBreadcrumbsHeader;
+
+// One cache line per breadcrumb. The sequence is 0 while the slot is written, readers skip it.
+typedef struct {
+    _Atomic uint64_t sequence;
+    uint64_t timestamp;
+    uint8_t type;
+    uint8_t length;
+    char name[46];
+} ODDynatraceBreadcrumb;
+
+@implementation ODDynatraceBreadcrumbs
+{
+    int _fd;
+    size_t _size;
+    ODDynatraceBreadcrumbsHeader *_header;
+    ODDynatraceBreadcrumb *_slots;
+    atomic_uint_fast64_t _next;
+    atomic_flag _claimedCrash;
+    NSArray<id> *_observers;
+}
+
+- (instancetype)initWithPath:(NSString *)path capacity:(NSUInteger)capacity
+{
+    if ((self = [super init])) {
+        _capacity = MAX(capacity, 1);
+        _size = sizeof(ODDynatraceBreadcrumbsHeader) + _capacity * sizeof(ODDynatraceBreadcrumb);
+        _fd = open(path.fileSystemRepresentation, O_RDWR | O_CREAT, 0600);
+        if (_fd < 0) {
+            return nil;
+        }
+        if (ftruncate(_fd, (off_t)_size) != 0) {
+            close(_fd);
+            _fd = -1;
+            return nil;
+        }
+        void *bytes = mmap(NULL, _size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+        if (bytes == MAP_FAILED) {
+            close(_fd);
+            _fd = -1;
+            return nil;
+        }
+        _header = bytes;
+        _slots = (ODDynatraceBreadcrumb *)(_header + 1);
+        atomic_init(&_next, 0);
+        atomic_flag_clear(&_claimedCrash);
+
+        if (_header->magic == ODDynatraceBreadcrumbsMagic
+            && _header->version == ODDynatraceBreadcrumbsVersion
+            && _header->capacity == _capacity) {
+            _previousLaunchCrashed = _header->active != 0;
+            _previousBreadcrumbs = [self readBreadcrumbs];
+        } else {
+            _previousBreadcrumbs = @[];
+        }
+        memset(_slots, 0, _capacity * sizeof(ODDynatraceBreadcrumb));
+        _header->magic = ODDynatraceBreadcrumbsMagic;
+        _header->version = ODDynatraceBreadcrumbsVersion;
+        _header->capacity = (uint32_t)_capacity;
+        _header->active = 0;
+        [self observeApplicationState];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    for (id observer in _observers) {
+        [[NSNotificationCenter defaultCenter] removeObserver:observer];
+    }
+    if (_header) {
+        munmap(_header, _size);
+    }
+    if (_fd >= 0) {
+        close(_fd);
+    }
+}
+
+- (BOOL)claimPreviousLaunchCrash
+{
+    return _previousLaunchCrashed && !atomic_flag_test_and_set(&_claimedCrash);
+}
+
+// Only launches ending while active count as crashes, the system kills suspended applications routinely
+- (void)observeApplicationState
+{
+    ODDynatraceBreadcrumbsHeader *header = _header;
+    NSNotificationCenter *center = [NSNotificationCenter defaultCenter];
+    void (^setActive)(NSNotification *) = ^(NSNotification *notification) {
+        header->active = 1;
+    };
+    void (^setInactive)(NSNotification *) = ^(NSNotification *notification) {
+        header->active = 0;
+    };
+    _observers = @[
+        [center addObserverForName:UIApplicationDidBecomeActiveNotification object:nil queue:nil usingBlock:setActive],
+        [center addObserverForName:UIApplicationDidEnterBackgroundNotification object:nil queue:nil usingBlock:setInactive],
+        [center addObserverForName:UIApplicationWillTerminateNotification object:nil queue:nil usingBlock:setInactive],
+    ];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        if ([UIApplication sharedApplication].applicationState == UIApplicationStateActive) {
+            header->active = 1;
+        }
+    });
+}
+
+- (NSArray<NSDictionary *> *)readBreadcrumbs
+{
+    // Slots are written in turn, the oldest one follows the last written
+    uint64_t lastSequence = 0;
+    for (NSUInteger i = 0; i < _capacity; i++) {
+        lastSequence = MAX(lastSequence, atomic_load_explicit(&_slots[i].sequence, memory_order_acquire));
+    }
+    NSMutableArray<NSDictionary *> *breadcrumbs = [NSMutableArray arrayWithCapacity:_capacity];
+    for (NSUInteger i = 0; i < _capacity; i++) {
+        ODDynatraceBreadcrumb *slot = &_slots[(lastSequence + i) % _capacity];
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) == 0) {
+            continue;
+        }
+        NSString *name = [[NSString alloc] initWithBytes:slot->name
+                                                  length:MIN(slot->length, sizeof(slot->name))
+                                                encoding:NSUTF8StringEncoding];
+        [breadcrumbs addObject:@{
+            @"type": @(slot->type),
+            @"name": name ?: @"",
+            @"timestamp": @(slot->timestamp),
+        }];
+    }
+    return breadcrumbs;
+}
+
+- (void)addBreadcrumb:(ODDynatraceEventType)type name:(CFStringRef)name
+{
+    uint64_t index = atomic_fetch_add_explicit(&_next, 1, memory_order_relaxed);
+    ODDynatraceBreadcrumb *slot = &_slots[index % _capacity];
+    atomic_store_explicit(&slot->sequence, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    slot->timestamp = (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+    slot->type = type;
+    CFIndex length = 0;
+    if (name) {
+        CFStringGetBytes(name, CFRangeMake(0, CFStringGetLength(name)), kCFStringEncodingUTF8, '?', false,
+                         (UInt8 *)slot->name, sizeof(slot->name) - 1, &length);
+    }
+    slot->length = (uint8_t)length;
+    atomic_store_explicit(&slot->sequence, index + 1, memory_order_release);
+}
+
+@end
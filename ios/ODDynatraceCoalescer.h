@@ -0,0 +1,40 @@
+//
+//  ODDynatraceCoalescer.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 08/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "ODDynatraceEventBuffer.h"
+
+// Merges the reportEvent calls repeating an event of the same action within a time window : the first one
+// is reported, the repeats are only counted. When the window ends, or before the action is left, an entry
+// having repeats is passed to the repeat handler, reported as one "<name> repeats" value.
+// Entries live in a fixed-size direct mapped table keyed by action and name, an event colliding with another
+// entry ends it early. Only used from the module queue.
+@interface ODDynatraceCoalescer : NSObject
+
+// window in seconds
+- (nonnull instancetype)initWithCapacity:(NSUInteger)capacity
+                                  window:(NSTimeInterval)window
+                                   queue:(nonnull dispatch_queue_t)queue;
+
+// Called synchronously, name is nil when the event was reported with a name id
+@property (nonatomic, copy, nullable) void (^repeatHandler)(ODDynatraceHandle action, ODDynatraceNameId nameId,
+                                                            NSString * _Nullable name, NSUInteger repeats);
+
+// YES when the event repeats one reported in the window, and must not be reported again
+- (BOOL)coalesceEvent:(nonnull const ODDynatraceEvent *)event;
+
+// Starts the window of a reported event
+- (void)addEvent:(nonnull const ODDynatraceEvent *)event;
+
+// Ends the entries of the action, before it is left
+- (void)flushAction:(ODDynatraceHandle)action;
+
+// Ends all entries
+- (void)flush;
+
+@end
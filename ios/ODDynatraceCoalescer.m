@@ -0,0 +1,172 @@
+//
+//  ODDynatraceCoalescer.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 08/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceCoalescer.h"
+#import "ODDynatraceTelemetry.h"
+
+typedef struct {
+    ODDynatraceHandle action;
+    ODDynatraceNameId nameId;
+    CFStringRef name;
+    uint64_t startTime;
+    NSUInteger repeats;
+} ODDynatraceCoalescerEntry;
+
+// splitmix64 finalizer, close handles and ids land in distant slots
+static uint64_t ODDynatraceCoalescerMix(uint64_t key)
+{
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return key ^ (key >> 31);
+}
+
+@implementation ODDynatraceCoalescer
+{
+    ODDynatraceCoalescerEntry *_entries;
+    NSUInteger _mask;
+    NSUInteger _count;
+    uint64_t _window;
+    dispatch_queue_t _queue;
+    BOOL _expiryScheduled;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity window:(NSTimeInterval)window queue:(dispatch_queue_t)queue
+{
+    if ((self = [super init])) {
+        NSUInteger size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        _entries = calloc(size, sizeof(ODDynatraceCoalescerEntry));
+        _mask = size - 1;
+        _window = (uint64_t)(window * NSEC_PER_SEC);
+        _queue = queue;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    for (NSUInteger i = 0; i <= _mask; i++) {
+        if (_entries[i].name) {
+            CFRelease(_entries[i].name);
+        }
+    }
+    free(_entries);
+}
+
+- (ODDynatraceCoalescerEntry *)entryForEvent:(const ODDynatraceEvent *)event
+{
+    uint64_t nameHash = event->nameId != ODDynatraceInvalidNameId ? event->nameId : CFHash(event->name);
+    uint64_t key = ODDynatraceCoalescerMix(((uint64_t)(uint32_t)event->handle << 32) ^ nameHash);
+    return &_entries[key & _mask];
+}
+
+static BOOL ODDynatraceCoalescerEntryMatches(const ODDynatraceCoalescerEntry *entry, const ODDynatraceEvent *event)
+{
+    if (entry->action != event->handle || entry->nameId != event->nameId) {
+        return NO;
+    }
+    return entry->nameId != ODDynatraceInvalidNameId || (entry->name && event->name && CFEqual(entry->name, event->name));
+}
+
+- (BOOL)coalesceEvent:(const ODDynatraceEvent *)event
+{
+    if (event->type != ODDynatraceEventReportEvent || (event->nameId == ODDynatraceInvalidNameId && !event->name)) {
+        return NO;
+    }
+    ODDynatraceCoalescerEntry *entry = [self entryForEvent:event];
+    if (entry->action == ODDynatraceInvalidHandle || !ODDynatraceCoalescerEntryMatches(entry, event)) {
+        return NO;
+    }
+    if (ODDynatraceTelemetryNow() - entry->startTime >= _window) {
+        [self endEntry:entry];
+        return NO;
+    }
+    entry->repeats++;
+    return YES;
+}
+
+- (void)addEvent:(const ODDynatraceEvent *)event
+{
+    if (event->type != ODDynatraceEventReportEvent || (event->nameId == ODDynatraceInvalidNameId && !event->name)) {
+        return;
+    }
+    ODDynatraceCoalescerEntry *entry = [self entryForEvent:event];
+    [self endEntry:entry];
+    entry->action = event->handle;
+    entry->nameId = event->nameId;
+    entry->name = event->nameId == ODDynatraceInvalidNameId ? CFRetain(event->name) : NULL;
+    entry->startTime = ODDynatraceTelemetryNow();
+    entry->repeats = 0;
+    _count++;
+    [self scheduleExpiry];
+}
+
+- (void)flushAction:(ODDynatraceHandle)action
+{
+    if (_count == 0) {
+        return;
+    }
+    for (NSUInteger i = 0; i <= _mask; i++) {
+        if (_entries[i].action == action) {
+            [self endEntry:&_entries[i]];
+        }
+    }
+}
+
+- (void)flush
+{
+    for (NSUInteger i = 0; i <= _mask && _count > 0; i++) {
+        [self endEntry:&_entries[i]];
+    }
+}
+
+- (void)endEntry:(ODDynatraceCoalescerEntry *)entry
+{
+    if (entry->action == ODDynatraceInvalidHandle) {
+        return;
+    }
+    if (entry->repeats > 0 && _repeatHandler) {
+        _repeatHandler(entry->action, entry->nameId, (__bridge NSString *)entry->name, entry->repeats);
+    }
+    if (entry->name) {
+        CFRelease(entry->name);
+    }
+    *entry = (ODDynatraceCoalescerEntry){ 0 };
+    _count--;
+}
+
+// Ends the expired entries once per window while the table has entries
+- (void)scheduleExpiry
+{
+    if (_expiryScheduled) {
+        return;
+    }
+    _expiryScheduled = YES;
+    __weak ODDynatraceCoalescer *weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)_window), _queue, ^{
+        [weakSelf endExpiredEntries];
+    });
+}
+
+- (void)endExpiredEntries
+{
+    _expiryScheduled = NO;
+    uint64_t now = ODDynatraceTelemetryNow();
+    for (NSUInteger i = 0; i <= _mask; i++) {
+        if (_entries[i].action != ODDynatraceInvalidHandle && now - _entries[i].startTime >= _window) {
+            [self endEntry:&_entries[i]];
+        }
+    }
+    if (_count > 0) {
+        [self scheduleExpiry];
+    }
+}
+
+@end
@@ -0,0 +1,73 @@
+//
+//  ODDynatraceEventBuffer.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 27/11/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "ODDynatraceHandleTable.h"
+#import "ODDynatraceNameTable.h"
+
+typedef NS_ENUM(uint8_t, ODDynatraceEventType) {
+    ODDynatraceEventEnterAction,
+    ODDynatraceEventLeaveAction,
+    ODDynatraceEventReportEvent,
+    ODDynatraceEventReportIntValue,
+    ODDynatraceEventReportDoubleValue,
+    ODDynatraceEventReportStringValue,
+    ODDynatraceEventReportError,
+};
+
+enum { ODDynatraceEventTypeCount = ODDynatraceEventReportError + 1 };
+
+typedef NS_ENUM(NSInteger, ODDynatraceOverflowPolicy) {
+    ODDynatraceOverflowPolicyDropNewest,
+    ODDynatraceOverflowPolicyDropOldest,
+};
+
+// Fixed-size record of one instrumentation call. The name is either an interned name id,
+// or a string retained by the producer and released by whoever consumes or drops the event.
+// The parent is only used by enter events, ODDynatraceInvalidHandle for root actions.
+typedef struct {
+    ODDynatraceEventType type;
+    ODDynatraceHandle handle;
+    ODDynatraceHandle parent;
+    ODDynatraceNameId nameId;
+    CFStringRef name;
+    union {
+        int intValue;
+        double doubleValue;
+        CFStringRef stringValue;
+    } value;
+} ODDynatraceEvent;
+
+FOUNDATION_EXPORT void ODDynatraceEventRelease(ODDynatraceEvent *event);
+
+// Type of the batch records, e.g. "enter" or "intValue"
+FOUNDATION_EXPORT NSString *ODDynatraceEventTypeName(ODDynatraceEventType type);
+
+// Bounded lock-free queue of events. Any thread can push, events are popped by a single consumer.
+// When full, the overflow policy drops either the pushed event or the oldest queued one.
+@interface ODDynatraceEventBuffer : NSObject
+
+// The capacity is rounded up to a power of two
+- (nonnull instancetype)initWithCapacity:(NSUInteger)capacity
+                          overflowPolicy:(ODDynatraceOverflowPolicy)overflowPolicy;
+
+@property (nonatomic, readonly) NSUInteger capacity;
+@property (nonatomic, readonly) ODDynatraceOverflowPolicy overflowPolicy;
+@property (nonatomic, readonly) uint64_t droppedCount;
+@property (nonatomic, readonly) NSUInteger count;
+
+// Called with each dropped event before its strings are released, on the pushing thread
+@property (nonatomic, copy, nullable) void (^dropHandler)(const ODDynatraceEvent *_Nonnull event);
+
+// Takes ownership of the event strings. Returns NO when the event was dropped.
+- (BOOL)push:(ODDynatraceEvent *_Nonnull)event;
+
+// Ownership of the event strings moves to the caller
+- (BOOL)pop:(ODDynatraceEvent *_Nonnull)event;
+
+@end
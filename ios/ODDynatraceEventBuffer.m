@@ -0,0 +1,170 @@
+//
+//  ODDynatraceEventBuffer.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 27/11/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceEventBuffer.h"
+
+#import <stdatomic.h>
+
+typedef struct {
+    atomic_size_t sequence;
+    ODDynatraceEvent event;
+} ODDynatraceEventSlot;
+
+void ODDynatraceEventRelease(ODDynatraceEvent *event)
+{
+    if (event->name) {
+        CFRelease(event->name);
+        event->name = NULL;
+    }
+    if (event->type == ODDynatraceEventReportStringValue && event->value.stringValue) {
+        CFRelease(event->value.stringValue);
+        event->value.stringValue = NULL;
+    }
+}
+
+NSString *ODDynatraceEventTypeName(ODDynatraceEventType type)
+{
+    static NSString * const names[ODDynatraceEventTypeCount] = {
+        @"enter", @"leave", @"event", @"intValue", @"doubleValue", @"stringValue", @"error",
+    };
+    return type < ODDynatraceEventTypeCount ? names[type] : nil;
+}
+
+// Bounded queue from Dmitry Vyukov: every slot carries a sequence number telling
+// producers and consumers whose turn it is, so claiming a slot is a single CAS.
+@implementation ODDynatraceEventBuffer
+{
+    ODDynatraceEventSlot *_slots;
+    size_t _mask;
+    atomic_size_t _enqueuePosition;
+    atomic_size_t _dequeuePosition;
+    atomic_uint_fast64_t _droppedCount;
+}
+
+- (instancetype)init
+{
+    return [self initWithCapacity:1024 overflowPolicy:ODDynatraceOverflowPolicyDropNewest];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity overflowPolicy:(ODDynatraceOverflowPolicy)overflowPolicy
+{
+    if ((self = [super init])) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        _capacity = size;
+        _mask = size - 1;
+        _overflowPolicy = overflowPolicy;
+        _slots = calloc(size, sizeof(ODDynatraceEventSlot));
+        for (size_t i = 0; i < size; i++) {
+            atomic_init(&_slots[i].sequence, i);
+        }
+        atomic_init(&_enqueuePosition, 0);
+        atomic_init(&_dequeuePosition, 0);
+        atomic_init(&_droppedCount, 0);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    ODDynatraceEvent event;
+    while ([self pop:&event]) {
+        ODDynatraceEventRelease(&event);
+    }
+    free(_slots);
+}
+
+- (uint64_t)droppedCount
+{
+    return atomic_load_explicit(&_droppedCount, memory_order_relaxed);
+}
+
+- (NSUInteger)count
+{
+    size_t enqueuePosition = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+    size_t dequeuePosition = atomic_load_explicit(&_dequeuePosition, memory_order_relaxed);
+    return enqueuePosition > dequeuePosition ? enqueuePosition - dequeuePosition : 0;
+}
+
+- (BOOL)push:(ODDynatraceEvent *)event
+{
+    while (![self tryPush:event]) {
+        if (_overflowPolicy == ODDynatraceOverflowPolicyDropNewest) {
+            [self drop:event];
+            return NO;
+        }
+        ODDynatraceEvent oldest;
+        if ([self pop:&oldest]) {
+            [self drop:&oldest];
+        }
+    }
+    return YES;
+}
+
+- (void)drop:(ODDynatraceEvent *)event
+{
+    atomic_fetch_add_explicit(&_droppedCount, 1, memory_order_relaxed);
+    void (^dropHandler)(const ODDynatraceEvent *) = self.dropHandler;
+    if (dropHandler) {
+        dropHandler(event);
+    }
+    ODDynatraceEventRelease(event);
+}
+
+- (BOOL)tryPush:(const ODDynatraceEvent *)event
+{
+    size_t position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+    ODDynatraceEventSlot *slot;
+    for (;;) {
+        slot = &_slots[position & _mask];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&_enqueuePosition, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            return NO;
+        } else {
+            position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+        }
+    }
+    slot->event = *event;
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+    return YES;
+}
+
+// Dropping the oldest event makes producers dequeue too, hence the CAS on the dequeue position
+- (BOOL)pop:(ODDynatraceEvent *)event
+{
+    size_t position = atomic_load_explicit(&_dequeuePosition, memory_order_relaxed);
+    ODDynatraceEventSlot *slot;
+    for (;;) {
+        slot = &_slots[position & _mask];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&_dequeuePosition, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            return NO;
+        } else {
+            position = atomic_load_explicit(&_dequeuePosition, memory_order_relaxed);
+        }
+    }
+    *event = slot->event;
+    atomic_store_explicit(&slot->sequence, position + _mask + 1, memory_order_release);
+    return YES;
+}
+
+@end
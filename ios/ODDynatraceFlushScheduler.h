@@ -0,0 +1,33 @@
+//
+//  ODDynatraceFlushScheduler.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 13/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "DynatraceUEM.h"
+
+// Calls flushEvents instead of waiting for the ADK to send its packages (up to 9 minutes old),
+// from the startup options :
+//  - flushEventCount : flush once this many events have been reported
+//  - flushMaxAge, cellularFlushMaxAge : flush once the oldest event is this old, in seconds
+//  - flushMinInterval : seconds between two automatic flushes, doubled after each failed flush
+//  - flushOnBackground : flush when the application goes to the background
+// All disabled by default. Only used from the module queue.
+@interface ODDynatraceFlushScheduler : NSObject
+
+- (nonnull instancetype)initWithOptions:(nullable NSDictionary *)options queue:(nonnull dispatch_queue_t)queue;
+
+// "wifi", "cellular", "none" or "unknown". No automatic flush happens without network.
+@property (nonatomic, copy, nonnull) NSString *networkType;
+
+- (void)eventsReported:(NSUInteger)count;
+
+// Flushes now whatever the policies
+- (CPWR_StatusCode)flush;
+
+- (void)invalidate;
+
+@end
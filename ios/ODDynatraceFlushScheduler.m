@@ -0,0 +1,165 @@
+//
+//  ODDynatraceFlushScheduler.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 13/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceFlushScheduler.h"
+
+#import <UIKit/UIKit.h>
+
+static const NSTimeInterval ODDynatraceFlushMaxBackoff = 600;
+
+@implementation ODDynatraceFlushScheduler
+{
+    dispatch_queue_t _queue;
+    dispatch_source_t _timer;
+    id _backgroundObserver;
+
+    NSUInteger _flushEventCount;
+    NSTimeInterval _flushMaxAge;
+    NSTimeInterval _cellularFlushMaxAge;
+    NSTimeInterval _flushMinInterval;
+
+    NSUInteger _pendingCount;
+    NSTimeInterval _oldestPendingTime;
+    NSTimeInterval _backoff;
+    NSTimeInterval _nextFlushTime;
+}
+
+- (instancetype)initWithOptions:(NSDictionary *)options queue:(dispatch_queue_t)queue
+{
+    if ((self = [super init])) {
+        _queue = queue;
+        _networkType = @"unknown";
+        _flushEventCount = [options[@"flushEventCount"] unsignedIntegerValue];
+        _flushMaxAge = [options[@"flushMaxAge"] doubleValue];
+        _cellularFlushMaxAge = options[@"cellularFlushMaxAge"] ? [options[@"cellularFlushMaxAge"] doubleValue] : _flushMaxAge;
+        _flushMinInterval = options[@"flushMinInterval"] ? [options[@"flushMinInterval"] doubleValue] : 10;
+
+        _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, queue);
+        __weak ODDynatraceFlushScheduler *weakSelf = self;
+        dispatch_source_set_event_handler(_timer, ^{
+            [weakSelf flushIfDue];
+        });
+        dispatch_source_set_timer(_timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        dispatch_resume(_timer);
+
+        if ([options[@"flushOnBackground"] boolValue]) {
+            _backgroundObserver = [[NSNotificationCenter defaultCenter]
+                                   addObserverForName:UIApplicationDidEnterBackgroundNotification
+                                   object:nil
+                                   queue:nil
+                                   usingBlock:^(NSNotification *notification) {
+                                       dispatch_async(queue, ^{
+                                           [weakSelf flushIfPending];
+                                       });
+                                   }];
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [self invalidate];
+}
+
+- (void)invalidate
+{
+    if (_backgroundObserver) {
+        [[NSNotificationCenter defaultCenter] removeObserver:_backgroundObserver];
+        _backgroundObserver = nil;
+    }
+    if (_timer) {
+        dispatch_source_cancel(_timer);
+        _timer = nil;
+    }
+}
+
+- (void)setNetworkType:(NSString *)networkType
+{
+    _networkType = [networkType copy];
+    [self schedule];
+}
+
+- (void)eventsReported:(NSUInteger)count
+{
+    if (count == 0) {
+        return;
+    }
+    if (_pendingCount == 0) {
+        _oldestPendingTime = [NSProcessInfo processInfo].systemUptime;
+    }
+    _pendingCount += count;
+    [self schedule];
+}
+
+- (CPWR_StatusCode)flush
+{
+    CPWR_StatusCode statusCode = [DynatraceUEM flushEvents];
+    NSTimeInterval now = [NSProcessInfo processInfo].systemUptime;
+    if (statusCode == CPWR_UemOn) {
+        _pendingCount = 0;
+        _backoff = 0;
+        _nextFlushTime = now + _flushMinInterval;
+    } else {
+        _backoff = MIN(MAX(_backoff * 2, _flushMinInterval), ODDynatraceFlushMaxBackoff);
+        _nextFlushTime = now + _backoff;
+    }
+    [self schedule];
+    return statusCode;
+}
+
+- (void)flushIfPending
+{
+    if (_pendingCount > 0) {
+        [self flush];
+    }
+}
+
+- (void)flushIfDue
+{
+    if (_pendingCount > 0 && [NSProcessInfo processInfo].systemUptime >= [self dueTime]) {
+        [self flush];
+    } else {
+        [self schedule];
+    }
+}
+
+- (NSTimeInterval)dueTime
+{
+    if (_pendingCount == 0 || [_networkType isEqualToString:@"none"]) {
+        return INFINITY;
+    }
+    NSTimeInterval dueTime = INFINITY;
+    if (_flushEventCount > 0 && _pendingCount >= _flushEventCount) {
+        dueTime = 0;
+    }
+    NSTimeInterval maxAge = [_networkType isEqualToString:@"cellular"] ? _cellularFlushMaxAge : _flushMaxAge;
+    if (maxAge > 0) {
+        dueTime = MIN(dueTime, _oldestPendingTime + maxAge);
+    }
+    return MAX(dueTime, _nextFlushTime);
+}
+
+- (void)schedule
+{
+    if (!_timer) {
+        return;
+    }
+    NSTimeInterval dueTime = [self dueTime];
+    if (isinf(dueTime)) {
+        dispatch_source_set_timer(_timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        return;
+    }
+    NSTimeInterval delay = MAX(dueTime - [NSProcessInfo processInfo].systemUptime, 0);
+    dispatch_source_set_timer(_timer,
+                              dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)),
+                              DISPATCH_TIME_FOREVER,
+                              (uint64_t)(NSEC_PER_SEC / 10));
+}
+
+@end
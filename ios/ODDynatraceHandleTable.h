@@ -0,0 +1,44 @@
+//
+//  ODDynatraceHandleTable.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 22/11/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// Small integer standing for a native object on the JS side.
+// The low 16 bits are the slot index, the next 15 bits the slot generation.
+typedef int32_t ODDynatraceHandle;
+
+static const ODDynatraceHandle ODDynatraceInvalidHandle = 0;
+
+// Slot map giving O(1) handle lookups. Removing an object bumps the slot generation,
+// so a handle kept after its object was removed is detected as stale instead of
+// resolving to the next object stored in the same slot. Safe to use from any thread.
+@interface ODDynatraceHandleTable<ObjectType> : NSObject
+
+- (nonnull instancetype)initWithCapacity:(NSUInteger)capacity;
+
+// Returns ODDynatraceInvalidHandle when the table is full
+- (ODDynatraceHandle)addObject:(nonnull ObjectType)object;
+
+// Hands out a handle before its object exists, objectForHandle: returns nil until it is set
+- (ODDynatraceHandle)reserveHandle;
+
+- (void)setObject:(nonnull ObjectType)object forHandle:(ODDynatraceHandle)handle;
+
+- (nullable ObjectType)objectForHandle:(ODDynatraceHandle)handle;
+
+// YES for reserved handles too
+- (BOOL)containsHandle:(ODDynatraceHandle)handle;
+
+// YES when the handle was handed out by the table and its object removed since
+- (BOOL)isStaleHandle:(ODDynatraceHandle)handle;
+
+- (nullable ObjectType)removeObjectForHandle:(ODDynatraceHandle)handle;
+
+- (void)removeAllObjects;
+
+@end
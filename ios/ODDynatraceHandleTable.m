@@ -0,0 +1,192 @@
+//
+//  ODDynatraceHandleTable.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 22/11/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceHandleTable.h"
+
+#import <pthread.h>
+
+static const NSUInteger ODDynatraceHandleTableMaxCount = 0xFFFF;
+static const uint16_t ODDynatraceHandleMaxGeneration = 0x7FFF;
+
+static inline NSUInteger ODDynatraceHandleIndex(ODDynatraceHandle handle)
+{
+    return handle & 0xFFFF;
+}
+
+static inline uint16_t ODDynatraceHandleGeneration(ODDynatraceHandle handle)
+{
+    return (handle >> 16) & ODDynatraceHandleMaxGeneration;
+}
+
+static inline ODDynatraceHandle ODDynatraceMakeHandle(NSUInteger index, uint16_t generation)
+{
+    return (ODDynatraceHandle)(((uint32_t)generation << 16) | (uint32_t)index);
+}
+
+static NSObject *ODDynatraceFreeSlot;
+
+@implementation ODDynatraceHandleTable
+{
+    NSMutableArray *_objects;
+    uint16_t *_generations;
+    uint16_t *_freeIndexes;
+    NSUInteger _freeCount;
+    NSUInteger _capacity;
+    pthread_mutex_t _lock;
+}
+
++ (void)initialize
+{
+    if (self == [ODDynatraceHandleTable class]) {
+        ODDynatraceFreeSlot = [NSObject new];
+    }
+}
+
+- (instancetype)init
+{
+    return [self initWithCapacity:64];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+{
+    if ((self = [super init])) {
+        _capacity = MAX(MIN(capacity, ODDynatraceHandleTableMaxCount), 1);
+        _objects = [NSMutableArray arrayWithCapacity:_capacity];
+        _generations = calloc(_capacity, sizeof(uint16_t));
+        _freeIndexes = calloc(_capacity, sizeof(uint16_t));
+        pthread_mutex_init(&_lock, NULL);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_generations);
+    free(_freeIndexes);
+    pthread_mutex_destroy(&_lock);
+}
+
+- (ODDynatraceHandle)addObject:(id)object
+{
+    pthread_mutex_lock(&_lock);
+    ODDynatraceHandle handle = [self insertObject:object];
+    pthread_mutex_unlock(&_lock);
+    return handle;
+}
+
+- (ODDynatraceHandle)reserveHandle
+{
+    return [self addObject:[NSNull null]];
+}
+
+- (void)setObject:(id)object forHandle:(ODDynatraceHandle)handle
+{
+    pthread_mutex_lock(&_lock);
+    NSUInteger index = ODDynatraceHandleIndex(handle);
+    if ([self isLiveHandle:handle]) {
+        _objects[index] = object;
+    }
+    pthread_mutex_unlock(&_lock);
+}
+
+- (id)objectForHandle:(ODDynatraceHandle)handle
+{
+    pthread_mutex_lock(&_lock);
+    id object = [self isLiveHandle:handle] ? _objects[ODDynatraceHandleIndex(handle)] : nil;
+    pthread_mutex_unlock(&_lock);
+    return object == [NSNull null] ? nil : object;
+}
+
+- (BOOL)containsHandle:(ODDynatraceHandle)handle
+{
+    pthread_mutex_lock(&_lock);
+    BOOL contains = [self isLiveHandle:handle];
+    pthread_mutex_unlock(&_lock);
+    return contains;
+}
+
+- (BOOL)isStaleHandle:(ODDynatraceHandle)handle
+{
+    pthread_mutex_lock(&_lock);
+    NSUInteger index = ODDynatraceHandleIndex(handle);
+    BOOL stale = index < _objects.count
+        && ODDynatraceHandleGeneration(handle) != 0
+        && ![self isLiveHandle:handle];
+    pthread_mutex_unlock(&_lock);
+    return stale;
+}
+
+- (id)removeObjectForHandle:(ODDynatraceHandle)handle
+{
+    pthread_mutex_lock(&_lock);
+    id object = nil;
+    if ([self isLiveHandle:handle]) {
+        object = _objects[ODDynatraceHandleIndex(handle)];
+        [self freeIndex:ODDynatraceHandleIndex(handle)];
+    }
+    pthread_mutex_unlock(&_lock);
+    return object == [NSNull null] ? nil : object;
+}
+
+- (void)removeAllObjects
+{
+    pthread_mutex_lock(&_lock);
+    for (NSUInteger index = 0; index < _objects.count; index++) {
+        if ([self isLiveHandle:ODDynatraceMakeHandle(index, _generations[index])]) {
+            [self freeIndex:index];
+        }
+    }
+    pthread_mutex_unlock(&_lock);
+}
+
+#pragma mark - Locked helpers
+
+- (ODDynatraceHandle)insertObject:(id)object
+{
+    NSUInteger index;
+    if (_freeCount > 0) {
+        index = _freeIndexes[--_freeCount];
+        _objects[index] = object;
+    } else {
+        index = _objects.count;
+        if (index >= ODDynatraceHandleTableMaxCount) {
+            return ODDynatraceInvalidHandle;
+        }
+        if (index == _capacity) {
+            [self grow];
+        }
+        [_objects addObject:object];
+        _generations[index] = 1;
+    }
+    return ODDynatraceMakeHandle(index, _generations[index]);
+}
+
+// Reserved slots hold NSNull until their object is set
+- (BOOL)isLiveHandle:(ODDynatraceHandle)handle
+{
+    NSUInteger index = ODDynatraceHandleIndex(handle);
+    return index < _objects.count
+        && _generations[index] == ODDynatraceHandleGeneration(handle)
+        && _objects[index] != ODDynatraceFreeSlot;
+}
+
+- (void)freeIndex:(NSUInteger)index
+{
+    _objects[index] = ODDynatraceFreeSlot;
+    _generations[index] = _generations[index] == ODDynatraceHandleMaxGeneration ? 1 : _generations[index] + 1;
+    _freeIndexes[_freeCount++] = (uint16_t)index;
+}
+
+- (void)grow
+{
+    _capacity = MIN(_capacity * 2, ODDynatraceHandleTableMaxCount);
+    _generations = realloc(_generations, _capacity * sizeof(uint16_t));
+    _freeIndexes = realloc(_freeIndexes, _capacity * sizeof(uint16_t));
+}
+
+@end
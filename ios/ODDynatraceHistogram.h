@@ -0,0 +1,39 @@
+//
+//  ODDynatraceHistogram.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 29/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// Log-linear histogram of positive values in fixed memory : 8 linear buckets per power of 2
+// from 2^-10 to 2^30, so percentiles are within 12.5% of the recorded values. Values out of
+// the range go to the first or last bucket. Recording is lock-free from any thread.
+// Histograms with the same buckets merge by adding their bucket counts.
+typedef struct ODDynatraceHistogram ODDynatraceHistogram;
+
+typedef struct {
+    uint64_t count;
+    double min;
+    double max;
+    double p50;
+    double p90;
+    double p95;
+    double p99;
+} ODDynatraceHistogramSummary;
+
+FOUNDATION_EXPORT ODDynatraceHistogram * _Nonnull ODDynatraceHistogramCreate(void);
+
+FOUNDATION_EXPORT void ODDynatraceHistogramDestroy(ODDynatraceHistogram * _Nonnull histogram);
+
+FOUNDATION_EXPORT void ODDynatraceHistogramRecord(ODDynatraceHistogram * _Nonnull histogram, double value);
+
+// Adds the values of from into into, and resets from
+FOUNDATION_EXPORT void ODDynatraceHistogramMerge(ODDynatraceHistogram * _Nonnull into, ODDynatraceHistogram * _Nonnull from);
+
+// Summarizes and resets the histogram. Returns NO when nothing was recorded since the last summary.
+// Values recorded concurrently land in this summary or the next one.
+FOUNDATION_EXPORT BOOL ODDynatraceHistogramSummarize(ODDynatraceHistogram * _Nonnull histogram,
+                                                     ODDynatraceHistogramSummary * _Nonnull summary);
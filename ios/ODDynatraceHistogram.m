@@ -0,0 +1,183 @@
+//
+//  ODDynatraceHistogram.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 29/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceHistogram.h"
+
+#import <math.h>
+#import <stdatomic.h>
+
+enum {
+    ODDynatraceHistogramSubBuckets = 8,
+    ODDynatraceHistogramMinExponent = -10,
+    ODDynatraceHistogramMaxExponent = 30,
+    ODDynatraceHistogramBucketCount = (ODDynatraceHistogramMaxExponent - ODDynatraceHistogramMinExponent)
+        * ODDynatraceHistogramSubBuckets,
+};
+
+// min and max are kept as the bits of doubles to be updated with compare and swap
+struct ODDynatraceHistogram {
+    atomic_uint buckets[ODDynatraceHistogramBucketCount];
+    atomic_uint_fast64_t count;
+    atomic_uint_fast64_t min;
+    atomic_uint_fast64_t max;
+};
+
+static uint64_t ODDynatraceHistogramBits(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double ODDynatraceHistogramValue(uint64_t bits)
+{
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// The exponent picks the power of 2, the mantissa the linear bucket inside it
+static int ODDynatraceHistogramBucket(double value)
+{
+    if (!(value > 0)) {
+        return 0;
+    }
+    int exponent;
+    double mantissa = frexp(value, &exponent);
+    int bucket = (exponent - 1 - ODDynatraceHistogramMinExponent) * ODDynatraceHistogramSubBuckets
+        + (int)((mantissa * 2 - 1) * ODDynatraceHistogramSubBuckets);
+    return MAX(0, MIN(bucket, ODDynatraceHistogramBucketCount - 1));
+}
+
+static double ODDynatraceHistogramBucketLowerBound(int bucket)
+{
+    int exponent = bucket / ODDynatraceHistogramSubBuckets + ODDynatraceHistogramMinExponent;
+    int subBucket = bucket % ODDynatraceHistogramSubBuckets;
+    return ldexp(1 + (double)subBucket / ODDynatraceHistogramSubBuckets, exponent);
+}
+
+static void ODDynatraceHistogramReset(ODDynatraceHistogram *histogram)
+{
+    atomic_store_explicit(&histogram->min, ODDynatraceHistogramBits(INFINITY), memory_order_relaxed);
+    atomic_store_explicit(&histogram->max, ODDynatraceHistogramBits(-INFINITY), memory_order_relaxed);
+}
+
+static void ODDynatraceHistogramUpdateMin(ODDynatraceHistogram *histogram, double value)
+{
+    uint64_t current = atomic_load_explicit(&histogram->min, memory_order_relaxed);
+    while (value < ODDynatraceHistogramValue(current)
+           && !atomic_compare_exchange_weak_explicit(&histogram->min, &current, ODDynatraceHistogramBits(value),
+                                                     memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static void ODDynatraceHistogramUpdateMax(ODDynatraceHistogram *histogram, double value)
+{
+    uint64_t current = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    while (value > ODDynatraceHistogramValue(current)
+           && !atomic_compare_exchange_weak_explicit(&histogram->max, &current, ODDynatraceHistogramBits(value),
+                                                     memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+ODDynatraceHistogram *ODDynatraceHistogramCreate(void)
+{
+    ODDynatraceHistogram *histogram = calloc(1, sizeof(ODDynatraceHistogram));
+    ODDynatraceHistogramReset(histogram);
+    return histogram;
+}
+
+void ODDynatraceHistogramDestroy(ODDynatraceHistogram *histogram)
+{
+    free(histogram);
+}
+
+void ODDynatraceHistogramRecord(ODDynatraceHistogram *histogram, double value)
+{
+    atomic_fetch_add_explicit(&histogram->buckets[ODDynatraceHistogramBucket(value)], 1, memory_order_relaxed);
+    ODDynatraceHistogramUpdateMin(histogram, value);
+    ODDynatraceHistogramUpdateMax(histogram, value);
+    atomic_fetch_add_explicit(&histogram->count, 1, memory_order_release);
+}
+
+void ODDynatraceHistogramMerge(ODDynatraceHistogram *into, ODDynatraceHistogram *from)
+{
+    uint64_t count = atomic_exchange_explicit(&from->count, 0, memory_order_acquire);
+    if (count == 0) {
+        return;
+    }
+    for (int bucket = 0; bucket < ODDynatraceHistogramBucketCount; bucket++) {
+        unsigned int bucketCount = atomic_exchange_explicit(&from->buckets[bucket], 0, memory_order_relaxed);
+        if (bucketCount > 0) {
+            atomic_fetch_add_explicit(&into->buckets[bucket], bucketCount, memory_order_relaxed);
+        }
+    }
+    ODDynatraceHistogramUpdateMin(into, ODDynatraceHistogramValue(atomic_exchange_explicit(&from->min, ODDynatraceHistogramBits(INFINITY), memory_order_relaxed)));
+    ODDynatraceHistogramUpdateMax(into, ODDynatraceHistogramValue(atomic_exchange_explicit(&from->max, ODDynatraceHistogramBits(-INFINITY), memory_order_relaxed)));
+    atomic_fetch_add_explicit(&into->count, count, memory_order_release);
+}
+
+BOOL ODDynatraceHistogramSummarize(ODDynatraceHistogram *histogram, ODDynatraceHistogramSummary *summary)
+{
+    if (atomic_load_explicit(&histogram->count, memory_order_acquire) == 0) {
+        return NO;
+    }
+
+    // Moved into a local histogram first, the percentiles are then computed from a stable copy.
+    // The count is taken from the buckets, a value being recorded may not have bumped both yet.
+    ODDynatraceHistogram snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    ODDynatraceHistogramReset(&snapshot);
+    ODDynatraceHistogramMerge(&snapshot, histogram);
+
+    uint64_t count = 0;
+    int firstBucket = -1;
+    int lastBucket = -1;
+    for (int bucket = 0; bucket < ODDynatraceHistogramBucketCount; bucket++) {
+        unsigned int bucketCount = atomic_load_explicit(&snapshot.buckets[bucket], memory_order_relaxed);
+        if (bucketCount > 0) {
+            count += bucketCount;
+            firstBucket = firstBucket < 0 ? bucket : firstBucket;
+            lastBucket = bucket;
+        }
+    }
+    if (count == 0) {
+        return NO;
+    }
+    double min = ODDynatraceHistogramValue(atomic_load_explicit(&snapshot.min, memory_order_relaxed));
+    double max = ODDynatraceHistogramValue(atomic_load_explicit(&snapshot.max, memory_order_relaxed));
+    if (isinf(min)) {
+        min = ODDynatraceHistogramBucketLowerBound(firstBucket);
+    }
+    if (isinf(max)) {
+        max = ODDynatraceHistogramBucketLowerBound(lastBucket + 1);
+    }
+
+    // Upper bound of the bucket holding the percentile, within the recorded range
+    const double percentiles[] = { 0.5, 0.9, 0.95, 0.99 };
+    double values[4];
+    int percentile = 0;
+    uint64_t cumulated = 0;
+    for (int bucket = firstBucket; bucket <= lastBucket; bucket++) {
+        cumulated += atomic_load_explicit(&snapshot.buckets[bucket], memory_order_relaxed);
+        while (percentile < 4 && cumulated >= (uint64_t)ceil(percentiles[percentile] * count)) {
+            values[percentile++] = MAX(min, MIN(ODDynatraceHistogramBucketLowerBound(bucket + 1), max));
+        }
+    }
+
+    *summary = (ODDynatraceHistogramSummary){
+        .count = count,
+        .min = min,
+        .max = max,
+        .p50 = values[0],
+        .p90 = values[1],
+        .p95 = values[2],
+        .p99 = values[3],
+    };
+    return YES;
+}
@@ -0,0 +1,33 @@
+//
+//  ODDynatraceMetrics.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 29/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "ODDynatraceHistogram.h"
+#import "ODDynatraceNameTable.h"
+
+// One histogram per registered name, created on the first recorded value. Recording is lock-free
+// from any thread. The summaries are reported every metricsReportInterval seconds (startup option,
+// 60 by default) on the module queue.
+@interface ODDynatraceMetrics : NSObject
+
+- (nonnull instancetype)initWithCapacity:(NSUInteger)capacity;
+
+- (void)recordValue:(double)value nameId:(ODDynatraceNameId)nameId;
+
+// Called for each name having values since the last report
+@property (nonatomic, copy, nullable) void (^reportHandler)(ODDynatraceNameId nameId,
+                                                            const ODDynatraceHistogramSummary * _Nonnull summary);
+
+- (void)startWithOptions:(nullable NSDictionary *)options queue:(nonnull dispatch_queue_t)queue;
+
+// Reports now, on the module queue
+- (void)report;
+
+- (void)invalidate;
+
+@end
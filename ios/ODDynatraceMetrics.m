@@ -0,0 +1,99 @@
+//
+//  ODDynatraceMetrics.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 29/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceMetrics.h"
+
+#import <stdatomic.h>
+
+// Histograms are never freed before the metrics, so a recorder only needs to win the creation race once
+@implementation ODDynatraceMetrics
+{
+    _Atomic(ODDynatraceHistogram *) *_histograms;
+    NSUInteger _capacity;
+    dispatch_source_t _timer;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+{
+    if ((self = [super init])) {
+        _capacity = capacity;
+        _histograms = calloc(capacity, sizeof(*_histograms));
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [self invalidate];
+    for (NSUInteger i = 0; i < _capacity; i++) {
+        ODDynatraceHistogram *histogram = atomic_load_explicit(&_histograms[i], memory_order_relaxed);
+        if (histogram) {
+            ODDynatraceHistogramDestroy(histogram);
+        }
+    }
+    free(_histograms);
+}
+
+- (void)recordValue:(double)value nameId:(ODDynatraceNameId)nameId
+{
+    if (nameId == ODDynatraceInvalidNameId || nameId > _capacity) {
+        return;
+    }
+    _Atomic(ODDynatraceHistogram *) *slot = &_histograms[nameId - 1];
+    ODDynatraceHistogram *histogram = atomic_load_explicit(slot, memory_order_acquire);
+    if (!histogram) {
+        ODDynatraceHistogram *created = ODDynatraceHistogramCreate();
+        if (atomic_compare_exchange_strong_explicit(slot, &histogram, created,
+                                                    memory_order_acq_rel, memory_order_acquire)) {
+            histogram = created;
+        } else {
+            ODDynatraceHistogramDestroy(created);
+        }
+    }
+    ODDynatraceHistogramRecord(histogram, value);
+}
+
+- (void)startWithOptions:(NSDictionary *)options queue:(dispatch_queue_t)queue
+{
+    [self invalidate];
+    NSTimeInterval interval = options[@"metricsReportInterval"] ? [options[@"metricsReportInterval"] doubleValue] : 60;
+    if (interval <= 0) {
+        return;
+    }
+    _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, queue);
+    __weak ODDynatraceMetrics *weakSelf = self;
+    dispatch_source_set_event_handler(_timer, ^{
+        [weakSelf report];
+    });
+    dispatch_source_set_timer(_timer,
+                              dispatch_time(DISPATCH_TIME_NOW, (int64_t)(interval * NSEC_PER_SEC)),
+                              (uint64_t)(interval * NSEC_PER_SEC),
+                              (uint64_t)(NSEC_PER_SEC));
+    dispatch_resume(_timer);
+}
+
+- (void)invalidate
+{
+    if (_timer) {
+        dispatch_source_cancel(_timer);
+        _timer = nil;
+    }
+}
+
+- (void)report
+{
+    ODDynatraceHistogramSummary summary;
+    for (NSUInteger i = 0; i < _capacity; i++) {
+        ODDynatraceHistogram *histogram = atomic_load_explicit(&_histograms[i], memory_order_acquire);
+        if (histogram && ODDynatraceHistogramSummarize(histogram, &summary) && _reportHandler) {
+            _reportHandler((ODDynatraceNameId)(i + 1), &summary);
+        }
+    }
+}
+
+@end
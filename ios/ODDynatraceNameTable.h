@@ -0,0 +1,28 @@
+//
+//  ODDynatraceNameTable.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 04/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+typedef uint32_t ODDynatraceNameId;
+
+static const ODDynatraceNameId ODDynatraceInvalidNameId = 0;
+
+// Interned action, event and value names. Registering a name is locked and done once,
+// looking a name up by id afterwards is lock-free and allocation-free, from any thread.
+@interface ODDynatraceNameTable : NSObject
+
+- (nonnull instancetype)initWithCapacity:(NSUInteger)capacity;
+
+@property (nonatomic, readonly) NSUInteger count;
+
+// Returns the existing id of an already registered name, ODDynatraceInvalidNameId when the table is full
+- (ODDynatraceNameId)registerName:(nonnull NSString *)name;
+
+- (nullable NSString *)nameForId:(ODDynatraceNameId)nameId;
+
+@end
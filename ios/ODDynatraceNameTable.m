@@ -0,0 +1,83 @@
+//
+//  ODDynatraceNameTable.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 04/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceNameTable.h"
+
+#import <pthread.h>
+#import <stdatomic.h>
+
+// Names are never removed and the storage never moves, so a reader only needs
+// to see the count published after the name it looks up.
+@implementation ODDynatraceNameTable
+{
+    CFStringRef *_names;
+    NSUInteger _capacity;
+    atomic_uint _count;
+    NSMutableDictionary<NSString *, NSNumber *> *_ids;
+    pthread_mutex_t _lock;
+}
+
+- (instancetype)init
+{
+    return [self initWithCapacity:4096];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+{
+    if ((self = [super init])) {
+        _capacity = capacity;
+        _names = calloc(capacity, sizeof(CFStringRef));
+        _ids = [NSMutableDictionary dictionaryWithCapacity:capacity];
+        atomic_init(&_count, 0);
+        pthread_mutex_init(&_lock, NULL);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    unsigned int count = atomic_load(&_count);
+    for (unsigned int i = 0; i < count; i++) {
+        CFRelease(_names[i]);
+    }
+    free(_names);
+    pthread_mutex_destroy(&_lock);
+}
+
+- (NSUInteger)count
+{
+    return atomic_load_explicit(&_count, memory_order_acquire);
+}
+
+- (ODDynatraceNameId)registerName:(NSString *)name
+{
+    pthread_mutex_lock(&_lock);
+    ODDynatraceNameId nameId = [_ids[name] unsignedIntValue];
+    if (nameId == ODDynatraceInvalidNameId) {
+        unsigned int count = atomic_load_explicit(&_count, memory_order_relaxed);
+        if (count < _capacity) {
+            NSString *interned = [name copy];
+            _names[count] = (CFStringRef)CFBridgingRetain(interned);
+            nameId = count + 1;
+            _ids[interned] = @(nameId);
+            atomic_store_explicit(&_count, count + 1, memory_order_release);
+        }
+    }
+    pthread_mutex_unlock(&_lock);
+    return nameId;
+}
+
+- (NSString *)nameForId:(ODDynatraceNameId)nameId
+{
+    if (nameId == ODDynatraceInvalidNameId || nameId > atomic_load_explicit(&_count, memory_order_acquire)) {
+        return nil;
+    }
+    return (__bridge NSString *)_names[nameId - 1];
+}
+
+@end
@@ -0,0 +1,51 @@
+//
+//  ODDynatraceRecord.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 18/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "ODDynatraceEventBuffer.h"
+
+// Binary layout of an event, little-endian, same as ODDynatraceRecord.java :
+//   0  u32 length          whole record, header included
+//   4  u8  version
+//   5  u8  type
+//   6  u16 name length
+//   8  i32 handle
+//  12  u32 name id
+//  16  u32 writer          id of the process which wrote the record
+//  20  u32 string length
+//  24  u64 timestamp       ms since 1970
+//  32  u64 value           int or double, parent handle of enter events
+//  40  UTF-8 name, then UTF-8 string value
+static const uint8_t ODDynatraceRecordVersion = 1;
+static const size_t ODDynatraceRecordHeaderLength = 40;
+
+// Decoded record. The name and string value point into the decoded buffer.
+typedef struct {
+    ODDynatraceEventType type;
+    ODDynatraceHandle handle;
+    ODDynatraceNameId nameId;
+    uint32_t writer;
+    uint64_t timestamp;
+    const uint8_t *name;
+    uint16_t nameLength;
+    const uint8_t *stringValue;
+    uint32_t stringLength;
+    union {
+        int intValue;
+        double doubleValue;
+    } value;
+} ODDynatraceRecord;
+
+FOUNDATION_EXPORT size_t ODDynatraceRecordLength(const ODDynatraceRecord *record);
+
+// Writes the record into the buffer. Returns its length, 0 when it does not fit.
+FOUNDATION_EXPORT size_t ODDynatraceRecordEncode(const ODDynatraceRecord *record, uint8_t *buffer, size_t capacity);
+
+// Reads the record at the start of the buffer in place. Returns its length,
+// 0 when the buffer is truncated or the record has an unknown version.
+FOUNDATION_EXPORT size_t ODDynatraceRecordDecode(const uint8_t *buffer, size_t length, ODDynatraceRecord *record);
@@ -0,0 +1,79 @@
+//
+//  ODDynatraceRecord.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 18/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceRecord.h"
+
+#import <libkern/OSByteOrder.h>
+
+size_t ODDynatraceRecordLength(const ODDynatraceRecord *record)
+{
+    return ODDynatraceRecordHeaderLength + record->nameLength + record->stringLength;
+}
+
+size_t ODDynatraceRecordEncode(const ODDynatraceRecord *record, uint8_t *buffer, size_t capacity)
+{
+    size_t length = ODDynatraceRecordLength(record);
+    if (length > capacity || length > UINT32_MAX) {
+        return 0;
+    }
+    uint64_t value = 0;
+    if (record->type == ODDynatraceEventReportDoubleValue) {
+        memcpy(&value, &record->value.doubleValue, sizeof(value));
+    } else {
+        value = (uint64_t)(int64_t)record->value.intValue;
+    }
+
+    OSWriteLittleInt32(buffer, 0, (uint32_t)length);
+    buffer[4] = ODDynatraceRecordVersion;
+    buffer[5] = record->type;
+    OSWriteLittleInt16(buffer, 6, record->nameLength);
+    OSWriteLittleInt32(buffer, 8, (uint32_t)record->handle);
+    OSWriteLittleInt32(buffer, 12, record->nameId);
+    OSWriteLittleInt32(buffer, 16, record->writer);
+    OSWriteLittleInt32(buffer, 20, record->stringLength);
+    OSWriteLittleInt64(buffer, 24, record->timestamp);
+    OSWriteLittleInt64(buffer, 32, value);
+    if (record->nameLength > 0) {
+        memcpy(buffer + ODDynatraceRecordHeaderLength, record->name, record->nameLength);
+    }
+    if (record->stringLength > 0) {
+        memcpy(buffer + ODDynatraceRecordHeaderLength + record->nameLength, record->stringValue, record->stringLength);
+    }
+    return length;
+}
+
+size_t ODDynatraceRecordDecode(const uint8_t *buffer, size_t length, ODDynatraceRecord *record)
+{
+    if (length < ODDynatraceRecordHeaderLength || buffer[4] != ODDynatraceRecordVersion) {
+        return 0;
+    }
+    uint32_t recordLength = OSReadLittleInt32(buffer, 0);
+    uint16_t nameLength = OSReadLittleInt16(buffer, 6);
+    uint32_t stringLength = OSReadLittleInt32(buffer, 20);
+    if (recordLength > length
+        || (uint64_t)ODDynatraceRecordHeaderLength + nameLength + stringLength != recordLength) {
+        return 0;
+    }
+
+    record->type = buffer[5];
+    record->handle = (int32_t)OSReadLittleInt32(buffer, 8);
+    record->nameId = OSReadLittleInt32(buffer, 12);
+    record->writer = OSReadLittleInt32(buffer, 16);
+    record->timestamp = OSReadLittleInt64(buffer, 24);
+    record->name = buffer + ODDynatraceRecordHeaderLength;
+    record->nameLength = nameLength;
+    record->stringValue = record->name + nameLength;
+    record->stringLength = stringLength;
+    uint64_t value = OSReadLittleInt64(buffer, 32);
+    if (record->type == ODDynatraceEventReportDoubleValue) {
+        memcpy(&record->value.doubleValue, &value, sizeof(value));
+    } else {
+        record->value.intValue = (int)(int64_t)value;
+    }
+    return recordLength;
+}
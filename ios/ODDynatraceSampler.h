@@ -0,0 +1,27 @@
+//
+//  ODDynatraceSampler.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 11/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// Decides which actions and events reach the ADK, from the startup options :
+//  - sampleRate : share of the sessions reported at all, between 0 and 1
+//  - sampleRates : share of the sessions reporting a given name, per name
+//  - rateLimit, rateLimitBurst : events per second allowed overall, and how many can go at once
+// A name is either always or never sampled during a session. Safe to call from any thread without locking.
+@interface ODDynatraceSampler : NSObject
+
+- (nonnull instancetype)initWithOptions:(nullable NSDictionary *)options;
+
+// YES when the action or event of this name has to be dropped
+- (BOOL)dropName:(nullable NSString *)name;
+
+// Events dropped by the sample rates and by the rate limit
+@property (nonatomic, readonly) NSUInteger sampledCount;
+@property (nonatomic, readonly) NSUInteger rateLimitedCount;
+
+@end
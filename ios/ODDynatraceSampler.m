@@ -0,0 +1,126 @@
+//
+//  ODDynatraceSampler.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 11/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceSampler.h"
+
+#import <mach/mach_time.h>
+#import <stdatomic.h>
+
+static uint64_t ODDynatraceSamplerNow(void)
+{
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    return mach_absolute_time() * timebase.numer / timebase.denom;
+}
+
+// splitmix64 finalizer, spreads close keys over the whole range
+static uint64_t ODDynatraceSamplerMix(uint64_t key)
+{
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return key ^ (key >> 31);
+}
+
+static BOOL ODDynatraceSamplerKeep(uint64_t key, double rate)
+{
+    if (rate >= 1) {
+        return YES;
+    }
+    return (ODDynatraceSamplerMix(key) >> 11) * 0x1.0p-53 < rate;
+}
+
+@implementation ODDynatraceSampler
+{
+    uint64_t _seed;
+    BOOL _sessionSampled;
+    NSDictionary<NSString *, NSNumber *> *_sampleRates;
+    // Token bucket kept as the time the next event is allowed, in ns (GCRA)
+    uint64_t _interval;
+    uint64_t _burstTolerance;
+    atomic_uint_fast64_t _allowedAt;
+    atomic_ulong _sampledCount;
+    atomic_ulong _rateLimitedCount;
+}
+
+- (instancetype)init
+{
+    return [self initWithOptions:nil];
+}
+
+- (instancetype)initWithOptions:(NSDictionary *)options
+{
+    if ((self = [super init])) {
+        arc4random_buf(&_seed, sizeof(_seed));
+        NSNumber *sampleRate = options[@"sampleRate"];
+        _sessionSampled = ODDynatraceSamplerKeep(_seed, sampleRate ? sampleRate.doubleValue : 1);
+        _sampleRates = [options[@"sampleRates"] copy];
+
+        double rateLimit = [options[@"rateLimit"] doubleValue];
+        if (rateLimit > 0) {
+            double burst = MAX([options[@"rateLimitBurst"] doubleValue], 1);
+            _interval = (uint64_t)(NSEC_PER_SEC / rateLimit);
+            _burstTolerance = (uint64_t)((burst - 1) * _interval);
+        }
+        atomic_init(&_allowedAt, 0);
+        atomic_init(&_sampledCount, 0);
+        atomic_init(&_rateLimitedCount, 0);
+    }
+    return self;
+}
+
+- (NSUInteger)sampledCount
+{
+    return atomic_load_explicit(&_sampledCount, memory_order_relaxed);
+}
+
+- (NSUInteger)rateLimitedCount
+{
+    return atomic_load_explicit(&_rateLimitedCount, memory_order_relaxed);
+}
+
+- (BOOL)dropName:(NSString *)name
+{
+    if (!_sessionSampled) {
+        atomic_fetch_add_explicit(&_sampledCount, 1, memory_order_relaxed);
+        return YES;
+    }
+    NSNumber *sampleRate = name ? _sampleRates[name] : nil;
+    if (sampleRate && !ODDynatraceSamplerKeep(_seed ^ name.hash, sampleRate.doubleValue)) {
+        atomic_fetch_add_explicit(&_sampledCount, 1, memory_order_relaxed);
+        return YES;
+    }
+    if (![self acquireToken]) {
+        atomic_fetch_add_explicit(&_rateLimitedCount, 1, memory_order_relaxed);
+        return YES;
+    }
+    return NO;
+}
+
+- (BOOL)acquireToken
+{
+    if (_interval == 0) {
+        return YES;
+    }
+    uint64_t now = ODDynatraceSamplerNow();
+    uint64_t allowedAt = atomic_load_explicit(&_allowedAt, memory_order_relaxed);
+    for (;;) {
+        uint64_t start = MAX(allowedAt, now);
+        if (start - now > _burstTolerance) {
+            return NO;
+        }
+        if (atomic_compare_exchange_weak_explicit(&_allowedAt, &allowedAt, start + _interval,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            return YES;
+        }
+    }
+}
+
+@end
@@ -0,0 +1,45 @@
+//
+//  ODDynatraceScreens.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 04/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "ODDynatraceHandleTable.h"
+
+// Milliseconds since 1970, same clock as Date.now() in JS
+double ODDynatraceScreenTime(void);
+
+// Screens marked from JS, each one reported as an action open from its enter to its exit with the values :
+//  - "Time to first render" : milliseconds from the enter to the first render mark
+//  - "Time to interactive" : milliseconds from the enter to the first time the main thread is idle after
+//    the first render mark
+// Only the three marks cross the bridge, the times are computed here. Screens are identified by name,
+// entering an open screen again leaves it first. Only used from the module queue.
+@interface ODDynatraceScreens : NSObject
+
+- (nonnull instancetype)initWithQueue:(nonnull dispatch_queue_t)queue;
+
+// Returns the handle of the action entered for the screen
+@property (nonatomic, copy, nullable) ODDynatraceHandle (^enterHandler)(NSString * _Nonnull name);
+
+@property (nonatomic, copy, nullable) void (^valueHandler)(ODDynatraceHandle action, NSString * _Nonnull valueName, double value);
+
+@property (nonatomic, copy, nullable) void (^leaveHandler)(ODDynatraceHandle action);
+
+// Runs the block on the main thread the next time it is idle
+@property (nonatomic, copy, nullable) void (^idleHandler)(dispatch_block_t _Nonnull block);
+
+- (void)enterScreen:(nonnull NSString *)name time:(double)time;
+
+- (void)renderScreen:(nonnull NSString *)name time:(double)time;
+
+- (void)exitScreen:(nonnull NSString *)name;
+
+// Leaves the open screens
+- (void)invalidate;
+
+@end
@@ -0,0 +1,101 @@
+//
+//  ODDynatraceScreens.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 04/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceScreens.h"
+
+double ODDynatraceScreenTime(void)
+{
+    return [NSDate date].timeIntervalSince1970 * 1000;
+}
+
+@interface ODDynatraceScreen : NSObject
+
+@property (nonatomic) ODDynatraceHandle action;
+@property (nonatomic) double enterTime;
+@property (nonatomic) BOOL rendered;
+
+@end
+
+@implementation ODDynatraceScreen
+@end
+
+@implementation ODDynatraceScreens
+{
+    dispatch_queue_t _queue;
+    NSMutableDictionary<NSString *, ODDynatraceScreen *> *_screens;
+}
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue
+{
+    if ((self = [super init])) {
+        _queue = queue;
+        _screens = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+- (void)enterScreen:(NSString *)name time:(double)time
+{
+    [self exitScreen:name];
+    ODDynatraceHandle action = _enterHandler(name);
+    if (action == ODDynatraceInvalidHandle) {
+        return;
+    }
+    ODDynatraceScreen *screen = [ODDynatraceScreen new];
+    screen.action = action;
+    screen.enterTime = time;
+    _screens[name] = screen;
+}
+
+- (void)renderScreen:(NSString *)name time:(double)time
+{
+    ODDynatraceScreen *screen = _screens[name];
+    if (!screen || screen.rendered) {
+        return;
+    }
+    screen.rendered = YES;
+    [self reportValue:@"Time to first render" time:time screen:screen];
+
+    __weak ODDynatraceScreens *weakSelf = self;
+    dispatch_queue_t queue = _queue;
+    _idleHandler(^{
+        double idleTime = ODDynatraceScreenTime();
+        dispatch_async(queue, ^{
+            ODDynatraceScreens *strongSelf = weakSelf;
+            // Skipped when the screen was left before
+            if (strongSelf && strongSelf->_screens[name] == screen) {
+                [strongSelf reportValue:@"Time to interactive" time:idleTime screen:screen];
+            }
+        });
+    });
+}
+
+- (void)exitScreen:(NSString *)name
+{
+    ODDynatraceScreen *screen = _screens[name];
+    if (!screen) {
+        return;
+    }
+    [_screens removeObjectForKey:name];
+    _leaveHandler(screen.action);
+}
+
+- (void)invalidate
+{
+    for (ODDynatraceScreen *screen in _screens.allValues) {
+        _leaveHandler(screen.action);
+    }
+    [_screens removeAllObjects];
+}
+
+- (void)reportValue:(NSString *)valueName time:(double)time screen:(ODDynatraceScreen *)screen
+{
+    _valueHandler(screen.action, valueName, MAX(time - screen.enterTime, 0));
+}
+
+@end
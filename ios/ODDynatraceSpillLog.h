@@ -0,0 +1,35 @@
+//
+//  ODDynatraceSpillLog.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 15/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "ODDynatraceArena.h"
+#import "ODDynatraceEventBuffer.h"
+
+// Events recorded while the ADK is not started, kept in a memory-mapped file of bounded size
+// until they can be replayed. A record is only counted once fully written, so the file stays
+// readable after a crash. Only used from the module queue.
+@interface ODDynatraceSpillLog : NSObject
+
+// Returns nil when the file can't be mapped
+- (nullable instancetype)initWithPath:(nonnull NSString *)path capacity:(NSUInteger)capacity;
+
+@property (nonatomic, readonly) NSUInteger capacity;
+@property (nonatomic, readonly) NSUInteger size;
+@property (nonatomic, readonly) uint64_t droppedCount;
+
+// The name replaces the event name id, which is not kept across launches. Returns NO when full.
+// The arena provides the scratch memory of the UTF-8 conversions.
+- (BOOL)appendEvent:(nonnull const ODDynatraceEvent *)event
+               name:(nonnull NSString *)name
+              arena:(nonnull ODDynatraceArena *)arena;
+
+// Calls the block with each event in order, then empties the log. Event strings are only valid
+// during the call. Handles of events written by a previous launch do not exist anymore.
+- (void)replayEventsUsingBlock:(nonnull void (^)(ODDynatraceEvent *_Nonnull event, BOOL previousLaunch))block;
+
+@end
@@ -0,0 +1,151 @@
+//
+//  ODDynatraceSpillLog.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 15/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceSpillLog.h"
+#import "ODDynatraceRecord.h"
+
+#import <fcntl.h>
+#import <sys/mman.h>
+#import <unistd.h>
+
+static const uint32_t ODDynatraceSpillLogMagic = 0x4c53444f; // "ODSL"
+static const uint32_t ODDynatraceSpillLogVersion = 2;
+
+// Followed by ODDynatraceRecord records. The size is written last, readers ignore the records past it.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t reserved;
+} ODDynatraceSpillLogHeader;
+
+@implementation ODDynatraceSpillLog
+{
+    int _fd;
+    uint8_t *_bytes;
+    ODDynatraceSpillLogHeader *_header;
+    uint32_t _launch;
+}
+
+- (instancetype)initWithPath:(NSString *)path capacity:(NSUInteger)capacity
+{
+    if ((self = [super init])) {
+        _capacity = MAX(capacity, sizeof(ODDynatraceSpillLogHeader));
+        _launch = arc4random();
+        _fd = open(path.fileSystemRepresentation, O_RDWR | O_CREAT, 0600);
+        if (_fd < 0) {
+            return nil;
+        }
+        if (ftruncate(_fd, (off_t)_capacity) != 0) {
+            close(_fd);
+            _fd = -1;
+            return nil;
+        }
+        _bytes = mmap(NULL, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+        if (_bytes == MAP_FAILED) {
+            close(_fd);
+            _fd = -1;
+            return nil;
+        }
+        _header = (ODDynatraceSpillLogHeader *)_bytes;
+        if (_header->magic != ODDynatraceSpillLogMagic
+            || _header->version != ODDynatraceSpillLogVersion
+            || _header->size > _capacity - sizeof(ODDynatraceSpillLogHeader)) {
+            _header->magic = ODDynatraceSpillLogMagic;
+            _header->version = ODDynatraceSpillLogVersion;
+            _header->size = 0;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    if (_bytes && _bytes != MAP_FAILED) {
+        munmap(_bytes, _capacity);
+    }
+    if (_fd >= 0) {
+        close(_fd);
+    }
+}
+
+- (NSUInteger)size
+{
+    return _header->size;
+}
+
+- (BOOL)appendEvent:(const ODDynatraceEvent *)event name:(NSString *)name arena:(ODDynatraceArena *)arena
+{
+    size_t nameLength = 0;
+    size_t stringLength = 0;
+    const char *nameBytes = [arena UTF8StringOf:(__bridge CFStringRef)name length:&nameLength];
+    const char *stringBytes = event->type == ODDynatraceEventReportStringValue && event->value.stringValue
+        ? [arena UTF8StringOf:event->value.stringValue length:&stringLength]
+        : NULL;
+    ODDynatraceRecord record = {
+        .type = event->type,
+        .handle = event->handle,
+        .nameId = event->nameId,
+        .writer = _launch,
+        .timestamp = (uint64_t)([NSDate date].timeIntervalSince1970 * 1000),
+        .name = (const uint8_t *)nameBytes,
+        .nameLength = (uint16_t)nameLength,
+        .stringValue = (const uint8_t *)stringBytes,
+        .stringLength = (uint32_t)stringLength,
+    };
+    if (event->type == ODDynatraceEventEnterAction) {
+        record.value.intValue = event->parent;
+    } else if (event->type == ODDynatraceEventReportDoubleValue) {
+        record.value.doubleValue = event->value.doubleValue;
+    } else if (event->type != ODDynatraceEventReportStringValue) {
+        record.value.intValue = event->value.intValue;
+    }
+
+    size_t offset = sizeof(ODDynatraceSpillLogHeader) + _header->size;
+    size_t length = nameLength <= UINT16_MAX
+        ? ODDynatraceRecordEncode(&record, _bytes + offset, _capacity - offset)
+        : 0;
+    if (length == 0) {
+        _droppedCount++;
+        return NO;
+    }
+    _header->size += (uint32_t)length;
+    return YES;
+}
+
+- (void)replayEventsUsingBlock:(void (^)(ODDynatraceEvent *, BOOL))block
+{
+    const uint8_t *bytes = _bytes + sizeof(ODDynatraceSpillLogHeader);
+    const uint8_t *end = bytes + _header->size;
+    ODDynatraceRecord record;
+    size_t length;
+    while ((length = ODDynatraceRecordDecode(bytes, end - bytes, &record)) > 0) {
+        // The ADK keeps the strings it is given, they can't point into the file
+        ODDynatraceEvent event = {
+            .type = record.type,
+            .handle = record.handle,
+            .name = CFStringCreateWithBytes(NULL, record.name, record.nameLength, kCFStringEncodingUTF8, false),
+        };
+        if (record.type == ODDynatraceEventEnterAction) {
+            event.parent = record.value.intValue;
+        } else if (record.type == ODDynatraceEventReportStringValue) {
+            event.value.stringValue = CFStringCreateWithBytes(NULL, record.stringValue, record.stringLength,
+                                                              kCFStringEncodingUTF8, false);
+        } else if (record.type == ODDynatraceEventReportDoubleValue) {
+            event.value.doubleValue = record.value.doubleValue;
+        } else {
+            event.value.intValue = record.value.intValue;
+        }
+        block(&event, record.writer != _launch);
+        ODDynatraceEventRelease(&event);
+        bytes += length;
+    }
+    _header->size = 0;
+}
+
+@end
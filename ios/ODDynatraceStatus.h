@@ -0,0 +1,28 @@
+//
+//  ODDynatraceStatus.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 20/11/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "DynatraceUEM.h"
+
+// Constant name of a status code, e.g. "CPWR_UemOn". Same names as ODDynatraceStatus.java.
+FOUNDATION_EXPORT NSString *ODDynatraceStatusName(CPWR_StatusCode statusCode);
+
+// Human readable meaning of a status code, used in the module logs.
+FOUNDATION_EXPORT NSString *ODDynatraceStatusDescription(CPWR_StatusCode statusCode);
+
+// Number of results per status code, so failures can be read on demand instead of per call.
+// Not thread safe, only used on the module queue.
+@interface ODDynatraceStatusCounts : NSObject
+
+// Codes outside of CPWR_StatusCode are ignored
+- (void)countStatus:(CPWR_StatusCode)statusCode;
+
+// Count per status name, e.g. @{ @"CPWR_UemOn": @12, @"CPWR_Error_ActionEnded": @1 }
+- (NSDictionary<NSString *, NSNumber *> *)dictionary;
+
+@end
@@ -0,0 +1,72 @@
+//
+//  ODDynatraceStatus.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 20/11/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceStatus.h"
+
+NSString *ODDynatraceStatusName(CPWR_StatusCode statusCode)
+{
+    switch (statusCode) {
+        case CPWR_UemOff: return @"CPWR_UemOff";
+        case CPWR_UemOn: return @"CPWR_UemOn";
+        case CPWR_CrashReportingUnavailable: return @"CPWR_CrashReportingUnavailable";
+        case CPWR_CrashReportingAvailable: return @"CPWR_CrashReportingAvailable";
+        case CPWR_Error_NotInitialized: return @"CPWR_Error_NotInitialized";
+        case CPWR_Error_InvalidRange: return @"CPWR_Error_InvalidRange";
+        case CPWR_Error_InternalError: return @"CPWR_Error_InternalError";
+        case CPWR_Error_ActionNotFound: return @"CPWR_Error_ActionNotFound";
+        case CPWR_Error_InvalidParameter: return @"CPWR_Error_InvalidParameter";
+        case CPWR_Error_ActionEnded: return @"CPWR_Error_ActionEnded";
+        case CPWR_ReportErrorOff: return @"CPWR_ReportErrorOff";
+        case CPWR_TruncatedEventName: return @"CPWR_TruncatedEventName";
+        case CPWR_CrashReportInvalid: return @"CPWR_CrashReportInvalid";
+    }
+    return [NSString stringWithFormat:@"CPWR_Unknown(%d)", statusCode];
+}
+
+NSString *ODDynatraceStatusDescription(CPWR_StatusCode statusCode)
+{
+    switch (statusCode) {
+        case CPWR_UemOff: return @"ADK is not enabled or can't capture data";
+        case CPWR_UemOn: return @"Successful";
+        case CPWR_Error_NotInitialized: return @"ADK is not initialized";
+        case CPWR_Error_InvalidParameter: return @"a parameter is null or empty";
+        case CPWR_Error_ActionNotFound: return @"action not found";
+        case CPWR_Error_ActionEnded: return @"action already ended";
+        default: return @"Failed";
+    }
+}
+
+// From CPWR_CrashReportInvalid to CPWR_CrashReportingAvailable
+static const int ODDynatraceStatusMin = CPWR_CrashReportInvalid;
+static const int ODDynatraceStatusMax = CPWR_CrashReportingAvailable;
+
+@implementation ODDynatraceStatusCounts
+{
+    NSUInteger _counts[ODDynatraceStatusMax - ODDynatraceStatusMin + 1];
+}
+
+- (void)countStatus:(CPWR_StatusCode)statusCode
+{
+    if (statusCode != 0 && statusCode >= ODDynatraceStatusMin && statusCode <= ODDynatraceStatusMax) {
+        _counts[statusCode - ODDynatraceStatusMin]++;
+    }
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)dictionary
+{
+    NSMutableDictionary<NSString *, NSNumber *> *dictionary = [NSMutableDictionary dictionary];
+    for (int statusCode = ODDynatraceStatusMin; statusCode <= ODDynatraceStatusMax; statusCode++) {
+        NSUInteger count = _counts[statusCode - ODDynatraceStatusMin];
+        if (count > 0) {
+            dictionary[ODDynatraceStatusName(statusCode)] = @(count);
+        }
+    }
+    return dictionary;
+}
+
+@end
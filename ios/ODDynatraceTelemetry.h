@@ -0,0 +1,40 @@
+//
+//  ODDynatraceTelemetry.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 05/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "ODDynatraceEventBuffer.h"
+
+// Monotonic time in nanoseconds
+FOUNDATION_EXPORT uint64_t ODDynatraceTelemetryNow(void);
+
+// Cost of the module itself, cheap enough to stay enabled : counters are relaxed atomics and the time
+// spent in the ADK goes to one lock-free ODDynatraceHistogram per event type. Recording is allowed from
+// any thread, snapshots are taken on the module queue.
+@interface ODDynatraceTelemetry : NSObject
+
+- (void)recordEvent:(ODDynatraceEventType)type nanoseconds:(uint64_t)nanoseconds;
+
+// Estimated bytes of the records received from JS
+- (void)recordBatch:(NSUInteger)recordCount bytes:(NSUInteger)bytes;
+
+// Number of events found in the buffer by one drain, kept as the maximum queue depth
+- (void)recordQueueDepth:(NSUInteger)depth;
+
+// Counters since the module was created, latencies in microseconds and rates since the previous snapshot :
+// @{ @"uptime", @"interval", @"eventsPerSecond", @"batches", @"records", @"bytes", @"maxQueueDepth",
+//    @"events": @{ @"enter": @{ @"count", @"p50", @"p99", @"max" }, ... } }
+- (nonnull NSDictionary<NSString *, id> *)snapshot;
+
+// Calls the dump handler every statsDumpInterval seconds (startup option, disabled by default)
+- (void)startWithOptions:(nullable NSDictionary *)options queue:(nonnull dispatch_queue_t)queue;
+
+@property (nonatomic, copy, nullable) void (^dumpHandler)(void);
+
+- (void)invalidate;
+
+@end
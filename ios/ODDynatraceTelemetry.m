@@ -0,0 +1,158 @@
+//
+//  ODDynatraceTelemetry.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 05/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceTelemetry.h"
+#import "ODDynatraceHistogram.h"
+
+#import <mach/mach_time.h>
+#import <stdatomic.h>
+
+uint64_t ODDynatraceTelemetryNow(void)
+{
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    return mach_absolute_time() * timebase.numer / timebase.denom;
+}
+
+@implementation ODDynatraceTelemetry
+{
+    atomic_uint_fast64_t _eventCounts[ODDynatraceEventTypeCount];
+    ODDynatraceHistogram *_latencies[ODDynatraceEventTypeCount];
+    atomic_uint_fast64_t _batchCount;
+    atomic_uint_fast64_t _recordCount;
+    atomic_uint_fast64_t _byteCount;
+    atomic_uint_fast64_t _maxQueueDepth;
+    dispatch_source_t _timer;
+
+    // Only used by the snapshots
+    uint64_t _startTime;
+    uint64_t _snapshotTime;
+    uint64_t _snapshotEventCount;
+}
+
+- (instancetype)init
+{
+    if ((self = [super init])) {
+        for (NSUInteger i = 0; i < ODDynatraceEventTypeCount; i++) {
+            atomic_init(&_eventCounts[i], 0);
+            _latencies[i] = ODDynatraceHistogramCreate();
+        }
+        atomic_init(&_batchCount, 0);
+        atomic_init(&_recordCount, 0);
+        atomic_init(&_byteCount, 0);
+        atomic_init(&_maxQueueDepth, 0);
+        _startTime = ODDynatraceTelemetryNow();
+        _snapshotTime = _startTime;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [self invalidate];
+    for (NSUInteger i = 0; i < ODDynatraceEventTypeCount; i++) {
+        ODDynatraceHistogramDestroy(_latencies[i]);
+    }
+}
+
+- (void)recordEvent:(ODDynatraceEventType)type nanoseconds:(uint64_t)nanoseconds
+{
+    if (type >= ODDynatraceEventTypeCount) {
+        return;
+    }
+    atomic_fetch_add_explicit(&_eventCounts[type], 1, memory_order_relaxed);
+    ODDynatraceHistogramRecord(_latencies[type], nanoseconds / 1000.0);
+}
+
+- (void)recordBatch:(NSUInteger)recordCount bytes:(NSUInteger)bytes
+{
+    atomic_fetch_add_explicit(&_batchCount, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_recordCount, recordCount, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_byteCount, bytes, memory_order_relaxed);
+}
+
+- (void)recordQueueDepth:(NSUInteger)depth
+{
+    uint_fast64_t maxDepth = atomic_load_explicit(&_maxQueueDepth, memory_order_relaxed);
+    while (depth > maxDepth
+           && !atomic_compare_exchange_weak_explicit(&_maxQueueDepth, &maxDepth, depth,
+                                                     memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+- (NSDictionary<NSString *, id> *)snapshot
+{
+    uint64_t now = ODDynatraceTelemetryNow();
+    double interval = (now - _snapshotTime) / 1e9;
+    _snapshotTime = now;
+
+    NSMutableDictionary<NSString *, id> *events = [NSMutableDictionary dictionaryWithCapacity:ODDynatraceEventTypeCount];
+    uint64_t eventCount = 0;
+    ODDynatraceHistogramSummary summary;
+    for (NSUInteger i = 0; i < ODDynatraceEventTypeCount; i++) {
+        uint64_t count = atomic_load_explicit(&_eventCounts[i], memory_order_relaxed);
+        eventCount += count;
+        if (!ODDynatraceHistogramSummarize(_latencies[i], &summary)) {
+            summary = (ODDynatraceHistogramSummary){ 0 };
+        }
+        events[ODDynatraceEventTypeName((ODDynatraceEventType)i)] = @{
+            @"count": @(count),
+            @"p50": @(summary.p50),
+            @"p99": @(summary.p99),
+            @"max": @(summary.max),
+        };
+    }
+    double eventsPerSecond = interval > 0 ? (eventCount - _snapshotEventCount) / interval : 0;
+    _snapshotEventCount = eventCount;
+
+    return @{
+        @"uptime": @((now - _startTime) / 1e9),
+        @"interval": @(interval),
+        @"eventsPerSecond": @(eventsPerSecond),
+        @"batches": @(atomic_load_explicit(&_batchCount, memory_order_relaxed)),
+        @"records": @(atomic_load_explicit(&_recordCount, memory_order_relaxed)),
+        @"bytes": @(atomic_load_explicit(&_byteCount, memory_order_relaxed)),
+        @"maxQueueDepth": @(atomic_exchange_explicit(&_maxQueueDepth, 0, memory_order_relaxed)),
+        @"events": events,
+    };
+}
+
+- (void)startWithOptions:(NSDictionary *)options queue:(dispatch_queue_t)queue
+{
+    [self invalidate];
+    NSTimeInterval interval = [options[@"statsDumpInterval"] doubleValue];
+    if (interval <= 0) {
+        return;
+    }
+    _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, queue);
+    __weak ODDynatraceTelemetry *weakSelf = self;
+    dispatch_source_set_event_handler(_timer, ^{
+        ODDynatraceTelemetry *strongSelf = weakSelf;
+        if (strongSelf.dumpHandler) {
+            strongSelf.dumpHandler();
+        }
+    });
+    dispatch_source_set_timer(_timer,
+                              dispatch_time(DISPATCH_TIME_NOW, (int64_t)(interval * NSEC_PER_SEC)),
+                              (uint64_t)(interval * NSEC_PER_SEC),
+                              (uint64_t)(NSEC_PER_SEC));
+    dispatch_resume(_timer);
+}
+
+- (void)invalidate
+{
+    if (_timer) {
+        dispatch_source_cancel(_timer);
+        _timer = nil;
+    }
+}
+
+@end
@@ -0,0 +1,92 @@
+//
+//  ODDynatraceArenaTests.m
+//  ODDynatraceTests
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "ODDynatraceArena.h"
+
+static const int ODDynatraceArenaTestsBatches = 1000;
+static const int ODDynatraceArenaTestsBatchRecords = 64;
+
+// Scratch memory of the batches. The arena only calls malloc to add a block, so its block count is the number
+// of mallocs : once a batch of the usual size went through, the next ones must not allocate at all.
+@interface ODDynatraceArenaTests : XCTestCase
+@end
+
+@implementation ODDynatraceArenaTests
+
+// Same allocations as a batch of submitBatch : the table of its actions, then the UTF-8 names of its records
+- (void)allocateBatchIn:(ODDynatraceArena *)arena names:(NSArray<NSString *> *)names
+{
+    [arena allocateZeroed:ODDynatraceArenaTestsBatchRecords * 16];
+    for (int i = 0; i < ODDynatraceArenaTestsBatchRecords; i++) {
+        size_t length;
+        const char *name = [arena UTF8StringOf:(__bridge CFStringRef)names[i % names.count] length:&length];
+        XCTAssertEqual(strlen(name), length);
+    }
+}
+
+- (NSArray<NSString *> *)names
+{
+    // Non-ASCII names are converted into the arena
+    return @[ @"Écran d'accueil", @"Rafraîchir", @"Éléments", @"Panier 🛒" ];
+}
+
+- (void)testAllocationsAreAligned
+{
+    ODDynatraceArena *arena = [[ODDynatraceArena alloc] initWithBlockSize:256];
+    for (size_t size = 1; size < 100; size++) {
+        XCTAssertEqual((uintptr_t)[arena allocate:size] % 8, 0);
+    }
+}
+
+- (void)testAllocationsLargerThanABlockGetTheirOwnBlock
+{
+    ODDynatraceArena *arena = [[ODDynatraceArena alloc] initWithBlockSize:256];
+    uint8_t *memory = [arena allocateZeroed:1024];
+    for (size_t i = 0; i < 1024; i++) {
+        XCTAssertEqual(memory[i], 0);
+    }
+    XCTAssertEqual(arena.blockCount, 1);
+    XCTAssertEqual(arena.usedSize, 1024);
+}
+
+- (void)testResetKeepsTheBlocks
+{
+    ODDynatraceArena *arena = [[ODDynatraceArena alloc] initWithBlockSize:1024];
+    NSArray<NSString *> *names = [self names];
+    [self allocateBatchIn:arena names:names];
+    NSUInteger blockCount = arena.blockCount;
+    XCTAssertGreaterThan(blockCount, 1);
+
+    for (int batch = 0; batch < ODDynatraceArenaTestsBatches; batch++) {
+        [arena reset];
+        XCTAssertEqual(arena.usedSize, 0);
+        [self allocateBatchIn:arena names:names];
+    }
+    XCTAssertEqual(arena.blockCount, blockCount);
+}
+
+// Time of the scratch allocations of a batch, with the number of mallocs made once the arena is warm
+- (void)testBatchAllocationsBenchmark
+{
+    ODDynatraceArena *arena = [[ODDynatraceArena alloc] initWithBlockSize:16 * 1024];
+    NSArray<NSString *> *names = [self names];
+    [self allocateBatchIn:arena names:names];
+    [arena reset];
+    NSUInteger blockCount = arena.blockCount;
+
+    [self measureBlock:^{
+        for (int batch = 0; batch < ODDynatraceArenaTestsBatches; batch++) {
+            [self allocateBatchIn:arena names:names];
+            [arena reset];
+        }
+    }];
+    XCTAssertEqual(arena.blockCount - blockCount, 0, @"mallocs in %d warm batches", ODDynatraceArenaTestsBatches);
+}
+
+@end
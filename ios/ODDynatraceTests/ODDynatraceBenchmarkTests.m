@@ -0,0 +1,139 @@
+//
+//  ODDynatraceBenchmarkTests.m
+//  ODDynatraceTests
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "ODDynatraceEventBuffer.h"
+#import "ODDynatraceHandleTable.h"
+#import "ODDynatraceHistogram.h"
+#import "ODDynatraceRecord.h"
+
+static const int ODDynatraceBenchmarkTestsOperations = 100000;
+static const size_t ODDynatraceBenchmarkTestsProducers = 4;
+
+// Timings of the native building blocks, same cases as ODDynatraceBenchmarkTest.java. Once a baseline is set in
+// the test report, Xcode keeps it per device and fails the test when a run is slower than the allowed deviation.
+@interface ODDynatraceBenchmarkTests : XCTestCase
+@end
+
+@implementation ODDynatraceBenchmarkTests
+
+- (ODDynatraceEvent)valueEvent:(int)value
+{
+    ODDynatraceEvent event = { 0 };
+    event.type = ODDynatraceEventReportIntValue;
+    event.handle = 1;
+    event.nameId = 1;
+    event.value.intValue = value;
+    return event;
+}
+
+- (void)testEventBufferPushPop
+{
+    ODDynatraceEventBuffer *buffer = [[ODDynatraceEventBuffer alloc] initWithCapacity:1024
+                                                                       overflowPolicy:ODDynatraceOverflowPolicyDropNewest];
+    [self measureBlock:^{
+        ODDynatraceEvent popped;
+        for (int i = 0; i < ODDynatraceBenchmarkTestsOperations; i++) {
+            ODDynatraceEvent event = [self valueEvent:i];
+            [buffer push:&event];
+            [buffer pop:&popped];
+        }
+    }];
+    XCTAssertEqual(buffer.droppedCount, 0);
+}
+
+// Producers of several threads pushing while the consumer pops, as with native callers and the module queue
+- (void)testEventBufferContendedPush
+{
+    ODDynatraceEventBuffer *buffer = [[ODDynatraceEventBuffer alloc] initWithCapacity:1024
+                                                                       overflowPolicy:ODDynatraceOverflowPolicyDropNewest];
+    [self measureBlock:^{
+        dispatch_group_t producers = dispatch_group_create();
+        dispatch_group_async(producers, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+            dispatch_apply(ODDynatraceBenchmarkTestsProducers, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t producer) {
+                for (int i = 0; i < ODDynatraceBenchmarkTestsOperations / (int)ODDynatraceBenchmarkTestsProducers; i++) {
+                    ODDynatraceEvent event = [self valueEvent:i];
+                    [buffer push:&event];
+                }
+            });
+        });
+        ODDynatraceEvent popped;
+        while (dispatch_group_wait(producers, DISPATCH_TIME_NOW) != 0 || buffer.count > 0) {
+            [buffer pop:&popped];
+        }
+    }];
+}
+
+- (void)testHandleTableAddRemove
+{
+    ODDynatraceHandleTable<NSNumber *> *table = [[ODDynatraceHandleTable alloc] initWithCapacity:64];
+    NSNumber *object = @1;
+    [self measureBlock:^{
+        for (int i = 0; i < ODDynatraceBenchmarkTestsOperations; i++) {
+            [table removeObjectForHandle:[table addObject:object]];
+        }
+    }];
+}
+
+- (void)testHandleTableLookup
+{
+    ODDynatraceHandleTable<NSNumber *> *table = [[ODDynatraceHandleTable alloc] initWithCapacity:64];
+    ODDynatraceHandle handles[64];
+    for (int i = 0; i < 64; i++) {
+        handles[i] = [table addObject:@(i)];
+    }
+    [self measureBlock:^{
+        for (int i = 0; i < ODDynatraceBenchmarkTestsOperations; i++) {
+            [table objectForHandle:handles[i % 64]];
+        }
+    }];
+}
+
+- (void)testRecordEncodeDecode
+{
+    const char *name = "Items";
+    [self measureBlock:^{
+        uint8_t buffer[64];
+        ODDynatraceRecord record = { 0 };
+        record.type = ODDynatraceEventReportIntValue;
+        record.handle = 1;
+        record.name = (const uint8_t *)name;
+        record.nameLength = (uint16_t)strlen(name);
+        ODDynatraceRecord decoded;
+        for (int i = 0; i < ODDynatraceBenchmarkTestsOperations; i++) {
+            record.value.intValue = i;
+            ODDynatraceRecordDecode(buffer, ODDynatraceRecordEncode(&record, buffer, sizeof(buffer)), &decoded);
+        }
+    }];
+}
+
+- (void)testHistogramRecord
+{
+    ODDynatraceHistogram *histogram = ODDynatraceHistogramCreate();
+    [self measureBlock:^{
+        for (int i = 0; i < ODDynatraceBenchmarkTestsOperations; i++) {
+            ODDynatraceHistogramRecord(histogram, 0.5 + i % 1000);
+        }
+    }];
+    ODDynatraceHistogramDestroy(histogram);
+}
+
+- (void)testHistogramSummarize
+{
+    ODDynatraceHistogram *histogram = ODDynatraceHistogramCreate();
+    [self measureBlock:^{
+        ODDynatraceHistogramSummary summary;
+        for (int i = 0; i < ODDynatraceBenchmarkTestsOperations / 100; i++) {
+            ODDynatraceHistogramRecord(histogram, 0.5 + i % 1000);
+            ODDynatraceHistogramSummarize(histogram, &summary);
+        }
+    }];
+    ODDynatraceHistogramDestroy(histogram);
+}
+
+@end
@@ -0,0 +1,22 @@
+//
+//  ODDynatraceFakeADK.h
+//  ODDynatraceTests
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// DynatraceUEM, UEMAction and UEMWebRequestTiming replaced by stubs logging the calls they receive,
+// along with the React functions the module links against, so it runs without the ADK nor a bridge.
+
+// Calls received by the stubs in order, as "enter <name>", "enter <name> parent <parent name>",
+// "event <name>", "value <name> <value>", "error <name> <value>", "leave <name>", "startup", "flush", "shutdown"
+NSArray<NSString *> *ODDynatraceFakeADKCalls(void);
+
+// Action calls made outside of the queue given to ODDynatraceFakeADKReset
+NSUInteger ODDynatraceFakeADKForeignQueueCalls(void);
+
+// Clears the calls, the action calls are then expected on the queue
+void ODDynatraceFakeADKReset(dispatch_queue_t queue);
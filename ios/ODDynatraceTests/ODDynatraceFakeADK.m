@@ -0,0 +1,207 @@
+//
+//  ODDynatraceFakeADK.m
+//  ODDynatraceTests
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceFakeADK.h"
+#import "DynatraceUEM.h"
+
+#if __has_include(<React/RCTLog.h>)
+#import <React/RCTBridge.h>
+#import <React/RCTLog.h>
+#else
+#import "RCTBridge.h"
+#import "RCTLog.h"
+#endif
+
+static NSMutableArray<NSString *> *ODDynatraceFakeADKLog;
+static NSUInteger ODDynatraceFakeADKForeignCalls;
+static void *ODDynatraceFakeADKQueueKey = &ODDynatraceFakeADKQueueKey;
+
+NSArray<NSString *> *ODDynatraceFakeADKCalls(void)
+{
+    @synchronized (ODDynatraceFakeADKLog) {
+        return [ODDynatraceFakeADKLog copy];
+    }
+}
+
+NSUInteger ODDynatraceFakeADKForeignQueueCalls(void)
+{
+    @synchronized (ODDynatraceFakeADKLog) {
+        return ODDynatraceFakeADKForeignCalls;
+    }
+}
+
+void ODDynatraceFakeADKReset(dispatch_queue_t queue)
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        ODDynatraceFakeADKLog = [NSMutableArray array];
+    });
+    dispatch_queue_set_specific(queue, ODDynatraceFakeADKQueueKey, ODDynatraceFakeADKQueueKey, NULL);
+    @synchronized (ODDynatraceFakeADKLog) {
+        [ODDynatraceFakeADKLog removeAllObjects];
+        ODDynatraceFakeADKForeignCalls = 0;
+    }
+}
+
+static void ODDynatraceFakeADKAppend(NSString *call)
+{
+    @synchronized (ODDynatraceFakeADKLog) {
+        [ODDynatraceFakeADKLog addObject:call];
+    }
+}
+
+// The module promises to call the actions from its queue only
+static void ODDynatraceFakeADKAppendActionCall(NSString *call)
+{
+    @synchronized (ODDynatraceFakeADKLog) {
+        [ODDynatraceFakeADKLog addObject:call];
+        if (dispatch_get_specific(ODDynatraceFakeADKQueueKey) != ODDynatraceFakeADKQueueKey) {
+            ODDynatraceFakeADKForeignCalls++;
+        }
+    }
+}
+
+#pragma mark - React
+
+void RCTRegisterModule(Class moduleClass)
+{
+}
+
+void _RCTLogNativeInternal(RCTLogLevel level, const char *fileName, int lineNumber, NSString *format, ...)
+{
+}
+
+dispatch_queue_t RCTJSThread;
+
+#pragma mark - ADK
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wincomplete-implementation"
+
+@interface UEMAction ()
+
+@property (nonatomic, copy) NSString *name;
+
+@end
+
+@implementation UEMAction
+
++ (UEMAction *)enterActionWithName:(NSString *)actionName
+{
+    ODDynatraceFakeADKAppendActionCall([NSString stringWithFormat:@"enter %@", actionName]);
+    UEMAction *action = [UEMAction new];
+    action.name = actionName;
+    return action;
+}
+
++ (UEMAction *)enterActionWithName:(NSString *)actionName parentAction:(UEMAction *)parentAction
+{
+    ODDynatraceFakeADKAppendActionCall([NSString stringWithFormat:@"enter %@ parent %@", actionName, parentAction.name]);
+    UEMAction *action = [UEMAction new];
+    action.name = actionName;
+    return action;
+}
+
+- (CPWR_StatusCode)leaveAction
+{
+    ODDynatraceFakeADKAppendActionCall([NSString stringWithFormat:@"leave %@", self.name]);
+    return CPWR_UemOn;
+}
+
+- (CPWR_StatusCode)reportEventWithName:(NSString *)eventName
+{
+    ODDynatraceFakeADKAppendActionCall([NSString stringWithFormat:@"event %@", eventName]);
+    return CPWR_UemOn;
+}
+
+- (CPWR_StatusCode)reportValueWithName:(NSString *)valueName intValue:(int)intValue
+{
+    ODDynatraceFakeADKAppendActionCall([NSString stringWithFormat:@"value %@ %d", valueName, intValue]);
+    return CPWR_UemOn;
+}
+
+- (CPWR_StatusCode)reportValueWithName:(NSString *)valueName doubleValue:(double)doubleValue
+{
+    ODDynatraceFakeADKAppendActionCall([NSString stringWithFormat:@"value %@ %g", valueName, doubleValue]);
+    return CPWR_UemOn;
+}
+
+- (CPWR_StatusCode)reportValueWithName:(NSString *)valueName stringValue:(NSString *)stringValue
+{
+    ODDynatraceFakeADKAppendActionCall([NSString stringWithFormat:@"value %@ %@", valueName, stringValue]);
+    return CPWR_UemOn;
+}
+
+- (CPWR_StatusCode)reportErrorWithName:(NSString *)errorName errorValue:(int)errorValue
+{
+    ODDynatraceFakeADKAppendActionCall([NSString stringWithFormat:@"error %@ %d", errorName, errorValue]);
+    return CPWR_UemOn;
+}
+
+@end
+
+@implementation UEMWebRequestTiming
+
++ (UEMWebRequestTiming *)getUEMWebRequestTiming:(NSString *)requestTagString requestUrl:(NSURL *)requestUrl
+{
+    return [UEMWebRequestTiming new];
+}
+
+- (CPWR_StatusCode)startWebRequestTiming
+{
+    return CPWR_UemOn;
+}
+
+- (CPWR_StatusCode)stopWebRequestTiming:(NSString *)errorCode
+{
+    return CPWR_UemOn;
+}
+
+@end
+
+@implementation DynatraceUEM
+
++ (CPWR_StatusCode)startupWithApplicationName:(NSString *)applicationName
+                                    serverURL:(NSString *)serverURL
+                                 allowAnyCert:(BOOL)allowAnyCert
+                              certificatePath:(NSString *)pathToCertificateAsDER
+{
+    ODDynatraceFakeADKAppend(@"startup");
+    return CPWR_UemOn;
+}
+
++ (CPWR_StatusCode)shutdown
+{
+    ODDynatraceFakeADKAppend(@"shutdown");
+    return CPWR_UemOn;
+}
+
++ (CPWR_StatusCode)flushEvents
+{
+    ODDynatraceFakeADKAppend(@"flush");
+    return CPWR_UemOn;
+}
+
++ (CPWR_StatusCode)enableCrashReportingWithReport:(BOOL)sendCrashReport
+{
+    return CPWR_UemOn;
+}
+
++ (NSString *)getRequestTagHeader
+{
+    return @"X-dynaTrace";
+}
+
++ (NSString *)getRequestTagValueForURL:(NSURL *)url
+{
+    return @"MT_3_1";
+}
+
+@end
+
+#pragma clang diagnostic pop
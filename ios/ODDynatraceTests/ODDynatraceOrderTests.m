@@ -0,0 +1,224 @@
+//
+//  ODDynatraceOrderTests.m
+//  ODDynatraceTests
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "DynatraceUEM.h"
+#import "ODDynatrace.h"
+#import "ODDynatraceFakeADK.h"
+
+static const size_t ODDynatraceOrderTestsProducers = 8;
+static const int ODDynatraceOrderTestsActions = 50;
+static const int ODDynatraceOrderTestsValues = 4;
+
+// Module methods exported to the bridge, called here the way the bridge does
+@interface ODDynatrace (ODDynatraceOrderTests)
+
+- (void)startup:(NSString *)appId
+      serverURL:(NSString *)serverURL
+        options:(NSDictionary *)options
+       resolver:(RCTPromiseResolveBlock)resolve
+       rejecter:(RCTPromiseRejectBlock)reject;
+- (void)shutdown;
+- (void)flush:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject;
+- (void)submitBatch:(NSArray<NSDictionary *> *)records
+           resolver:(RCTPromiseResolveBlock)resolve
+           rejecter:(RCTPromiseRejectBlock)reject;
+
+@end
+
+// Calls made from several queues against the stubbed ADK of ODDynatraceFakeADK : the calls of each caller
+// reach the ADK in the order they were made, and only from the module queue.
+@interface ODDynatraceOrderTests : XCTestCase
+@end
+
+@implementation ODDynatraceOrderTests
+{
+    ODDynatrace *_module;
+}
+
+- (void)setUp
+{
+    [super setUp];
+    // Nothing is left to replay from a previous run, and no event of the tests is dropped
+    [ODDynatrace setSpillLogCapacity:0];
+    [ODDynatrace setBreadcrumbCapacity:0];
+    [ODDynatrace setEventBufferCapacity:ODDynatraceOrderTestsProducers * ODDynatraceOrderTestsActions * (ODDynatraceOrderTestsValues + 3)
+                         overflowPolicy:ODDynatraceOverflowPolicyDropNewest];
+    _module = [ODDynatrace new];
+    ODDynatraceFakeADKReset(_module.methodQueue);
+
+    ODDynatrace *module = _module;
+    [self performOnModuleQueue:^(dispatch_block_t done) {
+        [module startup:@"ODDynatraceTests" serverURL:@"https://localhost/dynaTraceMonitor" options:@{}
+               resolver:^(id result) { done(); }
+               rejecter:^(NSString *code, NSString *message, NSError *error) {}];
+    }];
+}
+
+- (void)tearDown
+{
+    ODDynatrace *module = _module;
+    [self performOnModuleQueue:^(dispatch_block_t done) {
+        [module shutdown];
+        done();
+    }];
+    _module = nil;
+    [super tearDown];
+}
+
+// Runs the block on the module queue as the bridge does, the main run loop keeps running for the startup
+- (void)performOnModuleQueue:(void (^)(dispatch_block_t done))block
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"module queue"];
+    dispatch_async(_module.methodQueue, ^{
+        block(^{
+            [expectation fulfill];
+        });
+    });
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+}
+
+- (void)flush
+{
+    ODDynatrace *module = _module;
+    [self performOnModuleQueue:^(dispatch_block_t done) {
+        [module flush:^(id result) { done(); } rejecter:^(NSString *code, NSString *message, NSError *error) {}];
+    }];
+}
+
+- (NSArray<NSString *> *)actionCalls
+{
+    NSSet<NSString *> *moduleCalls = [NSSet setWithObjects:@"startup", @"flush", @"shutdown", nil];
+    return [ODDynatraceFakeADKCalls() filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(NSString *call, NSDictionary *bindings) {
+        return ![moduleCalls containsObject:call];
+    }]];
+}
+
+- (void)testCallsOfEachQueueReachTheADKInOrder
+{
+    ODDynatrace *module = _module;
+    dispatch_apply(ODDynatraceOrderTestsProducers, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t producer) {
+        for (int i = 0; i < ODDynatraceOrderTestsActions; i++) {
+            NSString *name = [NSString stringWithFormat:@"Producer %zu action %d", producer, i];
+            ODDynatraceHandle action = [module enterActionWithName:name];
+            for (int value = 0; value < ODDynatraceOrderTestsValues; value++) {
+                [module reportValueWithName:name intValue:value action:action];
+            }
+            [module reportEventWithName:name action:action];
+            [module leaveAction:action];
+        }
+    });
+    [self flush];
+
+    NSArray<NSString *> *calls = [self actionCalls];
+    XCTAssertEqual(calls.count, ODDynatraceOrderTestsProducers * ODDynatraceOrderTestsActions * (ODDynatraceOrderTestsValues + 3));
+    XCTAssertEqual(ODDynatraceFakeADKForeignQueueCalls(), 0);
+
+    // However the producers interleaved, the calls of each of them are in the order it made them
+    for (size_t producer = 0; producer < ODDynatraceOrderTestsProducers; producer++) {
+        NSString *prefix = [NSString stringWithFormat:@"Producer %zu action ", producer];
+        NSMutableArray<NSString *> *expected = [NSMutableArray array];
+        for (int i = 0; i < ODDynatraceOrderTestsActions; i++) {
+            NSString *name = [prefix stringByAppendingFormat:@"%d", i];
+            [expected addObject:[@"enter " stringByAppendingString:name]];
+            for (int value = 0; value < ODDynatraceOrderTestsValues; value++) {
+                [expected addObject:[NSString stringWithFormat:@"value %@ %d", name, value]];
+            }
+            [expected addObject:[@"event " stringByAppendingString:name]];
+            [expected addObject:[@"leave " stringByAppendingString:name]];
+        }
+        NSArray<NSString *> *producerCalls = [calls filteredArrayUsingPredicate:
+                                              [NSPredicate predicateWithFormat:@"SELF CONTAINS %@", prefix]];
+        XCTAssertEqualObjects(producerCalls, expected);
+    }
+}
+
+- (void)testNativeCallsGoBeforeALaterBatch
+{
+    // A native caller of the module queue : its events are still queued when the batch arrives
+    ODDynatrace *module = _module;
+    [self performOnModuleQueue:^(dispatch_block_t done) {
+        ODDynatraceHandle action = [module enterActionWithName:@"Native"];
+        [module reportValueWithName:@"Loaded" intValue:1 action:action];
+        [module leaveAction:action];
+        [module submitBatch:@[ @{ @"type": @"event", @"action": @"Batch", @"name": @"Refresh" } ]
+                   resolver:^(id result) { done(); }
+                   rejecter:^(NSString *code, NSString *message, NSError *error) {}];
+    }];
+
+    XCTAssertEqualObjects([self actionCalls], (@[ @"enter Native", @"value Loaded 1", @"leave Native",
+                                                  @"enter Batch", @"event Refresh", @"leave Batch" ]));
+}
+
+- (void)testLeavingAnActionLeavesItsChildrenFirst
+{
+    ODDynatrace *module = _module;
+    dispatch_sync(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        ODDynatraceHandle parent = [module enterActionWithName:@"Parent"];
+        ODDynatraceHandle child = [module enterActionWithName:@"Child" parentAction:parent];
+        [module enterActionWithName:@"Grandchild" parentAction:child];
+        [module leaveAction:parent];
+    });
+    [self flush];
+
+    XCTAssertEqualObjects([self actionCalls], (@[ @"enter Parent", @"enter Child parent Parent", @"enter Grandchild parent Child",
+                                                  @"leave Grandchild", @"leave Child", @"leave Parent" ]));
+    XCTAssertEqual(ODDynatraceFakeADKForeignQueueCalls(), 0);
+}
+
+// Called on the module queue, delay in ms
+- (void)startupDeferred:(double)delay resolver:(RCTPromiseResolveBlock)resolve
+{
+    [_module startup:@"ODDynatraceTests" serverURL:@"https://localhost/dynaTraceMonitor" options:@{ @"startupDelay": @(delay) }
+            resolver:resolve
+            rejecter:^(NSString *code, NSString *message, NSError *error) {}];
+}
+
+- (void)testShutdownCancelsADeferredStartup
+{
+    __block NSNumber *statusCode;
+    XCTestExpectation *resolved = [self expectationWithDescription:@"startup resolved"];
+    [self performOnModuleQueue:^(dispatch_block_t done) {
+        [self startupDeferred:50 resolver:^(id result) {
+            statusCode = result;
+            [resolved fulfill];
+        }];
+        [self->_module shutdown];
+        done();
+    }];
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    XCTAssertEqualObjects(statusCode, @(CPWR_Error_NotInitialized));
+    XCTAssertEqualObjects(ODDynatraceFakeADKCalls(), (@[ @"startup", @"shutdown" ]));
+}
+
+- (void)testLaterStartupCancelsADeferredOne
+{
+    __block NSNumber *firstStatusCode;
+    __block NSNumber *secondStatusCode;
+    XCTestExpectation *firstResolved = [self expectationWithDescription:@"first startup resolved"];
+    XCTestExpectation *secondResolved = [self expectationWithDescription:@"second startup resolved"];
+    [self performOnModuleQueue:^(dispatch_block_t done) {
+        [self startupDeferred:50 resolver:^(id result) {
+            firstStatusCode = result;
+            [firstResolved fulfill];
+        }];
+        [self startupDeferred:50 resolver:^(id result) {
+            secondStatusCode = result;
+            [secondResolved fulfill];
+        }];
+        done();
+    }];
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    XCTAssertEqualObjects(firstStatusCode, @(CPWR_Error_NotInitialized));
+    XCTAssertEqualObjects(secondStatusCode, @(CPWR_UemOn));
+    XCTAssertEqualObjects(ODDynatraceFakeADKCalls(), (@[ @"startup", @"startup" ]));
+}
+
+@end
@@ -0,0 +1,235 @@
+//
+//  ODDynatraceRecordTests.m
+//  ODDynatraceTests
+//
+//  Created by OLIVIER DEMOLLIENS on 09/01/2018.
+//  Copyright © 2018 DEMOLLIENS. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <libkern/OSByteOrder.h>
+#import "ODDynatraceRecord.h"
+
+static const NSUInteger ODDynatraceRecordTestsIterations = 10000;
+static const int ODDynatraceRecordTestsThroughputRecords = 100000;
+
+// Round trips of random records through the binary codec, and decoding of truncated and corrupt records,
+// same cases as ODDynatraceRecordTest.java
+@interface ODDynatraceRecordTests : XCTestCase
+@end
+
+@implementation ODDynatraceRecordTests
+{
+    uint64_t _seed;
+}
+
+- (void)setUp
+{
+    [super setUp];
+    _seed = 42;
+}
+
+// xorshift64, the runs are reproducible
+- (uint64_t)random
+{
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 7;
+    _seed ^= _seed << 17;
+    return _seed;
+}
+
+- (uint32_t)random:(uint32_t)bound
+{
+    return (uint32_t)([self random] % bound);
+}
+
+- (void)fillRandom:(uint8_t *)bytes length:(size_t)length
+{
+    for (size_t i = 0; i < length; i++) {
+        bytes[i] = (uint8_t)[self random];
+    }
+}
+
+- (ODDynatraceRecord)recordWithName:(const char *)name stringValue:(const char *)stringValue
+{
+    ODDynatraceRecord record = { 0 };
+    record.type = ODDynatraceEventReportStringValue;
+    record.handle = 1;
+    record.writer = 7;
+    record.timestamp = 1515456000000ULL;
+    record.name = (const uint8_t *)name;
+    record.nameLength = (uint16_t)strlen(name);
+    record.stringValue = (const uint8_t *)stringValue;
+    record.stringLength = (uint32_t)strlen(stringValue);
+    return record;
+}
+
+- (void)testRoundTripsRandomRecords
+{
+    uint8_t strings[1024];
+    uint8_t buffer[2048];
+    for (NSUInteger i = 0; i < ODDynatraceRecordTestsIterations; i++) {
+        [self fillRandom:strings length:sizeof(strings)];
+        ODDynatraceRecord record = { 0 };
+        record.type = [self random:ODDynatraceEventTypeCount];
+        record.handle = (ODDynatraceHandle)[self random];
+        record.nameId = (ODDynatraceNameId)[self random];
+        record.writer = (uint32_t)i;
+        record.timestamp = [self random];
+        record.name = strings;
+        record.nameLength = [self random:256];
+        record.stringValue = strings + 256;
+        record.stringLength = record.type == ODDynatraceEventReportStringValue ? [self random:768] : 0;
+        if (record.type == ODDynatraceEventReportDoubleValue) {
+            record.value.doubleValue = (double)(int32_t)[self random] / ([self random:1000] + 1);
+        } else {
+            record.value.intValue = (int)[self random];
+        }
+        size_t offset = [self random:64];
+
+        size_t length = ODDynatraceRecordEncode(&record, buffer + offset, sizeof(buffer) - offset);
+        XCTAssertEqual(length, ODDynatraceRecordHeaderLength + record.nameLength + record.stringLength);
+
+        ODDynatraceRecord decoded;
+        XCTAssertEqual(ODDynatraceRecordDecode(buffer + offset, length, &decoded), length);
+        XCTAssertEqual(decoded.type, record.type);
+        XCTAssertEqual(decoded.handle, record.handle);
+        XCTAssertEqual(decoded.nameId, record.nameId);
+        XCTAssertEqual(decoded.writer, record.writer);
+        XCTAssertEqual(decoded.timestamp, record.timestamp);
+        XCTAssertEqual(decoded.nameLength, record.nameLength);
+        XCTAssertEqual(memcmp(decoded.name, record.name, record.nameLength), 0);
+        XCTAssertEqual(decoded.stringLength, record.stringLength);
+        XCTAssertEqual(memcmp(decoded.stringValue, record.stringValue, record.stringLength), 0);
+        if (record.type == ODDynatraceEventReportDoubleValue) {
+            XCTAssertEqual(decoded.value.doubleValue, record.value.doubleValue);
+        } else {
+            XCTAssertEqual(decoded.value.intValue, record.value.intValue);
+        }
+    }
+}
+
+- (void)testDoesNotEncodeRecordsNotFitting
+{
+    ODDynatraceRecord record = [self recordWithName:"Status" stringValue:"Loaded"];
+    uint8_t buffer[64];
+    size_t length = ODDynatraceRecordLength(&record);
+    XCTAssertEqual(ODDynatraceRecordEncode(&record, buffer, length - 1), 0);
+    XCTAssertEqual(ODDynatraceRecordEncode(&record, buffer, length), length);
+}
+
+- (void)testRejectsTruncatedRecords
+{
+    ODDynatraceRecord record = [self recordWithName:"Status" stringValue:"Loaded"];
+    uint8_t buffer[64];
+    size_t length = ODDynatraceRecordEncode(&record, buffer, sizeof(buffer));
+    ODDynatraceRecord decoded;
+    for (size_t limit = 0; limit < length; limit++) {
+        XCTAssertEqual(ODDynatraceRecordDecode(buffer, limit, &decoded), 0);
+    }
+}
+
+- (void)testRejectsOtherVersions
+{
+    ODDynatraceRecord record = [self recordWithName:"" stringValue:""];
+    record.type = ODDynatraceEventLeaveAction;
+    uint8_t buffer[64];
+    size_t length = ODDynatraceRecordEncode(&record, buffer, sizeof(buffer));
+    ODDynatraceRecord decoded;
+    for (int version = 0; version < 256; version++) {
+        buffer[4] = (uint8_t)version;
+        XCTAssertEqual(ODDynatraceRecordDecode(buffer, length, &decoded),
+                       version == ODDynatraceRecordVersion ? length : 0);
+    }
+}
+
+- (void)testRejectsInconsistentLengths
+{
+    ODDynatraceRecord record = [self recordWithName:"Status" stringValue:"Loaded"];
+    uint8_t buffer[64];
+    size_t length = ODDynatraceRecordEncode(&record, buffer, sizeof(buffer));
+    ODDynatraceRecord decoded;
+
+    OSWriteLittleInt32(buffer, 0, (uint32_t)length - 1);
+    XCTAssertEqual(ODDynatraceRecordDecode(buffer, length, &decoded), 0);
+    OSWriteLittleInt32(buffer, 0, (uint32_t)length);
+    OSWriteLittleInt16(buffer, 6, 7);
+    XCTAssertEqual(ODDynatraceRecordDecode(buffer, length, &decoded), 0);
+    // A string length wrapping around must not balance a longer name
+    OSWriteLittleInt16(buffer, 6, 18);
+    OSWriteLittleInt32(buffer, 20, (uint32_t)-6);
+    XCTAssertEqual(ODDynatraceRecordDecode(buffer, length, &decoded), 0);
+}
+
+- (void)testDecodesRandomBytesWithinTheBuffer
+{
+    uint8_t buffer[256];
+    ODDynatraceRecord decoded;
+    for (NSUInteger i = 0; i < ODDynatraceRecordTestsIterations; i++) {
+        [self fillRandom:buffer length:sizeof(buffer)];
+        buffer[4] = ODDynatraceRecordVersion;
+        // Small lengths, so some of the random records are consistent
+        OSWriteLittleInt32(buffer, 0, [self random:256]);
+        OSWriteLittleInt16(buffer, 6, (uint16_t)[self random:128]);
+        OSWriteLittleInt32(buffer, 20, [self random:4] == 0 ? (uint32_t)[self random] : [self random:128]);
+        size_t limit = [self random:257];
+        size_t length = ODDynatraceRecordDecode(buffer, limit, &decoded);
+        if (length > 0) {
+            XCTAssertLessThanOrEqual(length, limit);
+            XCTAssertLessThanOrEqual(decoded.stringValue + decoded.stringLength, buffer + limit);
+        }
+    }
+}
+
+// Throughput of the same value records written and read through the codec, then through dictionaries
+// like the ones of submitBatch, compared in the test report
+- (void)testCodecThroughput
+{
+    const char *name = "Items";
+    uint8_t buffer[64];
+    [self measureBlock:^{
+        ODDynatraceRecord record = { 0 };
+        record.type = ODDynatraceEventReportIntValue;
+        record.handle = 1;
+        record.name = (const uint8_t *)name;
+        record.nameLength = (uint16_t)strlen(name);
+        int64_t sum = 0;
+        for (int i = 0; i < ODDynatraceRecordTestsThroughputRecords; i++) {
+            record.value.intValue = i;
+            record.timestamp = (uint64_t)i;
+            size_t length = ODDynatraceRecordEncode(&record, buffer, sizeof(buffer));
+            ODDynatraceRecord decoded;
+            ODDynatraceRecordDecode(buffer, length, &decoded);
+            if (decoded.type == ODDynatraceEventReportIntValue) {
+                NSString *decodedName = [[NSString alloc] initWithBytes:decoded.name length:decoded.nameLength
+                                                               encoding:NSUTF8StringEncoding];
+                sum += decoded.handle + decoded.value.intValue + (int64_t)decodedName.length;
+            }
+        }
+        XCTAssertEqual(sum, [self expectedThroughputSum]);
+    }];
+}
+
+- (void)testDictionaryThroughput
+{
+    [self measureBlock:^{
+        int64_t sum = 0;
+        for (int i = 0; i < ODDynatraceRecordTestsThroughputRecords; i++) {
+            @autoreleasepool {
+                NSDictionary *record = @{ @"type": @"intValue", @"handle": @1, @"name": @"Items", @"value": @(i) };
+                if ([record[@"type"] isEqualToString:@"intValue"]) {
+                    sum += [record[@"handle"] intValue] + [record[@"value"] intValue] + (int64_t)[record[@"name"] length];
+                }
+            }
+        }
+        XCTAssertEqual(sum, [self expectedThroughputSum]);
+    }];
+}
+
+- (int64_t)expectedThroughputSum
+{
+    int64_t count = ODDynatraceRecordTestsThroughputRecords;
+    return count * (1 + 5) + count * (count - 1) / 2;
+}
+
+@end
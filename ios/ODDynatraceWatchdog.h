@@ -0,0 +1,41 @@
+//
+//  ODDynatraceWatchdog.h
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 27/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// Latencies of the JS thread over one report interval, in milliseconds
+typedef struct {
+    double p50;
+    double p95;
+    double p99;
+    double max;
+    NSUInteger sampleCount;
+    NSUInteger longTaskCount;
+} ODDynatraceWatchdogReport;
+
+// Pings the JS thread and measures how late it runs the ping, from the startup options :
+//  - watchdogInterval : milliseconds between two pings, disabled when 0 (default)
+//  - longTaskThreshold : latency in milliseconds counted as a long task, 50 by default
+//  - watchdogReportInterval : seconds between two reports, 60 by default
+// The latencies are aggregated in an ODDynatraceHistogram, only the percentiles are reported.
+// Only used from the module queue.
+@interface ODDynatraceWatchdog : NSObject
+
+- (nonnull instancetype)initWithOptions:(nullable NSDictionary *)options queue:(nonnull dispatch_queue_t)queue;
+
+// Runs the block on the JS thread. Pings are not sent while the previous one is pending.
+@property (nonatomic, copy, nullable) void (^pingHandler)(dispatch_block_t _Nonnull ping);
+
+// Called on the module queue once per report interval having samples
+@property (nonatomic, copy, nullable) void (^reportHandler)(ODDynatraceWatchdogReport report);
+
+- (void)start;
+
+- (void)invalidate;
+
+@end
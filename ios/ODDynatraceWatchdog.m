@@ -0,0 +1,121 @@
+//
+//  ODDynatraceWatchdog.m
+//  ODDynatrace
+//
+//  Created by OLIVIER DEMOLLIENS on 27/12/2017.
+//  Copyright © 2017 DEMOLLIENS. All rights reserved.
+//
+
+#import "ODDynatraceWatchdog.h"
+#import "ODDynatraceHistogram.h"
+
+@implementation ODDynatraceWatchdog
+{
+    dispatch_queue_t _queue;
+    dispatch_source_t _timer;
+    NSTimeInterval _interval;
+    NSTimeInterval _longTaskThreshold;
+    NSTimeInterval _reportInterval;
+
+    BOOL _pingPending;
+    NSTimeInterval _nextReportTime;
+    ODDynatraceHistogram *_latencies;
+    NSUInteger _longTaskCount;
+}
+
+- (instancetype)initWithOptions:(NSDictionary *)options queue:(dispatch_queue_t)queue
+{
+    if ((self = [super init])) {
+        _queue = queue;
+        _interval = [options[@"watchdogInterval"] doubleValue] / 1000;
+        _longTaskThreshold = (options[@"longTaskThreshold"] ? [options[@"longTaskThreshold"] doubleValue] : 50) / 1000;
+        _reportInterval = options[@"watchdogReportInterval"] ? [options[@"watchdogReportInterval"] doubleValue] : 60;
+        _latencies = ODDynatraceHistogramCreate();
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [self invalidate];
+    ODDynatraceHistogramDestroy(_latencies);
+}
+
+- (void)start
+{
+    if (_interval <= 0 || _timer) {
+        return;
+    }
+    _nextReportTime = [NSProcessInfo processInfo].systemUptime + _reportInterval;
+    _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _queue);
+    __weak ODDynatraceWatchdog *weakSelf = self;
+    dispatch_source_set_event_handler(_timer, ^{
+        [weakSelf tick];
+    });
+    dispatch_source_set_timer(_timer,
+                              dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_interval * NSEC_PER_SEC)),
+                              (uint64_t)(_interval * NSEC_PER_SEC),
+                              (uint64_t)(_interval * NSEC_PER_SEC / 10));
+    dispatch_resume(_timer);
+}
+
+- (void)invalidate
+{
+    if (_timer) {
+        dispatch_source_cancel(_timer);
+        _timer = nil;
+    }
+}
+
+- (void)tick
+{
+    NSTimeInterval now = [NSProcessInfo processInfo].systemUptime;
+    if (now >= _nextReportTime) {
+        [self report];
+        _nextReportTime = now + _reportInterval;
+    }
+    if (_pingPending || !_pingHandler) {
+        return;
+    }
+
+    // The latency is measured on the JS thread, then recorded back on the module queue
+    _pingPending = YES;
+    dispatch_queue_t queue = _queue;
+    __weak ODDynatraceWatchdog *weakSelf = self;
+    _pingHandler(^{
+        NSTimeInterval latency = [NSProcessInfo processInfo].systemUptime - now;
+        dispatch_async(queue, ^{
+            [weakSelf recordLatency:latency];
+        });
+    });
+}
+
+- (void)recordLatency:(NSTimeInterval)latency
+{
+    _pingPending = NO;
+    ODDynatraceHistogramRecord(_latencies, latency * 1000);
+    if (latency >= _longTaskThreshold) {
+        _longTaskCount++;
+    }
+}
+
+- (void)report
+{
+    ODDynatraceHistogramSummary summary;
+    if (!ODDynatraceHistogramSummarize(_latencies, &summary)) {
+        return;
+    }
+    if (_reportHandler) {
+        _reportHandler((ODDynatraceWatchdogReport){
+            .p50 = summary.p50,
+            .p95 = summary.p95,
+            .p99 = summary.p99,
+            .max = summary.max,
+            .sampleCount = (NSUInteger)summary.count,
+            .longTaskCount = _longTaskCount,
+        });
+    }
+    _longTaskCount = 0;
+}
+
+@end
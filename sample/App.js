@@ -13,6 +13,7 @@ import {
 } from 'react-native';
 
 import ODDynatrace from 'react-native-dynatrace';
+import runBenchmark, { findRegressions } from './Benchmark';
 
 const instructions = Platform.select({
   ios: 'Press Cmd+R to reload,\n' +
@@ -25,8 +26,19 @@ export default class App extends Component<{}> {
 
   constructor(){
     super()
+    this.state = { benchmark: null, baseline: null, regressions: [] };
     ODDynatrace.startup("APPLICATION_ID","INSTANCE_URL");
   }
+
+  // The first run is the baseline of the next ones, within this session only
+  benchmark = () => {
+    runBenchmark().then(benchmark => this.setState(({ baseline }) => ({
+      benchmark,
+      baseline: baseline || benchmark,
+      regressions: baseline ? findRegressions(benchmark, baseline) : [],
+    })));
+  }
+
   render() {
     return (
       <View style={styles.container}>
@@ -39,6 +51,15 @@ export default class App extends Component<{}> {
         <Text style={styles.instructions}>
           {instructions}
         </Text>
+        <Text style={styles.welcome} onPress={this.benchmark}>
+          Run benchmark
+        </Text>
+        {this.state.benchmark && this.state.benchmark.map(({ name, value, unit }) => (
+          <Text key={name} style={styles.instructions}>
+            {name}: {Number.isInteger(value) ? value : value.toFixed(2)} {unit}
+            {this.state.regressions.includes(name) ? ' (regression)' : ''}
+          </Text>
+        ))}
       </View>
     );
   }
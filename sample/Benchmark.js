@@ -0,0 +1,150 @@
+/**
+ * Cost of the instrumentation paths, from the JS side down to the native dispatch
+ * @flow
+ */
+
+import ODDynatrace from 'react-native-dynatrace';
+
+const ITERATIONS = 1000;
+const ROUND_TRIPS = 100;
+
+function now() {
+  return global.performance && global.performance.now ? global.performance.now() : Date.now();
+}
+
+// Sends the queued batch now, then resolves once the module queue handled everything queued before
+async function settle() {
+  ODDynatrace.configure({});
+  await ODDynatrace.getStatusCounts();
+}
+
+// Microseconds per call spent on the JS thread (perCall), and until the native side dispatched
+// the calls to the ADK (endToEnd)
+async function timeCalls(call) {
+  await settle();
+  const start = now();
+  for (let i = 0; i < ITERATIONS; i++) {
+    call(i);
+  }
+  const queued = now() - start;
+  await settle();
+  const total = now() - start;
+  return {
+    perCall: (queued * 1000) / ITERATIONS,
+    endToEnd: (total * 1000) / ITERATIONS,
+  };
+}
+
+async function measurePath(synchronous, results) {
+  ODDynatrace.configure({ synchronous });
+  const path = synchronous ? 'synchronous' : 'batched';
+  const [iterationId] = await ODDynatrace.registerNames(['Iteration']);
+  const action = await ODDynatrace.enterAction('Benchmark');
+
+  const cases = {
+    enterLeave: () => ODDynatrace.enterAction('Iteration').then(ODDynatrace.leaveAction),
+    reportEvent: () => ODDynatrace.reportEvent(action, 'Iteration'),
+    reportValue: i => ODDynatrace.reportValue(action, 'Iteration', i),
+    reportValueIds: i => ODDynatrace.reportValue(action, iterationId, i),
+    recordValue: i => ODDynatrace.recordValue(iterationId, i),
+  };
+  if (!synchronous) {
+    cases.reportValueByName = i => ODDynatrace.reportValue('Benchmark', 'Iteration', i);
+  }
+  for (const name of Object.keys(cases)) {
+    const { perCall, endToEnd } = await timeCalls(cases[name]);
+    results.push({ name: `${path}.${name}`, value: perCall, unit: 'µs per call' });
+    results.push({ name: `${path}.${name}.endToEnd`, value: endToEnd, unit: 'µs per call' });
+    results.push({ name: `${path}.${name}.throughput`, value: 1e6 / endToEnd, unit: 'calls/s', higherIsBetter: true });
+  }
+
+  // One call at a time, waiting for its status code
+  const start = now();
+  for (let i = 0; i < ROUND_TRIPS; i++) {
+    await ODDynatrace.withStatus.reportEvent(action, 'Iteration');
+  }
+  results.push({ name: `${path}.withStatus.roundTrip`, value: ((now() - start) * 1000) / ROUND_TRIPS, unit: 'µs per call' });
+
+  ODDynatrace.leaveAction(action);
+}
+
+// Batches of handle and name id records sent as maps or as one flat array (Android only)
+async function measurePacked(results) {
+  ODDynatrace.configure({ synchronous: false, packed: true });
+  if (!ODDynatrace.isPacked) {
+    return;
+  }
+  const [iterationId] = await ODDynatrace.registerNames(['Iteration']);
+  const action = await ODDynatrace.enterAction('Benchmark');
+  for (const packed of [false, true]) {
+    ODDynatrace.configure({ packed });
+    const { endToEnd } = await timeCalls(i => ODDynatrace.reportValue(action, iterationId, i));
+    const name = packed ? 'packed' : 'unpacked';
+    results.push({ name: `${name}.reportValueIds.throughput`, value: 1e6 / endToEnd, unit: 'calls/s', higherIsBetter: true });
+  }
+  ODDynatrace.leaveAction(action);
+}
+
+// Native footprint : arena blocks allocated by batches once warmed up (iOS only),
+// events dropped by the native buffer and calls failing during the run
+async function measureFootprint(results, before) {
+  await timeCalls(i => ODDynatrace.reportValue('Benchmark', 'Iteration', i));
+  const warmedUp = await ODDynatrace.getEventBufferStats();
+  await timeCalls(i => ODDynatrace.reportValue('Benchmark', 'Iteration', i));
+  const stats = await ODDynatrace.getEventBufferStats();
+  if (stats.arenaBlocks !== undefined) {
+    results.push({ name: 'arenaBlocksAllocated', value: stats.arenaBlocks - warmedUp.arenaBlocks, unit: 'blocks' });
+  }
+  results.push({ name: 'eventBufferDropped', value: stats.dropped - before.dropped, unit: 'events' });
+  const statusCounts = await ODDynatrace.getStatusCounts();
+  const failures = Object.keys(statusCounts)
+    .filter(name => name.startsWith('CPWR_Error'))
+    .reduce((sum, name) => sum + statusCounts[name], 0);
+  results.push({ name: 'failedCalls', value: failures, unit: 'calls' });
+}
+
+// Resolves with a list of { name, value, unit } : time spent on the JS thread per call for each available
+// path, end to end time and throughput including the native dispatch, round trip of the calls resolving
+// with a status code, the ADK startup duration and the native footprint of the run.
+// Registered name ids avoid the string copies on both sides of the bridge, recordValue only reaches the ADK
+// as periodic summaries. Native allocations per call can be compared with Instruments or the Android profiler.
+export default async function runBenchmark() {
+  const synchronous = ODDynatrace.isSynchronous;
+  const packed = ODDynatrace.isPacked;
+  const before = await ODDynatrace.getEventBufferStats();
+  const results = [];
+
+  const startup = await ODDynatrace.getStartupStats();
+  results.push({ name: 'startup.duration', value: startup.duration, unit: 'ms' });
+
+  await measurePath(false, results);
+  ODDynatrace.configure({ synchronous: true });
+  if (ODDynatrace.isSynchronous) {
+    await measurePath(true, results);
+  }
+  await measurePacked(results);
+  ODDynatrace.configure({ synchronous: false, packed });
+  await measureFootprint(results, before);
+
+  ODDynatrace.configure({ synchronous });
+  return results;
+}
+
+// Names of the results worse than the baseline results by more than the tolerance, e.g. from an earlier run
+// of the same session. Results are only comparable on the same device and build.
+export function findRegressions(results, baseline, tolerance = 0.25) {
+  const baselineValues = {};
+  baseline.forEach(({ name, value }) => {
+    baselineValues[name] = value;
+  });
+  return results
+    .filter(({ name, value, higherIsBetter }) => {
+      const reference = baselineValues[name];
+      if (reference === undefined || reference === 0) {
+        return false;
+      }
+      const change = (value - reference) / reference;
+      return higherIsBetter ? change < -tolerance : change > tolerance;
+    })
+    .map(({ name }) => name);
+}